@@ -125,7 +125,10 @@ static int adxl355_iio_read_hpf_available(void *dev, char *buf, uint32_t len,
 		const struct iio_ch_info *channel, intptr_t priv);
 static int adxl355_iio_read_samp_freq_avail(void *dev, char *buf,
 		uint32_t len, const struct iio_ch_info *channel, intptr_t priv);
+static int adxl355_iio_read_scan(struct adxl355_iio_dev *iio_adxl355,
+				 int *buff);
 static int adxl355_iio_read_samples(void* dev, int* buff, uint32_t samples);
+static int adxl355_iio_trigger_handler(struct iio_device_data *dev_data);
 static int adxl355_iio_update_channels(void* dev, uint32_t mask);
 
 /******************************************************************************/
@@ -187,6 +190,13 @@ static struct iio_attribute adxl355_iio_accel_attrs[] = {
 	END_ATTRIBUTES_ARRAY
 };
 
+static struct iio_event_spec adxl355_iio_accel_events[] = {
+	{
+		.type = IIO_EV_TYPE_THRESH,
+		.dir = IIO_EV_DIR_RISING,
+	},
+};
+
 static struct scan_type adxl355_iio_accel_scan_type = {
 	.sign = 's',
 	.realbits = 20,
@@ -212,6 +222,8 @@ static struct scan_type adxl355_iio_temp_scan_type = {
 	.scan_type = &adxl355_iio_accel_scan_type,    \
 	.scan_index = index,                          \
 	.attributes = adxl355_iio_accel_attrs,        \
+	.event_specs = adxl355_iio_accel_events,      \
+	.num_event_specs = NO_OS_ARRAY_SIZE(adxl355_iio_accel_events), \
 	.ch_out = false                               \
 }
 
@@ -227,6 +239,7 @@ static struct iio_channel adxl355_channels[] = {
 		.attributes = adxl355_iio_temp_attrs,
 		.ch_out = false,
 	},
+	IIO_CHAN_SOFT_TIMESTAMP(4),
 };
 
 static struct iio_device adxl355_iio_dev = {
@@ -234,6 +247,7 @@ static struct iio_device adxl355_iio_dev = {
 	.channels = adxl355_channels,
 	.pre_enable = (int32_t (*)())adxl355_iio_update_channels,
 	.read_dev = (int32_t (*)())adxl355_iio_read_samples,
+	.trigger_handler = (int32_t (*)())adxl355_iio_trigger_handler,
 	.debug_reg_read = (int32_t (*)())adxl355_iio_read_reg,
 	.debug_reg_write = (int32_t (*)())adxl355_iio_write_reg
 };
@@ -859,6 +873,45 @@ static int adxl355_iio_read_samp_freq_avail(void *dev, char *buf,
 	}
 }
 
+/***************************************************************************//**
+ * @brief Reads one sample of the selected channels
+ *
+ * @param iio_adxl355 - The iio device structure.
+ * @param buff        - Buffer to be filled with one value per active channel.
+ *
+ * @return ret        - Result of the reading procedure.
+*******************************************************************************/
+static int adxl355_iio_read_scan(struct adxl355_iio_dev *iio_adxl355,
+				 int *buff)
+{
+	uint32_t data_x;
+	uint32_t data_y;
+	uint32_t data_z;
+	uint16_t raw_temp;
+	uint32_t i = 0;
+	int ret;
+
+	ret = adxl355_get_raw_xyz(iio_adxl355->adxl355_dev, &data_x, &data_y,
+				  &data_z);
+	if (ret)
+		return ret;
+
+	if (iio_adxl355->active_channels & NO_OS_BIT(0))
+		buff[i++] = no_os_sign_extend32(data_x, 19);
+	if (iio_adxl355->active_channels & NO_OS_BIT(1))
+		buff[i++] = no_os_sign_extend32(data_y, 19);
+	if (iio_adxl355->active_channels & NO_OS_BIT(2))
+		buff[i++] = no_os_sign_extend32(data_z, 19);
+	if (iio_adxl355->active_channels & NO_OS_BIT(3)) {
+		ret = adxl355_get_raw_temp(iio_adxl355->adxl355_dev, &raw_temp);
+		if (ret)
+			return ret;
+		buff[i] = raw_temp;
+	}
+
+	return 0;
+}
+
 /***************************************************************************//**
  * @brief Reads the number of given samples for the selected channels
  *
@@ -871,12 +924,9 @@ static int adxl355_iio_read_samp_freq_avail(void *dev, char *buf,
 *******************************************************************************/
 static int adxl355_iio_read_samples(void* dev, int* buff, uint32_t samples)
 {
-	uint32_t data_x;
-	uint32_t data_y;
-	uint32_t data_z;
-	uint16_t raw_temp;
 	struct adxl355_iio_dev *iio_adxl355;
-	struct adxl355_dev *adxl355;
+	uint32_t i;
+	int ret;
 
 	if (!dev)
 		return -EINVAL;
@@ -886,33 +936,39 @@ static int adxl355_iio_read_samples(void* dev, int* buff, uint32_t samples)
 	if (!iio_adxl355->adxl355_dev)
 		return -EINVAL;
 
-	adxl355 = iio_adxl355->adxl355_dev;
-
-	for(uint32_t i = 0; i < samples*iio_adxl355->no_of_active_channels;) {
-		adxl355_get_raw_xyz(adxl355, &data_x, &data_y, &data_z);
-
-		if (iio_adxl355->active_channels & NO_OS_BIT(0)) {
-			buff[i] = no_os_sign_extend32(data_x, 19);
-			i++;
-		}
-		if (iio_adxl355->active_channels & NO_OS_BIT(1)) {
-			buff[i] = no_os_sign_extend32(data_y, 19);
-			i++;
-		}
-		if (iio_adxl355->active_channels & NO_OS_BIT(2)) {
-			buff[i] = no_os_sign_extend32(data_z, 19);
-			i++;
-		}
-		if (iio_adxl355->active_channels & NO_OS_BIT(3)) {
-			adxl355_get_raw_temp(adxl355, &raw_temp);
-			buff[i] = raw_temp;
-			i++;
-		}
+	for (i = 0; i < samples; i++) {
+		ret = adxl355_iio_read_scan(iio_adxl355,
+					    buff + i * iio_adxl355->no_of_active_channels);
+		if (ret)
+			return ret;
 	}
 
 	return samples;
 }
 
+/***************************************************************************//**
+ * @brief Reads one sample of the selected channels into the buffer. Called
+ * 		  from the interrupt of the trigger, e.g. the DRDY pin.
+ *
+ * @param dev_data  - The iio device data structure.
+ *
+ * @return ret - Result of the reading procedure.
+*******************************************************************************/
+static int adxl355_iio_trigger_handler(struct iio_device_data *dev_data)
+{
+	int buff[4];
+	int ret;
+
+	if (!dev_data || !dev_data->dev)
+		return -EINVAL;
+
+	ret = adxl355_iio_read_scan(dev_data->dev, buff);
+	if (ret)
+		return ret;
+
+	return iio_buffer_push_scan(dev_data->buffer, buff);
+}
+
 /***************************************************************************//**
  * @brief Updates the number of active channels and the total number of
  * 		  active channels
@@ -981,8 +1037,8 @@ int adxl355_iio_init(struct adxl355_iio_dev **iio_dev,
 	if (ret)
 		goto error_config;
 
-	// Set operation mode
-	ret = adxl355_set_op_mode(desc->adxl355_dev, ADXL355_MEAS_TEMP_ON_DRDY_OFF);
+	// Set operation mode, DRDY pulses may be used as trigger
+	ret = adxl355_set_op_mode(desc->adxl355_dev, ADXL355_MEAS_TEMP_ON_DRDY_ON);
 	if (ret)
 		goto error_config;
 
@@ -1022,4 +1078,46 @@ int adxl355_iio_remove(struct adxl355_iio_dev *desc)
 	free(desc);
 
 	return 0;
-}
\ No newline at end of file
+}
+
+/***************************************************************************//**
+ * @brief Pushes an activity event for each axis with activity detection
+ * 		  enabled. To be called from the interrupt of the INT pin the
+ * 		  activity flag is mapped to.
+ *
+ * @param iio_desc  - The iio descriptor the device is registered to.
+ * @param dev       - The iio device structure.
+ * @param timestamp - Timestamp of the interrupt, 0 if not available.
+ *
+ * @return ret - Result of the procedure.
+*******************************************************************************/
+int adxl355_iio_push_activity(struct iio_desc *iio_desc,
+			      struct adxl355_iio_dev *dev, int64_t timestamp)
+{
+	union adxl355_sts_reg_flags status;
+	uint32_t i;
+	int ret;
+
+	if (!iio_desc || !dev || !dev->adxl355_dev)
+		return -EINVAL;
+
+	/* Reading the status register clears the activity flag */
+	ret = adxl355_get_sts_reg(dev->adxl355_dev, &status);
+	if (ret)
+		return ret;
+
+	if (!status.fields.Activity)
+		return 0;
+
+	for (i = chan_x; i <= chan_z; i++) {
+		if (!(dev->adxl355_dev->act_en.value & NO_OS_BIT(i)))
+			continue;
+
+		ret = iio_push_event(iio_desc, dev, i, IIO_EV_TYPE_THRESH,
+				     IIO_EV_DIR_RISING, timestamp);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
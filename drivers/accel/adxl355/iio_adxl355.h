@@ -67,4 +67,7 @@ int adxl355_iio_init(struct adxl355_iio_dev **iio_dev,
 
 int adxl355_iio_remove(struct adxl355_iio_dev *desc);
 
+int adxl355_iio_push_activity(struct iio_desc *iio_desc,
+			      struct adxl355_iio_dev *dev, int64_t timestamp);
+
 #endif /** IIO_AD7746_H */
@@ -42,6 +42,7 @@
 /******************************************************************************/
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include "no_os_error.h"
 #include "no_os_delay.h"
 #include "ad463x.h"
@@ -354,6 +355,155 @@ int32_t ad463x_read_data(struct ad463x_dev *dev,
 	return ret;
 }
 
+/**
+ * @brief Start continuous capture.
+ *
+ * The offload module runs on every PWM trigger and the samples are written in
+ * a ring of nb_blocks blocks of block_samples samples each, until
+ * ad463x_stream_stop() is called. Blocks are consumed with
+ * ad463x_stream_read(); if they are not consumed fast enough, samples are
+ * dropped and counted as overflows.
+ * @param [in] dev - The device structure.
+ * @param [in] buf - DMA capable memory of nb_blocks * block_samples samples.
+ * @param [in] block_samples - Number of samples in a block.
+ * @param [in] nb_blocks - Number of blocks in the ring.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad463x_stream_start(struct ad463x_dev *dev,
+			    uint32_t *buf,
+			    uint32_t block_samples,
+			    uint32_t nb_blocks)
+{
+	struct spi_engine_offload_stream_init stream_init;
+	int32_t ret;
+	uint32_t spi_eng_msg_cmds[3] = {
+		CS_LOW,
+		READ(dev->read_bytes_no),
+		CS_HIGH
+	};
+
+	if (!buf || !block_samples)
+		return -EINVAL;
+
+	ret = spi_engine_offload_init(dev->spi_desc, dev->offload_init_param);
+	if (ret != 0)
+		return ret;
+
+	stream_init.commands = spi_eng_msg_cmds;
+	stream_init.no_commands = NO_OS_ARRAY_SIZE(spi_eng_msg_cmds);
+	stream_init.commands_data = NULL;
+	stream_init.rx_addr = (uint32_t)buf;
+	stream_init.block_size = block_samples * sizeof(*buf);
+	stream_init.nb_blocks = nb_blocks;
+	stream_init.block_done = NULL;
+	stream_init.ctx = NULL;
+
+	ret = spi_engine_offload_stream_start(dev->spi_desc, &stream_init);
+	if (ret != 0)
+		return ret;
+
+	dev->stream_block_samples = block_samples;
+	dev->stream_block = NULL;
+	dev->stream_pos = 0;
+
+	ret = no_os_pwm_enable(dev->trigger_pwm_desc);
+	if (ret != 0) {
+		spi_engine_offload_stream_stop(dev->spi_desc, NULL);
+		return ret;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Read samples from the continuous capture.
+ *
+ * Waits until enough blocks are captured. A block is given back to the DMA as
+ * soon as all its samples were read.
+ * @param [in] dev - The device structure.
+ * @param [out] buf - Where the samples are stored.
+ * @param [in] samples - Number of samples to read.
+ * @return 0 in case of success, -ETIMEDOUT if no block was captured for
+ * AD463X_STREAM_TIMEOUT_US, e.g. without CNV trigger, negative error code
+ * otherwise.
+ */
+int32_t ad463x_stream_read(struct ad463x_dev *dev,
+			   uint32_t *buf,
+			   uint32_t samples)
+{
+	uint32_t timeout = AD463X_STREAM_TIMEOUT_US / 10;
+	uint32_t address;
+	uint32_t count;
+	int32_t ret;
+
+	if (!dev || !buf)
+		return -EINVAL;
+
+	while (samples) {
+		if (!dev->stream_block) {
+			ret = spi_engine_offload_stream_get_block(dev->spi_desc,
+					&address);
+			if (ret == -EAGAIN) {
+				if (!timeout--)
+					return -ETIMEDOUT;
+				no_os_udelay(10);
+				continue;
+			}
+			if (ret != 0)
+				return ret;
+
+			timeout = AD463X_STREAM_TIMEOUT_US / 10;
+
+			if (dev->dcache_invalidate_range)
+				dev->dcache_invalidate_range(address,
+							     dev->stream_block_samples *
+							     sizeof(*buf));
+			dev->stream_block = (uint32_t *)address;
+			dev->stream_pos = 0;
+		}
+
+		count = no_os_min(samples,
+				  dev->stream_block_samples - dev->stream_pos);
+		memcpy(buf, dev->stream_block + dev->stream_pos,
+		       count * sizeof(*buf));
+		buf += count;
+		samples -= count;
+		dev->stream_pos += count;
+
+		if (dev->stream_pos == dev->stream_block_samples) {
+			dev->stream_block = NULL;
+			ret = spi_engine_offload_stream_release_block(dev->spi_desc);
+			if (ret != 0)
+				return ret;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Stop continuous capture.
+ * @param [in] dev - The device structure.
+ * @param [out] stats - Optional. Capture statistics.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad463x_stream_stop(struct ad463x_dev *dev,
+			   struct spi_engine_offload_stats *stats)
+{
+	int32_t ret;
+
+	if (!dev)
+		return -EINVAL;
+
+	ret = no_os_pwm_disable(dev->trigger_pwm_desc);
+	if (ret != 0)
+		return ret;
+
+	dev->stream_block = NULL;
+
+	return spi_engine_offload_stream_stop(dev->spi_desc, stats);
+}
+
 /**
  * @brief Initialize the device.
  * @param [out] device - The device structure.
@@ -414,6 +564,9 @@ int32_t ad463x_init(struct ad463x_dev **device,
 	dev->data_rate = init_param->data_rate;
 	dev->device_id = init_param->device_id;
 	dev->dcache_invalidate_range = init_param->dcache_invalidate_range;
+	dev->stream_block_samples = 0;
+	dev->stream_block = NULL;
+	dev->stream_pos = 0;
 
 	if (dev->output_mode > AD463X_16_DIFF_8_COM)
 		sample_width = 32;
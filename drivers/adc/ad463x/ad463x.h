@@ -147,6 +147,8 @@
 #define AD463X_TRIGGER_PULSE_WIDTH_NS	0x0A
 
 #define AD463X_GAIN_MAX_VAL_SCALED	19997
+/* Maximum time ad463x_stream_read() waits for the next block */
+#define AD463X_STREAM_TIMEOUT_US	1000000
 
 /**
  * @enum ad463x_id
@@ -243,6 +245,12 @@ struct ad463x_dev {
 	uint8_t output_mode;
 	/** Invalidate the Data cache for the given address range */
 	void (*dcache_invalidate_range)(uint32_t address, uint32_t bytes_count);
+	/** Samples in a block of the continuous capture ring */
+	uint32_t stream_block_samples;
+	/** Block being read by ad463x_stream_read(), NULL if none */
+	uint32_t *stream_block;
+	/** Samples already read from stream_block */
+	uint32_t stream_pos;
 };
 
 /******************************************************************************/
@@ -295,6 +303,21 @@ int32_t ad463x_read_data(struct ad463x_dev *dev,
 			 uint32_t *buf,
 			 uint16_t samples);
 
+/** Start continuous capture */
+int32_t ad463x_stream_start(struct ad463x_dev *dev,
+			    uint32_t *buf,
+			    uint32_t block_samples,
+			    uint32_t nb_blocks);
+
+/** Read samples from the continuous capture */
+int32_t ad463x_stream_read(struct ad463x_dev *dev,
+			   uint32_t *buf,
+			   uint32_t samples);
+
+/** Stop continuous capture */
+int32_t ad463x_stream_stop(struct ad463x_dev *dev,
+			   struct spi_engine_offload_stats *stats);
+
 /** Device initialization */
 int32_t ad463x_init(struct ad463x_dev **device,
 		    struct ad463x_init_param *init_param);
@@ -44,13 +44,17 @@
 
 #include "ad463x.h"
 #include "iio_ad463x.h"
+#include "iio.h"
 #include "no_os_error.h"
+#include "no_os_print_log.h"
 
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
 
 #define BITS_PER_SAMPLE 32
+/* Samples copied from the capture ring at once */
+#define STREAM_CHUNK_SAMPLES 64
 
 static struct scan_type adc_scan_type = {
 	.sign = 'u',
@@ -87,14 +91,52 @@ static int32_t _iio_ad463x_prepare_transfer(struct iio_ad463x *desc,
 
 	desc->mask = mask;
 
+	if (!desc->stream_buf)
+		return 0;
+
+	return ad463x_stream_start(desc->ad463x_desc, desc->stream_buf,
+				   desc->stream_block_samples,
+				   desc->stream_nb_blocks);
+}
+
+static int32_t _iio_ad463x_end_transfer(struct iio_ad463x *desc)
+{
+	struct spi_engine_offload_stats stats;
+	int32_t ret;
+
+	if (!desc)
+		return -EINVAL;
+
+	if (!desc->stream_buf)
+		return 0;
+
+	ret = ad463x_stream_stop(desc->ad463x_desc, &stats);
+	if (ret)
+		return ret;
+
+	pr_info("ad463x: capture stopped, %lu blocks, %lu overflows\n",
+		(unsigned long)stats.blocks, (unsigned long)stats.overflows);
+
 	return 0;
 }
 
+static void _iio_ad463x_fill_scans(struct iio_ad463x *desc, uint32_t *buff,
+				   uint32_t *data, uint32_t nb_samples)
+{
+	uint32_t i, j, ch;
+
+	for(i = 0, j = 0; i < nb_samples; i++)
+		for (ch = 0; ch < desc->iio_dev_desc.num_ch; ch++)
+			if (desc->mask & NO_OS_BIT(ch)) {
+				buff[j++] = data[i];
+			}
+}
+
 static int32_t _iio_ad463x_read_dev(struct iio_ad463x *desc, uint32_t *buff,
 				    uint32_t nb_samples)
 {
 	int ret;
-	uint32_t data[nb_samples], i, j, ch;
+	uint32_t data[nb_samples];
 
 	if (!desc)
 		return -EINVAL;
@@ -103,15 +145,62 @@ static int32_t _iio_ad463x_read_dev(struct iio_ad463x *desc, uint32_t *buff,
 	if(ret)
 		return ret;
 
-	for(i = 0, j = 0; i < nb_samples; i++)
-		for (ch = 0; ch < desc->iio_dev_desc.num_ch; ch++)
-			if (desc->mask & NO_OS_BIT(ch)) {
-				buff[j++] = data[i];
-			}
+	_iio_ad463x_fill_scans(desc, buff, data, nb_samples);
 
 	return nb_samples;
 }
 
+static int32_t _iio_ad463x_read_stream(struct iio_ad463x *desc, uint32_t *buff,
+				       uint32_t nb_samples, uint32_t nb_ch)
+{
+	uint32_t data[STREAM_CHUNK_SAMPLES];
+	uint32_t count;
+	int32_t ret;
+
+	while (nb_samples) {
+		count = no_os_min(nb_samples, (uint32_t)STREAM_CHUNK_SAMPLES);
+		ret = ad463x_stream_read(desc->ad463x_desc, data, count);
+		if (ret)
+			return ret;
+
+		_iio_ad463x_fill_scans(desc, buff, data, count);
+		buff += count * nb_ch;
+		nb_samples -= count;
+	}
+
+	return 0;
+}
+
+static int32_t _iio_ad463x_submit(struct iio_device_data *iio_dev_data)
+{
+	struct iio_ad463x *desc;
+	uint32_t nb_samples;
+	void *buff;
+	int32_t ret;
+
+	desc = iio_dev_data->dev;
+	if (!desc)
+		return -EINVAL;
+
+	ret = iio_buffer_get_block(iio_dev_data->buffer, &buff);
+	if (ret)
+		return ret;
+
+	nb_samples = iio_dev_data->buffer->size /
+		     iio_dev_data->buffer->bytes_per_scan;
+
+	if (desc->stream_buf)
+		ret = _iio_ad463x_read_stream(desc, buff, nb_samples,
+					      iio_dev_data->buffer->bytes_per_scan /
+					      sizeof(uint32_t));
+	else
+		ret = _iio_ad463x_read_dev(desc, buff, nb_samples);
+	if (NO_OS_IS_ERR_VALUE(ret))
+		return ret;
+
+	return iio_buffer_block_done(iio_dev_data->buffer);
+}
+
 /**
  * @brief Init for reading/writing and parameterization of a
  * ad463x device.
@@ -155,7 +244,8 @@ struct iio_device ad463x_iio_desc = {
 	.channels = iio_adc_channels,
 	.num_ch = 2,
 	.pre_enable = (int32_t (*)())_iio_ad463x_prepare_transfer,
-	.read_dev = (int32_t (*)())_iio_ad463x_read_dev
+	.post_disable = (int32_t (*)())_iio_ad463x_end_transfer,
+	.submit = _iio_ad463x_submit
 };
 
 #endif /* IIO_SUPPORT */
@@ -60,6 +60,13 @@ struct iio_ad463x {
 	struct iio_device iio_dev_desc;
 	/** Device Descriptor */
 	struct ad463x_dev *ad463x_desc;
+	/** Optional. Ring used for continuous capture while the buffer is
+	 * enabled. When NULL, each buffer read is a separate capture */
+	uint32_t *stream_buf;
+	/** Samples in a block of stream_buf */
+	uint32_t stream_block_samples;
+	/** Number of blocks in stream_buf */
+	uint32_t stream_nb_blocks;
 };
 
 extern struct iio_device ad463x_iio_desc;
@@ -45,6 +45,8 @@
 #include <stdbool.h>
 #include "ad7124.h"
 #include "no_os_delay.h"
+#include "no_os_crc8.h"
+#include "no_os_error.h"
 
 /* Error codes */
 #define INVALID_VAL -1 /* Invalid argument */
@@ -201,6 +203,10 @@ int32_t ad7124_read_register(struct ad7124_dev *dev,
 {
 	int32_t ret;
 
+	/* Register accesses would be taken as data reads */
+	if (dev->cont_read)
+		return -EBUSY;
+
 	if (p_reg->addr != AD7124_ERR_REG && dev->check_ready) {
 		ret = ad7124_wait_for_spi_ready(dev,
 						dev->spi_rdy_poll_cnt);
@@ -250,6 +256,9 @@ int32_t ad7124_write_register(struct ad7124_dev *dev,
 {
 	int32_t ret;
 
+	if (dev->cont_read)
+		return -EBUSY;
+
 	if (dev->check_ready) {
 		ret = ad7124_wait_for_spi_ready(dev,
 						dev->spi_rdy_poll_cnt);
@@ -272,6 +281,10 @@ int32_t ad7124_write_register(struct ad7124_dev *dev,
 int32_t ad7124_write_register2(struct ad7124_dev *dev, uint32_t reg,
 			       uint32_t writeval)
 {
+	/* The cache must match the device, which can't be written now */
+	if (dev->cont_read)
+		return -EBUSY;
+
 	dev->regs[reg].value = writeval;
 
 	return ad7124_write_register(dev, dev->regs[reg]);
@@ -472,24 +485,7 @@ int32_t ad7124_get_read_chan_id(struct ad7124_dev *dev, uint32_t *status)
 *******************************************************************************/
 uint8_t ad7124_compute_crc8(uint8_t * p_buf, uint8_t buf_size)
 {
-	uint8_t i = 0;
-	uint8_t crc = 0;
-
-	while(buf_size) {
-		for(i = 0x80; i != 0; i >>= 1) {
-			bool cmp1 = (crc & 0x80) != 0;
-			bool cmp2 = (*p_buf & i) != 0;
-			if(cmp1 != cmp2) { /* MSB of CRC register XOR input Bit from Data */
-				crc <<= 1;
-				crc ^= AD7124_CRC8_POLYNOMIAL_REPRESENTATION;
-			} else {
-				crc <<= 1;
-			}
-		}
-		p_buf++;
-		buf_size--;
-	}
-	return crc;
+	return no_os_crc8(no_os_crc8_poly07_table, p_buf, buf_size, 0);
 }
 
 /***************************************************************************//**
@@ -539,6 +535,259 @@ void ad7124_update_dev_spi_settings(struct ad7124_dev *dev)
 	}
 }
 
+/**
+ * @brief Reads a conversion result while in continuous read mode. No command
+ *        is sent, the data register is clocked out directly, followed by the
+ *        status byte and, if enabled, the CRC.
+ *
+ * @param dev    - The handler of the instance of the driver.
+ * @param data   - Pointer to store the conversion result.
+ * @param status - Pointer to store the status byte, the channel of the
+ *                 conversion is AD7124_STATUS_REG_CH_ACTIVE(status).
+ *
+ * @return Returns 0 for success or negative error code.
+ */
+int32_t ad7124_cont_read_sample(struct ad7124_dev *dev, int32_t *data,
+				uint8_t *status)
+{
+	uint8_t buffer[6] = {0};
+	uint8_t len = 4;
+	int32_t ret;
+
+	if (!dev || !data || !status)
+		return -EINVAL;
+
+	if (dev->use_crc != AD7124_DISABLE_CRC)
+		len++;
+
+	ret = no_os_spi_write_and_read(dev->spi_desc, &buffer[1], len);
+	if (ret < 0)
+		return ret;
+
+	/* The CRC also covers the read command, even if it is not sent */
+	if (dev->use_crc != AD7124_DISABLE_CRC) {
+		buffer[0] = AD7124_COMM_REG_WEN | AD7124_COMM_REG_RD |
+			    AD7124_COMM_REG_RA(AD7124_DATA_REG);
+		if (ad7124_compute_crc8(buffer, len + 1))
+			return -EBADMSG;
+	}
+
+	*data = ((int32_t)buffer[1] << 16) | ((int32_t)buffer[2] << 8) |
+		buffer[3];
+	*status = buffer[4];
+
+	return 0;
+}
+
+/**
+ * @brief Writes the cached configuration registers, ADC_Control through
+ *        Filter_7, to the device.
+ *
+ * @param dev - The handler of the instance of the driver.
+ *
+ * @return Returns 0 for success or negative error code.
+ */
+static int32_t ad7124_write_config(struct ad7124_dev *dev)
+{
+	enum ad7124_registers reg_nr;
+	int32_t ret;
+
+	for (reg_nr = AD7124_Status; reg_nr < AD7124_Offset_0; reg_nr++) {
+		if (dev->regs[reg_nr].rw == AD7124_RW) {
+			ret = ad7124_write_register(dev, dev->regs[reg_nr]);
+			if (ret < 0)
+				return ret;
+		}
+
+		/* Get CRC State and device SPI interface settings */
+		if (reg_nr == AD7124_Error_En) {
+			ad7124_update_crcsetting(dev);
+			ad7124_update_dev_spi_settings(dev);
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Exits continuous read mode. Must be called while DOUT/RDY is low.
+ *
+ * @param dev - The handler of the instance of the driver.
+ *
+ * @return Returns 0 for success or negative error code.
+ */
+static int32_t ad7124_cont_read_exit(struct ad7124_dev *dev)
+{
+	uint8_t buffer[6] = {0};
+
+	/* Reading the data register with a command ends continuous read */
+	buffer[0] = AD7124_COMM_REG_WEN | AD7124_COMM_REG_RD |
+		    AD7124_COMM_REG_RA(AD7124_DATA_REG);
+
+	return no_os_spi_write_and_read(dev->spi_desc, buffer,
+					(dev->use_crc != AD7124_DISABLE_CRC) ? 6 : 5);
+}
+
+/**
+ * @brief DOUT/RDY falling edge handler, reads one conversion per interrupt.
+ *
+ * The interrupt is kept disabled during the read since DOUT/RDY also toggles
+ * with the data being clocked out.
+ *
+ * @param ctx   - The handler of the instance of the driver.
+ * @param event - Not used.
+ * @param extra - Not used.
+ */
+static void ad7124_rdy_irq_handler(void *ctx, uint32_t event, void *extra)
+{
+	struct ad7124_dev *dev = ctx;
+	int32_t data;
+	uint8_t status;
+
+	no_os_irq_disable(dev->irq_desc, dev->rdy_irq_id);
+
+	if (dev->cont_read_stop) {
+		ad7124_cont_read_exit(dev);
+		dev->cont_read = false;
+		return;
+	}
+
+	if (!ad7124_cont_read_sample(dev, &data, &status))
+		dev->cont_read_cb(dev->cont_read_ctx, data, status);
+
+	no_os_irq_enable(dev->irq_desc, dev->rdy_irq_id);
+}
+
+/**
+ * @brief Starts continuous conversion of the enabled channels with the
+ *        DATA_STATUS and CONT_READ modes set. Each falling edge of DOUT/RDY
+ *        triggers a single SPI read of the result and the status byte, which
+ *        are passed to the callback from the interrupt context.
+ *
+ * Register accesses fail with -EBUSY until ad7124_cont_read_stop() is called.
+ *
+ * @param dev      - The handler of the instance of the driver.
+ * @param callback - Called for each conversion with the result and the status
+ *                   byte, identifying the channel.
+ * @param ctx      - Parameter passed to the callback.
+ *
+ * @return Returns 0 for success or negative error code.
+ */
+int32_t ad7124_cont_read_start(struct ad7124_dev *dev,
+			       void (*callback)(void *ctx, int32_t data,
+					       uint8_t status),
+			       void *ctx)
+{
+	int32_t adc_ctrl;
+	int32_t ret;
+
+	if (!dev || !callback)
+		return -EINVAL;
+	if (!dev->irq_desc)
+		return -ENOSYS;
+	if (dev->cont_read)
+		return -EBUSY;
+
+	dev->cont_read_cb = callback;
+	dev->cont_read_ctx = ctx;
+	dev->cont_read_stop = false;
+	dev->rdy_cb.callback = ad7124_rdy_irq_handler;
+	dev->rdy_cb.ctx = dev;
+
+	ret = no_os_irq_trigger_level_set(dev->irq_desc, dev->rdy_irq_id,
+					  NO_OS_IRQ_EDGE_FALLING);
+	if (ret)
+		return ret;
+
+	ret = no_os_irq_register_callback(dev->irq_desc, dev->rdy_irq_id,
+					  &dev->rdy_cb);
+	if (ret)
+		return ret;
+
+	/* Continuous conversion mode with the status appended to the data */
+	dev->cont_read_adc_ctrl = dev->regs[AD7124_ADC_Control].value;
+	adc_ctrl = dev->cont_read_adc_ctrl & ~AD7124_ADC_CTRL_REG_MODE(0xF);
+	adc_ctrl |= AD7124_ADC_CTRL_REG_DATA_STATUS |
+		    AD7124_ADC_CTRL_REG_CONT_READ;
+	ret = ad7124_write_register2(dev, AD7124_ADC_Control, adc_ctrl);
+	if (ret)
+		goto error;
+
+	dev->cont_read = true;
+
+	/* On failure the device stays in continuous read until reset */
+	return no_os_irq_enable(dev->irq_desc, dev->rdy_irq_id);
+
+error:
+	dev->regs[AD7124_ADC_Control].value = dev->cont_read_adc_ctrl;
+	no_os_irq_unregister(dev->irq_desc, dev->rdy_irq_id);
+
+	return ret;
+}
+
+/**
+ * @brief Stops continuous conversion started by ad7124_cont_read_start().
+ *
+ * Continuous read mode can only be exited while a result is available, so
+ * this waits for the next conversion before restoring the ADC control
+ * register. If no conversion ends in time the device is taken out of
+ * continuous read here, by a reset if needed, and -ETIMEDOUT is returned
+ * with the driver usable again.
+ *
+ * @param dev - The handler of the instance of the driver.
+ *
+ * @return Returns 0 for success or negative error code.
+ */
+int32_t ad7124_cont_read_stop(struct ad7124_dev *dev)
+{
+	uint32_t timeout = AD7124_CONT_READ_TIMEOUT_US / 100;
+	uint32_t adc_ctrl;
+	int32_t ret;
+
+	if (!dev)
+		return -EINVAL;
+	if (!dev->cont_read)
+		return 0;
+
+	dev->cont_read_stop = true;
+	while (dev->cont_read && --timeout)
+		no_os_udelay(100);
+
+	if (timeout) {
+		no_os_irq_unregister(dev->irq_desc, dev->rdy_irq_id);
+
+		return ad7124_write_register2(dev, AD7124_ADC_Control,
+					      dev->cont_read_adc_ctrl);
+	}
+
+	/* The device stopped converting, the handler won't run anymore */
+	no_os_irq_disable(dev->irq_desc, dev->rdy_irq_id);
+	no_os_irq_unregister(dev->irq_desc, dev->rdy_irq_id);
+	dev->cont_read = false;
+	dev->cont_read_stop = false;
+
+	ret = ad7124_cont_read_exit(dev);
+	if (!ret)
+		ret = ad7124_write_register2(dev, AD7124_ADC_Control,
+					     dev->cont_read_adc_ctrl);
+	/* Without a result available the exit is ignored, check it */
+	if (!ret)
+		ret = ad7124_read_register2(dev, AD7124_ADC_Control, &adc_ctrl);
+	if (!ret && adc_ctrl != (uint32_t)dev->cont_read_adc_ctrl)
+		ret = -EIO;
+	if (ret) {
+		/* Still in continuous read, reset and restore the config */
+		dev->regs[AD7124_ADC_Control].value = dev->cont_read_adc_ctrl;
+		ret = ad7124_reset(dev);
+		if (!ret)
+			ret = ad7124_write_config(dev);
+		if (ret)
+			return ret;
+	}
+
+	return -ETIMEDOUT;
+}
+
 /***************************************************************************//**
  * @brief Initializes the AD7124.
  *
@@ -552,7 +801,6 @@ int32_t ad7124_setup(struct ad7124_dev **device,
 		     struct ad7124_init_param *init_param)
 {
 	int32_t ret;
-	enum ad7124_registers reg_nr;
 	struct ad7124_dev *dev;
 
 	dev = (struct ad7124_dev *)malloc(sizeof(*dev));
@@ -561,6 +809,10 @@ int32_t ad7124_setup(struct ad7124_dev **device,
 
 	dev->regs = init_param->regs;
 	dev->spi_rdy_poll_cnt = init_param->spi_rdy_poll_cnt;
+	dev->irq_desc = init_param->irq_desc;
+	dev->rdy_irq_id = init_param->rdy_irq_id;
+	dev->cont_read = false;
+	dev->cont_read_stop = false;
 
 	/* Initialize the SPI communication. */
 	ret = no_os_spi_init(&dev->spi_desc, init_param->spi_init);
@@ -576,20 +828,8 @@ int32_t ad7124_setup(struct ad7124_dev **device,
 	dev->check_ready = 1;
 
 	/* Initialize registers AD7124_ADC_Control through AD7124_Filter_7. */
-	for(reg_nr = AD7124_Status; (reg_nr < AD7124_Offset_0) && !(ret < 0);
-	    reg_nr++) {
-		if (dev->regs[reg_nr].rw == AD7124_RW) {
-			ret = ad7124_write_register(dev, dev->regs[reg_nr]);
-			if (ret < 0)
-				break;
-		}
-
-		/* Get CRC State and device SPI interface settings */
-		if (reg_nr == AD7124_Error_En) {
-			ad7124_update_crcsetting(dev);
-			ad7124_update_dev_spi_settings(dev);
-		}
-	}
+	if (!(ret < 0))
+		ret = ad7124_write_config(dev);
 
 	*device = dev;
 
@@ -45,7 +45,9 @@
 /***************************** Include Files **********************************/
 /******************************************************************************/
 #include <stdint.h>
+#include <stdbool.h>
 #include "no_os_spi.h"
+#include "no_os_irq.h"
 #include "no_os_delay.h"
 
 /******************************************************************************/
@@ -342,6 +344,11 @@ enum ad7124_registers {
  * @spi_rdy_poll_cnt: Number of times the driver should read the Error register
  *                    to check if the device is ready to accept user requests,
  *                    before a timeout error will be issued.
+ * @irq_desc: Interrupt controller handling the DOUT/RDY pin, NULL if the pin
+ *            is not connected to an interrupt. Used only for continuous read.
+ * @rdy_irq_id: Interrupt ID of the DOUT/RDY pin.
+ * @cont_read: Set while the device is in continuous read mode.
+ * @cont_read_stop: Set to exit continuous read mode on the next conversion.
  */
 struct ad7124_dev {
 	/* SPI */
@@ -351,6 +358,16 @@ struct ad7124_dev {
 	int16_t use_crc;
 	int16_t check_ready;
 	int16_t spi_rdy_poll_cnt;
+	/* GPIO IRQ - used only for continuous read */
+	struct no_os_irq_ctrl_desc *irq_desc;
+	uint32_t rdy_irq_id;
+	/* Continuous read state */
+	volatile bool cont_read;
+	volatile bool cont_read_stop;
+	int32_t cont_read_adc_ctrl;
+	struct no_os_callback_desc rdy_cb;
+	void (*cont_read_cb)(void *ctx, int32_t data, uint8_t status);
+	void *cont_read_ctx;
 };
 
 struct ad7124_init_param {
@@ -359,6 +376,9 @@ struct ad7124_init_param {
 	/* Device Settings */
 	struct ad7124_st_reg	*regs;
 	int16_t spi_rdy_poll_cnt;
+	/* GPIO IRQ - used only for continuous read */
+	struct no_os_irq_ctrl_desc *irq_desc;
+	uint32_t rdy_irq_id;
 };
 
 /******************************************************************************/
@@ -368,6 +388,9 @@ struct ad7124_init_param {
 #define AD7124_DISABLE_CRC 0
 #define AD7124_USE_CRC 1
 
+/* Maximum time to wait for a conversion in continuous read mode */
+#define AD7124_CONT_READ_TIMEOUT_US	2000000
+
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
@@ -442,6 +465,19 @@ float ad7124_get_odr(struct ad7124_dev *dev, int16_t ch_no);
 int32_t ad7124_set_odr(struct ad7124_dev *dev, float odr,
 		       int16_t ch_no);
 
+/*! Reads a conversion result while in continuous read mode. */
+int32_t ad7124_cont_read_sample(struct ad7124_dev *dev, int32_t *data,
+				uint8_t *status);
+
+/*! Starts continuous conversion with data read on the DOUT/RDY interrupt. */
+int32_t ad7124_cont_read_start(struct ad7124_dev *dev,
+			       void (*callback)(void *ctx, int32_t data,
+					       uint8_t status),
+			       void *ctx);
+
+/*! Stops continuous conversion started by ad7124_cont_read_start(). */
+int32_t ad7124_cont_read_stop(struct ad7124_dev *dev);
+
 /*! Initializes the AD7124. */
 int32_t ad7124_setup(struct ad7124_dev **device,
 		     struct ad7124_init_param *init_param);
@@ -49,8 +49,50 @@
 #include "iio.h"
 #include "iio_ad7124.h"
 #include "no_os_util.h"
+#include "no_os_delay.h"
+#include "no_os_print_log.h"
+#include "no_os_spsc_ring.h"
 #include "ad7124.h"
 
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/** Size of the ring holding the scans read in continuous read mode */
+#define IIO_AD7124_RING_SIZE	4096
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct iio_ad7124_scan
+ * @brief State used to rebuild scans from the conversions of the sequencer
+ * in continuous read mode. The scans are queued by the interrupt and copied
+ * to the buffer blocks by submit.
+ */
+struct iio_ad7124_scan {
+	/** Scans not yet copied to the buffer */
+	struct no_os_spsc_ring ring;
+	/** Active channels */
+	uint32_t mask;
+	/** Channels converted for the current scan */
+	uint32_t filled;
+	/** Results of the current scan, indexed by channel */
+	int32_t data[16];
+	/** Number of scans dropped because the ring was full */
+	volatile uint32_t lost;
+	/** Value of lost when it was last reported */
+	uint32_t lost_reported;
+};
+
+/******************************************************************************/
+/************************ Variable Declarations ******************************/
+/******************************************************************************/
+
+static uint8_t iio_ad7124_ring_mem[IIO_AD7124_RING_SIZE];
+static struct iio_ad7124_scan iio_ad7124_scan;
+
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
@@ -705,6 +747,153 @@ static int32_t iio_ad7124_read_samples(void *dev, int32_t *buff,
 	return nb_samples;
 }
 
+/**
+ * @brief Store one conversion of the continuous read. A scan is queued once
+ *        all the active channels have been converted, a channel coming again
+ *        before that means a conversion was missed so the scan is restarted.
+ * @param [in] ctx - Scan state.
+ * @param [in] data - Conversion result.
+ * @param [in] status - Status byte holding the channel of the conversion.
+ */
+static void iio_ad7124_scan_cb(void *ctx, int32_t data, uint8_t status)
+{
+	struct iio_ad7124_scan *scan = ctx;
+	uint32_t ch = AD7124_STATUS_REG_CH_ACTIVE(status);
+	uint32_t ch_idx = -1;
+	int32_t out[16];
+	uint32_t nb = 0;
+
+	if (!(scan->mask & NO_OS_BIT(ch)))
+		return;
+
+	if (scan->filled & NO_OS_BIT(ch))
+		scan->filled = 0;
+
+	scan->data[ch] = data;
+	scan->filled |= NO_OS_BIT(ch);
+	if (scan->filled != scan->mask)
+		return;
+
+	while (get_next_ch_idx(scan->mask, ch_idx, &ch_idx))
+		out[nb++] = scan->data[ch_idx];
+	scan->filled = 0;
+
+	if (no_os_spsc_ring_push(&scan->ring, out, nb * sizeof(out[0])))
+		scan->lost++;
+}
+
+/**
+ * @brief Start the continuous read of the active channels.
+ * @param [in] desc - Device descriptor.
+ * @return 0 in case of success, error code otherwise.
+ */
+static int32_t iio_ad7124_cont_read_start(struct ad7124_dev *desc)
+{
+	struct iio_ad7124_scan *scan = &iio_ad7124_scan;
+	int32_t ret;
+
+	ret = iio_ad7124_get_active_channels(desc, &scan->mask);
+	if (ret)
+		return ret;
+	if (!scan->mask)
+		return -EINVAL;
+
+	scan->filled = 0;
+	scan->lost = 0;
+	scan->lost_reported = 0;
+	ret = no_os_spsc_ring_cfg(&scan->ring, iio_ad7124_ring_mem,
+				  sizeof(iio_ad7124_ring_mem));
+	if (ret)
+		return ret;
+
+	return ad7124_cont_read_start(desc, iio_ad7124_scan_cb, scan);
+}
+
+/**
+ * @brief Fill the IIO buffer block. When the DOUT/RDY pin is connected to an
+ *        interrupt, the device is put in continuous read mode by the first
+ *        submit and stays in it until the buffer is disabled, so no
+ *        conversion is missed between blocks. Otherwise the samples are
+ *        polled.
+ * @param [in] iio_dev_data - IIO device data.
+ * @return 0 in case of success, -ETIMEDOUT if the device stopped converting,
+ *         error code otherwise.
+ */
+static int32_t iio_ad7124_submit(struct iio_device_data *iio_dev_data)
+{
+	struct iio_ad7124_scan *scan = &iio_ad7124_scan;
+	struct ad7124_dev *desc = iio_dev_data->dev;
+	struct iio_buffer *buffer = iio_dev_data->buffer;
+	uint32_t timeout = AD7124_CONT_READ_TIMEOUT_US / 100;
+	uint32_t size;
+	uint32_t len;
+	uint8_t *buff;
+	int32_t ret;
+
+	ret = iio_buffer_get_block(buffer, (void **)&buff);
+	if (ret)
+		return ret;
+
+	if (!desc->irq_desc) {
+		ret = iio_ad7124_read_samples(desc, (int32_t *)buff,
+					      buffer->size /
+					      buffer->bytes_per_scan);
+		if (ret < 0)
+			return ret;
+
+		return iio_buffer_block_done(buffer);
+	}
+
+	if (!desc->cont_read) {
+		ret = iio_ad7124_cont_read_start(desc);
+		if (ret)
+			return ret;
+	}
+
+	for (size = 0; size < buffer->size; size += len) {
+		len = no_os_min(no_os_spsc_ring_used(&scan->ring),
+				buffer->size - size);
+		if (len) {
+			no_os_spsc_ring_pop(&scan->ring, buff + size, len);
+			timeout = AD7124_CONT_READ_TIMEOUT_US / 100;
+			continue;
+		}
+
+		if (!--timeout) {
+			ad7124_cont_read_stop(desc);
+			return -ETIMEDOUT;
+		}
+		no_os_udelay(100);
+	}
+
+	if (scan->lost != scan->lost_reported) {
+		pr_warning("ad7124: %"PRIu32" scans lost, buffer too slow\n",
+			   scan->lost - scan->lost_reported);
+		scan->lost_reported = scan->lost;
+	}
+
+	return iio_buffer_block_done(buffer);
+}
+
+/**
+ * @brief Stop the continuous read started by submit and close the active
+ *        channels.
+ * @param [in] dev - Device descriptor.
+ * @return 0 in case of success, error code otherwise.
+ */
+static int32_t iio_ad7124_post_disable(void *dev)
+{
+	struct ad7124_dev *desc = dev;
+	int32_t ret;
+	int32_t ret2;
+
+	/* Continuous read is left even when stop times out */
+	ret = ad7124_cont_read_stop(desc);
+	ret2 = iio_ad7124_close_channels(dev);
+
+	return ret ? ret : ret2;
+}
+
 struct iio_device iio_ad7124_device = {
 	.num_ch = NO_OS_ARRAY_SIZE(ad7124_channels),
 	.channels = ad7124_channels,
@@ -712,8 +901,9 @@ struct iio_device iio_ad7124_device = {
 	.debug_attributes = NULL,
 	.buffer_attributes = NULL,
 	.pre_enable = iio_ad7124_update_active_channels,
-	.post_disable = iio_ad7124_close_channels,
+	.post_disable = iio_ad7124_post_disable,
 	.read_dev = (int32_t (*)())iio_ad7124_read_samples,
+	.submit = iio_ad7124_submit,
 	.debug_reg_read = (int32_t (*)())ad7124_read_register2,
 	.debug_reg_write = (int32_t (*)())ad7124_write_register2
 };
@@ -44,6 +44,7 @@
 #include <stdlib.h>
 #include "ad7779.h"
 #include "no_os_error.h"
+#include "no_os_crc8.h"
 
 /******************************************************************************/
 /*************************** Constants Definitions ****************************/
@@ -80,22 +81,7 @@ const uint8_t pin_mode_options[16][4] = {
 uint8_t ad7779_compute_crc8(uint8_t *data,
 			    uint8_t data_size)
 {
-	uint8_t i;
-	uint8_t crc = 0;
-
-	while (data_size) {
-		for (i = 0x80; i != 0; i >>= 1) {
-			if (((crc & 0x80) != 0) != ((*data & i) != 0)) {
-				crc <<= 1;
-				crc ^= AD7779_CRC8_POLY;
-			} else
-				crc <<= 1;
-		}
-		data++;
-		data_size--;
-	}
-
-	return crc;
+	return no_os_crc8(no_os_crc8_poly07_table, data, data_size, 0);
 }
 
 /**
@@ -117,3 +117,34 @@ int32_t no_os_spi_transfer(struct no_os_spi_desc *desc,
 
 	return 0;
 }
+
+/**
+ * @brief Queue a transfer and return without waiting for it to be sent.
+ * Requests are sent in submission order and the callback of each request is
+ * called when it is done. Multiple requests may be queued, as long as each
+ * request and its messages are kept valid until its callback is called.
+ * Platforms without asynchronous support send the request before returning
+ * and call the callback from this function.
+ * @param desc - The SPI descriptor.
+ * @param req - The request.
+ * @return 0 if the request was queued, negative error code otherwise.
+ */
+int32_t no_os_spi_transfer_async(struct no_os_spi_desc *desc,
+				 struct no_os_spi_async_req *req)
+{
+	int32_t ret;
+
+	if (!desc || !desc->platform_ops || !req || !req->callback)
+		return -EINVAL;
+
+	req->desc = desc;
+	req->next = NULL;
+
+	if (desc->platform_ops->transfer_async)
+		return desc->platform_ops->transfer_async(desc, req);
+
+	ret = no_os_spi_transfer(desc, req->msgs, req->len);
+	req->callback(req->ctx, ret);
+
+	return 0;
+}
@@ -551,6 +551,7 @@ error:
  *******************************************************************************/
 int32_t axi_adc_remove(struct axi_adc *adc)
 {
+	no_os_axi_io_release(adc->base);
 	free(adc);
 
 	return 0;
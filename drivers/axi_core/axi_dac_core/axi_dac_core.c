@@ -927,6 +927,7 @@ int32_t axi_dac_data_setup(struct axi_dac *dac)
  *******************************************************************************/
 int32_t axi_dac_remove(struct axi_dac *dac)
 {
+	no_os_axi_io_release(dac->base);
 	free(dac);
 
 	return 0;
@@ -49,6 +49,8 @@
 #include "no_os_delay.h"
 #include "axi_dmac.h"
 
+static void axi_dmac_stream_process(struct axi_dmac *dmac);
+
 /***************************************************************************//**
  * @brief dma_isr
 *******************************************************************************/
@@ -62,6 +64,12 @@ void axi_dmac_default_isr(void *instance)
 	axi_dmac_read(dmac, AXI_DMAC_REG_IRQ_PENDING, &reg_val);
 	axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_PENDING, reg_val);
 
+	if (dmac->stream) {
+		if (reg_val & AXI_DMAC_IRQ_EOT)
+			axi_dmac_stream_process(dmac);
+		return;
+	}
+
 	if ((reg_val & AXI_DMAC_IRQ_SOT) && (dmac->big_transfer.size != 0)) {
 		remaining_size = dmac->big_transfer.size -
 				 dmac->big_transfer.size_done;
@@ -193,6 +201,33 @@ int32_t axi_dmac_is_transfer_ready(struct axi_dmac *dmac, bool *rdy)
 	return 0;
 }
 
+/***************************************************************************//**
+ * @brief Wait for a queued transfer to complete.
+ *******************************************************************************/
+static void axi_dmac_wait_transfer(struct axi_dmac *dmac, uint32_t transfer_id)
+{
+	uint32_t reg_val;
+
+	/* Wait until the new transfer is queued. */
+	do {
+		axi_dmac_read(dmac, AXI_DMAC_REG_START_TRANSFER, &reg_val);
+	} while(reg_val == 1);
+
+	/* Wait until the current transfer is completed. */
+	do {
+		axi_dmac_read(dmac, AXI_DMAC_REG_IRQ_PENDING, &reg_val);
+		if (reg_val == (AXI_DMAC_IRQ_SOT | AXI_DMAC_IRQ_EOT))
+			break;
+	} while(!dmac->big_transfer.transfer_done);
+	if (reg_val != (AXI_DMAC_IRQ_SOT | AXI_DMAC_IRQ_EOT))
+		axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_PENDING, reg_val);
+
+	/* Wait until the transfer with the ID transfer_id is completed. */
+	do {
+		axi_dmac_read(dmac, AXI_DMAC_REG_TRANSFER_DONE, &reg_val);
+	} while((reg_val & (1u << transfer_id)) != (1u << transfer_id));
+}
+
 /***************************************************************************//**
  * @brief axi_dmac_transfer
  *******************************************************************************/
@@ -214,6 +249,7 @@ int32_t axi_dmac_transfer(struct axi_dmac *dmac,
 	axi_dmac_read(dmac, AXI_DMAC_REG_TRANSFER_ID, &transfer_id);
 	axi_dmac_read(dmac, AXI_DMAC_REG_IRQ_PENDING, &reg_val);
 	axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_PENDING, reg_val);
+	dmac->big_transfer.transfer_done = false;
 
 	switch (dmac->direction) {
 	case DMA_DEV_TO_MEM:
@@ -264,24 +300,305 @@ int32_t axi_dmac_transfer(struct axi_dmac *dmac,
 	if (dmac->flags & DMA_CYCLIC)
 		return 0;
 
-	/* Wait until the new transfer is queued. */
-	do {
+	axi_dmac_wait_transfer(dmac, transfer_id);
+
+	return 0;
+}
+
+/***************************************************************************//**
+ * @brief axi_dmac_transfer_2d
+ *
+ * Transfer nb_rows rows of row_size bytes. On the memory side consecutive rows
+ * start stride bytes apart, on the device side data is contiguous. row_size
+ * and stride must be multiples of the bus width (transfer_align).
+ *******************************************************************************/
+int32_t axi_dmac_transfer_2d(struct axi_dmac *dmac, uint32_t address,
+			     uint32_t row_size, uint32_t nb_rows,
+			     uint32_t stride)
+{
+	uint32_t transfer_id;
+	uint32_t reg_val;
+
+	if (!row_size || !nb_rows)
+		return 0; /* nothing to do */
+
+	if (row_size - 1 > dmac->transfer_max_size ||
+	    nb_rows - 1 > dmac->transfer_max_rows ||
+	    row_size % dmac->transfer_align || stride % dmac->transfer_align)
+		return -EINVAL;
+
+	axi_dmac_write(dmac, AXI_DMAC_REG_CTRL, 0x0);
+	axi_dmac_write(dmac, AXI_DMAC_REG_CTRL, AXI_DMAC_CTRL_ENABLE);
+
+	axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_MASK, 0x0);
+
+	axi_dmac_read(dmac, AXI_DMAC_REG_TRANSFER_ID, &transfer_id);
+	axi_dmac_read(dmac, AXI_DMAC_REG_IRQ_PENDING, &reg_val);
+	axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_PENDING, reg_val);
+	dmac->big_transfer.transfer_done = false;
+
+	switch (dmac->direction) {
+	case DMA_DEV_TO_MEM:
+		axi_dmac_write(dmac, AXI_DMAC_REG_DEST_ADDRESS, address);
+		axi_dmac_write(dmac, AXI_DMAC_REG_DEST_STRIDE, stride);
+		break;
+	case DMA_MEM_TO_DEV:
+		axi_dmac_write(dmac, AXI_DMAC_REG_SRC_ADDRESS, address);
+		axi_dmac_write(dmac, AXI_DMAC_REG_SRC_STRIDE, stride);
+		break;
+	default:
+		return -1; // Other directions are not supported yet
+	}
+
+	axi_dmac_write(dmac, AXI_DMAC_REG_X_LENGTH, row_size - 1);
+	axi_dmac_write(dmac, AXI_DMAC_REG_Y_LENGTH, nb_rows - 1);
+
+	axi_dmac_write(dmac, AXI_DMAC_REG_FLAGS, dmac->flags);
+
+	axi_dmac_write(dmac, AXI_DMAC_REG_START_TRANSFER, 0x1);
+
+	if (dmac->flags & DMA_CYCLIC)
+		return 0;
+
+	axi_dmac_wait_transfer(dmac, transfer_id);
+
+	return 0;
+}
+
+/***************************************************************************//**
+ * @brief Abort the current transfer. Needed to end a DMA_CYCLIC transfer.
+ *******************************************************************************/
+int32_t axi_dmac_transfer_stop(struct axi_dmac *dmac)
+{
+	if (!dmac)
+		return -EINVAL;
+
+	return axi_dmac_write(dmac, AXI_DMAC_REG_CTRL, 0x0);
+}
+
+/***************************************************************************//**
+ * @brief Queue free blocks of the stream into the hardware queue.
+ *******************************************************************************/
+static void axi_dmac_stream_queue(struct axi_dmac *dmac)
+{
+	struct axi_dmac_stream *stream = dmac->stream;
+	uint32_t address;
+	uint32_t reg_val;
+	uint32_t idx;
+
+	while (stream->submitted - stream->released < stream->nb_blocks &&
+	       stream->submitted - stream->completed <
+	       AXI_DMAC_STREAM_QUEUE_DEPTH) {
+		/* Previous submission not yet accepted by the hardware */
 		axi_dmac_read(dmac, AXI_DMAC_REG_START_TRANSFER, &reg_val);
-	} while(reg_val == 1);
+		if (reg_val & 1)
+			break;
 
-	/* Wait until the current transfer is completed. */
-	do {
-		axi_dmac_read(dmac, AXI_DMAC_REG_IRQ_PENDING, &reg_val);
-		if (reg_val == (AXI_DMAC_IRQ_SOT | AXI_DMAC_IRQ_EOT))
+		idx = stream->submitted % stream->nb_blocks;
+		address = stream->address + idx * stream->block_size;
+		axi_dmac_read(dmac, AXI_DMAC_REG_TRANSFER_ID,
+			      &stream->ids[idx]);
+		/* Data was lost or not output right before this block */
+		stream->gaps[idx] = stream->drained;
+		stream->drained = false;
+
+		if (dmac->direction == DMA_DEV_TO_MEM) {
+			axi_dmac_write(dmac, AXI_DMAC_REG_DEST_ADDRESS, address);
+			axi_dmac_write(dmac, AXI_DMAC_REG_DEST_STRIDE, 0x0);
+		} else {
+			axi_dmac_write(dmac, AXI_DMAC_REG_SRC_ADDRESS, address);
+			axi_dmac_write(dmac, AXI_DMAC_REG_SRC_STRIDE, 0x0);
+		}
+		axi_dmac_write(dmac, AXI_DMAC_REG_X_LENGTH,
+			       stream->block_size - 1);
+		axi_dmac_write(dmac, AXI_DMAC_REG_Y_LENGTH, 0x0);
+		axi_dmac_write(dmac, AXI_DMAC_REG_FLAGS,
+			       dmac->flags & ~DMA_CYCLIC);
+		axi_dmac_write(dmac, AXI_DMAC_REG_START_TRANSFER, 0x1);
+
+		stream->submitted++;
+	}
+}
+
+/***************************************************************************//**
+ * @brief Retire the completed blocks of the stream and queue free ones.
+ *******************************************************************************/
+static void axi_dmac_stream_process(struct axi_dmac *dmac)
+{
+	struct axi_dmac_stream *stream = dmac->stream;
+	uint32_t retired = 0;
+	uint32_t done;
+	uint32_t idx;
+
+	axi_dmac_read(dmac, AXI_DMAC_REG_TRANSFER_DONE, &done);
+
+	/* Blocks complete in the order they were submitted */
+	while (stream->completed != stream->submitted) {
+		idx = stream->completed % stream->nb_blocks;
+		if (!(done & NO_OS_BIT(stream->ids[idx])))
 			break;
-	} while(!dmac->big_transfer.transfer_done);
-	if (reg_val != (AXI_DMAC_IRQ_SOT | AXI_DMAC_IRQ_EOT))
-		axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_PENDING, reg_val);
 
-	/* Wait until the transfer with the ID transfer_id is completed. */
-	do {
-		axi_dmac_read(dmac, AXI_DMAC_REG_TRANSFER_DONE, &reg_val);
-	} while((reg_val & (1u << transfer_id)) != (1u << transfer_id));
+		stream->completed++;
+		retired++;
+		if (stream->block_done)
+			stream->block_done(stream->ctx,
+					   stream->address +
+					   idx * stream->block_size,
+					   stream->block_size);
+	}
+
+	axi_dmac_stream_queue(dmac);
+
+	/* The hardware queue drained because no block was released in time */
+	if (retired && stream->completed == stream->submitted) {
+		stream->drained = true;
+		if (dmac->direction == DMA_DEV_TO_MEM)
+			stream->overflows++;
+		else
+			stream->underflows++;
+	}
+}
+
+/***************************************************************************//**
+ * @brief Start streaming through a ring of blocks.
+ *
+ * Blocks are queued into the DMAC hardware queue and retired in
+ * axi_dmac_default_isr, or in axi_dmac_stream_get_block when interrupts are
+ * not used. A completed block is handed back to the hardware only after it
+ * is released with axi_dmac_stream_release_block, so the user has
+ * nb_blocks - AXI_DMAC_STREAM_QUEUE_DEPTH blocks of slack before an
+ * overflow/underflow is reported.
+ *******************************************************************************/
+int32_t axi_dmac_stream_start(struct axi_dmac *dmac,
+			      const struct axi_dmac_stream_init *init)
+{
+	struct axi_dmac_stream *stream;
+
+	if (!dmac || !init || dmac->stream || init->nb_blocks < 2 ||
+	    !init->block_size || init->block_size - 1 > dmac->transfer_max_size)
+		return -EINVAL;
+
+	stream = (struct axi_dmac_stream *)calloc(1, sizeof(*stream));
+	if (!stream)
+		return -ENOMEM;
+
+	stream->ids = (uint32_t *)calloc(init->nb_blocks, sizeof(*stream->ids));
+	if (!stream->ids)
+		goto free_stream;
+
+	stream->gaps = (bool *)calloc(init->nb_blocks, sizeof(*stream->gaps));
+	if (!stream->gaps)
+		goto free_ids;
+
+	stream->address = init->address;
+	stream->block_size = init->block_size;
+	stream->nb_blocks = init->nb_blocks;
+	stream->block_done = init->block_done;
+	stream->ctx = init->ctx;
+
+	axi_dmac_write(dmac, AXI_DMAC_REG_CTRL, 0x0);
+	axi_dmac_write(dmac, AXI_DMAC_REG_CTRL, AXI_DMAC_CTRL_ENABLE);
+	axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_MASK,
+		       AXI_DMAC_IRQ_SOT | AXI_DMAC_IRQ_EOT);
+	axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_PENDING,
+		       AXI_DMAC_IRQ_SOT | AXI_DMAC_IRQ_EOT);
+
+	dmac->stream = stream;
+	axi_dmac_stream_queue(dmac);
+
+	/* Only the end of transfer interrupt is needed */
+	axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_MASK, AXI_DMAC_IRQ_SOT);
+
+	return 0;
+
+free_ids:
+	free(stream->ids);
+free_stream:
+	free(stream);
+
+	return -ENOMEM;
+}
+
+/***************************************************************************//**
+ * @brief Get the next completed block of the stream.
+ *
+ * The block belongs to the user until it is released with
+ * axi_dmac_stream_release_block. Several blocks may be held, they are released
+ * in the order they were obtained. gap (optional) is set when the hardware
+ * queue ran dry right before the block, i.e. samples were lost before it
+ * (DMA_DEV_TO_MEM) or the output stalled before it (DMA_MEM_TO_DEV).
+ * @return 0 on success, -EAGAIN if no block was completed yet.
+ *******************************************************************************/
+int32_t axi_dmac_stream_get_block(struct axi_dmac *dmac, uint32_t *address,
+				  bool *gap)
+{
+	struct axi_dmac_stream *stream;
+	uint32_t idx;
+
+	if (!dmac || !dmac->stream || !address)
+		return -EINVAL;
+
+	stream = dmac->stream;
+	if (stream->completed == stream->acquired) {
+		/* Also makes progress when the interrupt is not used */
+		axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_MASK,
+			       AXI_DMAC_IRQ_SOT | AXI_DMAC_IRQ_EOT);
+		axi_dmac_stream_process(dmac);
+		axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_MASK, AXI_DMAC_IRQ_SOT);
+		if (stream->completed == stream->acquired)
+			return -EAGAIN;
+	}
+
+	idx = stream->acquired % stream->nb_blocks;
+	*address = stream->address + idx * stream->block_size;
+	if (gap)
+		*gap = stream->gaps[idx];
+	stream->acquired++;
+
+	return 0;
+}
+
+/***************************************************************************//**
+ * @brief Give the oldest block obtained with axi_dmac_stream_get_block back
+ * to the hardware.
+ *******************************************************************************/
+int32_t axi_dmac_stream_release_block(struct axi_dmac *dmac)
+{
+	struct axi_dmac_stream *stream;
+
+	if (!dmac || !dmac->stream)
+		return -EINVAL;
+
+	stream = dmac->stream;
+	if (stream->acquired == stream->released)
+		return -EINVAL;
+
+	/* Mask the interrupt while the hardware queue is updated */
+	axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_MASK,
+		       AXI_DMAC_IRQ_SOT | AXI_DMAC_IRQ_EOT);
+	stream->released++;
+	axi_dmac_stream_queue(dmac);
+	axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_MASK, AXI_DMAC_IRQ_SOT);
+
+	return 0;
+}
+
+/***************************************************************************//**
+ * @brief Stop the stream and drop the queued transfers.
+ *******************************************************************************/
+int32_t axi_dmac_stream_stop(struct axi_dmac *dmac)
+{
+	if (!dmac || !dmac->stream)
+		return -EINVAL;
+
+	axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_MASK,
+		       AXI_DMAC_IRQ_SOT | AXI_DMAC_IRQ_EOT);
+	axi_dmac_write(dmac, AXI_DMAC_REG_CTRL, 0x0);
+
+	free(dmac->stream->gaps);
+	free(dmac->stream->ids);
+	free(dmac->stream);
+	dmac->stream = NULL;
 
 	return 0;
 }
@@ -307,6 +624,16 @@ int32_t axi_dmac_init(struct axi_dmac **dmac_core,
 	axi_dmac_write(dmac, AXI_DMAC_REG_X_LENGTH, dmac->transfer_max_size);
 	axi_dmac_read(dmac, AXI_DMAC_REG_X_LENGTH, &dmac->transfer_max_size);
 
+	/* Y_LENGTH reads back 0 when the core is built without 2D support */
+	axi_dmac_write(dmac, AXI_DMAC_REG_Y_LENGTH, -1);
+	axi_dmac_read(dmac, AXI_DMAC_REG_Y_LENGTH, &dmac->transfer_max_rows);
+	axi_dmac_write(dmac, AXI_DMAC_REG_Y_LENGTH, 0x0);
+
+	/* The bits of X_LENGTH below the bus width always read back as 1 */
+	axi_dmac_write(dmac, AXI_DMAC_REG_X_LENGTH, 0x0);
+	axi_dmac_read(dmac, AXI_DMAC_REG_X_LENGTH, &dmac->transfer_align);
+	dmac->transfer_align++;
+
 	*dmac_core = dmac;
 
 	return 0;
@@ -320,6 +647,10 @@ int32_t axi_dmac_remove(struct axi_dmac *dmac)
 	if(!dmac)
 		return -1;
 
+	if (dmac->stream)
+		axi_dmac_stream_stop(dmac);
+
+	no_os_axi_io_release(dmac->base);
 	free(dmac);
 
 	return 0;
@@ -68,6 +68,9 @@
 #define AXI_DMAC_REG_SRC_STRIDE		0x424
 #define AXI_DMAC_REG_TRANSFER_DONE	0x428
 
+/* Maximum number of transfers queued in hardware by the streaming mode */
+#define AXI_DMAC_STREAM_QUEUE_DEPTH	4
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
@@ -89,13 +92,49 @@ struct axi_dma_transfer {
 	volatile bool transfer_done;
 };
 
+struct axi_dmac_stream {
+	/* Address of the first block */
+	uint32_t address;
+	/* Size of a block in bytes */
+	uint32_t block_size;
+	/* Number of blocks in the ring */
+	uint32_t nb_blocks;
+	/* Hardware transfer ID of each block, valid while it is queued */
+	uint32_t *ids;
+	/* Set for a block queued after the hardware queue ran dry */
+	bool *gaps;
+	/* Set when the hardware queue ran dry, until a block is queued */
+	volatile bool drained;
+	/* Number of blocks submitted to the hardware since start */
+	volatile uint32_t submitted;
+	/* Number of blocks completed by the hardware since start */
+	volatile uint32_t completed;
+	/* Number of completed blocks handed to the user since start */
+	volatile uint32_t acquired;
+	/* Number of completed blocks released by the user since start */
+	volatile uint32_t released;
+	/* Number of times the DMAC ran out of blocks while capturing */
+	volatile uint32_t overflows;
+	/* Number of times the DMAC ran out of blocks while transmitting */
+	volatile uint32_t underflows;
+	/* Called for each completed block */
+	void (*block_done)(void *ctx, uint32_t address, uint32_t size);
+	/* Parameter passed to block_done */
+	void *ctx;
+};
+
 struct axi_dmac {
 	const char *name;
 	uint32_t base;
 	enum dma_direction direction;
 	uint32_t flags;
 	uint32_t transfer_max_size;
+	/* Maximum Y_LENGTH value. 0 if 2D transfers are not supported */
+	uint32_t transfer_max_rows;
+	/* Bus width in bytes, row sizes and strides are multiples of it */
+	uint32_t transfer_align;
 	volatile struct axi_dma_transfer big_transfer;
+	struct axi_dmac_stream *stream;
 };
 
 struct axi_dmac_init {
@@ -105,6 +144,21 @@ struct axi_dmac_init {
 	uint32_t flags;
 };
 
+struct axi_dmac_stream_init {
+	/* Address of nb_blocks * block_size bytes of DMA capable memory.
+	 * For DMA_MEM_TO_DEV it must be filled before starting the stream */
+	uint32_t address;
+	/* Size of a block in bytes */
+	uint32_t block_size;
+	/* Number of blocks in the ring. Minimum 2 */
+	uint32_t nb_blocks;
+	/* Optional. Called for each completed block. When the DMAC interrupt
+	 * is used it is called from interrupt context */
+	void (*block_done)(void *ctx, uint32_t address, uint32_t size);
+	/* Parameter passed to block_done */
+	void *ctx;
+};
+
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
@@ -118,6 +172,16 @@ int32_t axi_dmac_transfer_nonblocking(struct axi_dmac *dmac,
 int32_t axi_dmac_is_transfer_ready(struct axi_dmac *dmac, bool *rdy);
 int32_t axi_dmac_transfer(struct axi_dmac *dmac,
 			  uint32_t address, uint32_t size);
+int32_t axi_dmac_transfer_2d(struct axi_dmac *dmac, uint32_t address,
+			     uint32_t row_size, uint32_t nb_rows,
+			     uint32_t stride);
+int32_t axi_dmac_transfer_stop(struct axi_dmac *dmac);
+int32_t axi_dmac_stream_start(struct axi_dmac *dmac,
+			      const struct axi_dmac_stream_init *init);
+int32_t axi_dmac_stream_get_block(struct axi_dmac *dmac, uint32_t *address,
+				  bool *gap);
+int32_t axi_dmac_stream_release_block(struct axi_dmac *dmac);
+int32_t axi_dmac_stream_stop(struct axi_dmac *dmac);
 int32_t axi_dmac_init(struct axi_dmac **adc_core,
 		      const struct axi_dmac_init *init);
 int32_t axi_dmac_remove(struct axi_dmac *dmac);
@@ -383,6 +383,7 @@ int32_t no_os_pwm_remove(struct no_os_pwm_desc *desc)
 	if (ret != 0)
 		return -1;
 
+	no_os_axi_io_release(axi_desc->base_addr);
 	free(axi_desc);
 	free(desc);
 
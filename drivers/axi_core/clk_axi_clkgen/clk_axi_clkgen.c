@@ -544,6 +544,7 @@ int32_t axi_clkgen_init(struct axi_clkgen **clk,
  */
 int32_t axi_clkgen_remove(struct axi_clkgen *clkgen)
 {
+	no_os_axi_io_release(clkgen->base);
 	free(clkgen);
 
 	return 0;
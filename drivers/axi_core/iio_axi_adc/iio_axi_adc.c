@@ -47,14 +47,19 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "no_os_error.h"
+#include "no_os_print_log.h"
 #include "iio.h"
 #include "iio_axi_adc.h"
+#include "no_os_circular_buffer.h"
+#include "no_os_delay.h"
 
 /******************************************************************************/
 /************************ Functions Definitions *******************************/
 /******************************************************************************/
 
 #define STORAGE_BITS 16
+/* Maximum time to wait for a block of the continuous capture */
+#define IIO_AXI_ADC_STREAM_TIMEOUT_US	1000000
 
 /**
  * @brief get_cf_calibphase().
@@ -340,34 +345,144 @@ int32_t iio_axi_adc_prepare_transfer(void *dev, uint32_t mask)
 }
 
 /**
- * @brief Update active channels
+ * @brief Stop the continuous capture started by iio_axi_adc_submit().
  * @param dev - Instance of the iio_axi_adc
- * @param buff - Buffer where to read samples
- * @param nb_samples - Number of samples
  * @return 0 in case of success or negative value otherwise.
  */
-int32_t	iio_axi_adc_read_dev(void *dev, void *buff, uint32_t nb_samples)
+int32_t iio_axi_adc_post_disable(void *dev)
 {
-	struct iio_axi_adc_desc *iio_adc;
-	int ret, bytes;
+	struct iio_axi_adc_desc *iio_adc = dev;
 
-	if (!dev)
-		return -1;
+	if (!iio_adc->dmac->stream)
+		return 0;
 
-	iio_adc = (struct iio_axi_adc_desc *)dev;
-	bytes = nb_samples * no_os_hweight8(iio_adc->mask) * (STORAGE_BITS / 8);
+	return axi_dmac_stream_stop(iio_adc->dmac);
+}
 
+/**
+ * @brief Start capturing continuously into the device buffer, if it holds
+ * more than one block. The DMA ring is the circular buffer of the device, so
+ * it is only started when the next block is at the start of it.
+ * @param iio_adc - Instance of the iio_axi_adc
+ * @param buffer - Device buffer
+ * @param block - Next block of the buffer
+ * @return 0 in case of success or negative value otherwise.
+ */
+static int32_t iio_axi_adc_stream_start(struct iio_axi_adc_desc *iio_adc,
+					struct iio_buffer *buffer, void *block)
+{
+	struct axi_dmac_stream_init stream_init = {0};
+
+	if (block != buffer->buf->buff || buffer->buf->size / buffer->size < 2)
+		return 0;
+
+	stream_init.address = (uintptr_t)buffer->buf->buff;
+	stream_init.block_size = buffer->size;
+	stream_init.nb_blocks = buffer->buf->size / buffer->size;
+
+	/* Blocks too big for a single transfer are read one by one */
 	iio_adc->dmac->flags = 0;
-	ret = axi_dmac_transfer(iio_adc->dmac, (uintptr_t)buff, bytes);
-	if (ret < 0)
+
+	return axi_dmac_stream_start(iio_adc->dmac, &stream_init);
+}
+
+/**
+ * @brief Wait for the next block captured by the continuous capture.
+ * Blocks already sent to the client are given back to the DMA first.
+ * @param iio_adc - Instance of the iio_axi_adc
+ * @param buffer - Device buffer
+ * @param block - Next block of the buffer
+ * @return 0 in case of success or negative value otherwise.
+ */
+static int32_t iio_axi_adc_stream_read(struct iio_axi_adc_desc *iio_adc,
+				       struct iio_buffer *buffer, void *block)
+{
+	struct axi_dmac_stream *stream = iio_adc->dmac->stream;
+	uint32_t timeout = IIO_AXI_ADC_STREAM_TIMEOUT_US / 10;
+	uint32_t unread;
+	uint32_t address;
+	bool gap;
+	int32_t ret;
+
+	ret = no_os_cb_size(buffer->buf, &unread);
+	if (ret)
 		return ret;
 
-	if (iio_adc->dcache_invalidate_range)
-		iio_adc->dcache_invalidate_range((uintptr_t)buff, bytes);
+	/* Blocks still in the buffer, a partially sent one included */
+	unread = NO_OS_DIV_ROUND_UP(unread, buffer->size);
+	while (stream->acquired - stream->released > unread) {
+		ret = axi_dmac_stream_release_block(iio_adc->dmac);
+		if (ret)
+			return ret;
+	}
+
+	while (true) {
+		ret = axi_dmac_stream_get_block(iio_adc->dmac, &address, &gap);
+		if (ret != -EAGAIN)
+			break;
+		if (!timeout--)
+			return -ETIMEDOUT;
+		no_os_udelay(10);
+	}
+	if (ret)
+		return ret;
+
+	/* Both rings advance one block per request */
+	if (address != (uintptr_t)block)
+		return -EFAULT;
+
+	if (gap)
+		pr_warning("%s: samples lost before block %"PRIu32"\n",
+			   iio_adc->adc->name, stream->acquired - 1);
 
 	return 0;
 }
 
+/**
+ * @brief Capture the next block of the device buffer. With more than one
+ * block the capture runs continuously, so there are no gaps between blocks
+ * as long as the client keeps up.
+ * @param iio_dev_data - Device instance and buffer
+ * @return 0 in case of success or negative value otherwise.
+ */
+int32_t iio_axi_adc_submit(struct iio_device_data *iio_dev_data)
+{
+	struct iio_axi_adc_desc *iio_adc = iio_dev_data->dev;
+	struct iio_buffer *buffer = iio_dev_data->buffer;
+	void *block;
+	int32_t ret;
+
+	ret = iio_buffer_get_block(buffer, &block);
+	if (ret)
+		return ret;
+
+	if (!iio_adc->dmac->stream) {
+		ret = iio_axi_adc_stream_start(iio_adc, buffer, block);
+		if (ret)
+			return ret;
+	}
+
+	if (iio_adc->dmac->stream) {
+		ret = iio_axi_adc_stream_read(iio_adc, buffer, block);
+		if (ret) {
+			axi_dmac_stream_stop(iio_adc->dmac);
+			return ret;
+		}
+	} else {
+		iio_adc->dmac->flags = 0;
+		ret = axi_dmac_transfer(iio_adc->dmac, (uintptr_t)block,
+					buffer->size);
+		if (ret < 0)
+			return ret;
+	}
+
+	if (iio_adc->dcache_invalidate_range)
+		iio_adc->dcache_invalidate_range((uintptr_t)block,
+						 buffer->size);
+
+	return iio_buffer_block_done(buffer);
+}
+
 /**
  * @brief Delete iio_device.
  * @param iio_device - Structure describing a device, channels and attributes.
@@ -438,7 +553,8 @@ static int32_t iio_axi_adc_create_device_descriptor(
 	}
 
 	iio_device->pre_enable = iio_axi_adc_prepare_transfer;
-	iio_device->read_dev = iio_axi_adc_read_dev;
+	iio_device->post_disable = iio_axi_adc_post_disable;
+	iio_device->submit = iio_axi_adc_submit;
 
 	return 0;
 error:
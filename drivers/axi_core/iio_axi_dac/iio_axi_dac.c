@@ -489,29 +489,55 @@ int32_t iio_axi_dac_prepare_transfer(void *dev, uint32_t mask)
 }
 
 /**
- * @brief Update active channels
+ * @brief Stop the playback.
  * @param dev - Instance of the iio_axi_dac
- * @param buff - Buffer where to read samples
- * @param nb_samples - Number of samples
  * @return 0 in case of success or negative value otherwise.
  */
-int32_t iio_axi_dac_write_data(void *dev, void *buff, uint32_t nb_samples)
+int32_t iio_axi_dac_end_transfer(void *dev)
 {
-	struct iio_axi_dac_desc *iio_dac;
-	int bytes;
+	struct iio_axi_dac_desc *iio_dac = dev;
 
 	if (!dev)
-		return -1;
+		return -EINVAL;
+
+	/* A cyclic transfer runs until it is stopped */
+	return axi_dmac_transfer_stop(iio_dac->dmac);
+}
+
+/**
+ * @brief Send the pushed block to the DAC. A cyclic buffer is loaded once
+ * into a DMA_CYCLIC transfer, which keeps playing it until the buffer is
+ * closed.
+ * @param iio_dev_data - IIO device data
+ * @return 0 in case of success or negative value otherwise.
+ */
+int32_t iio_axi_dac_submit(struct iio_device_data *iio_dev_data)
+{
+	struct iio_axi_dac_desc *iio_dac;
+	struct iio_buffer *buffer;
+	void *buff;
+	int32_t ret;
+
+	if (!iio_dev_data || !iio_dev_data->dev)
+		return -EINVAL;
 
-	iio_dac = (struct iio_axi_dac_desc *)dev;
-	bytes = nb_samples * no_os_hweight8(iio_dac->mask) * (STORAGE_BITS / 8);
+	iio_dac = iio_dev_data->dev;
+	buffer = iio_dev_data->buffer;
+
+	ret = iio_buffer_get_block(buffer, &buff);
+	if (ret)
+		return ret;
 
 	if(iio_dac->dcache_flush_range)
-		iio_dac->dcache_flush_range((uintptr_t)buff, bytes);
+		iio_dac->dcache_flush_range((uintptr_t)buff, buffer->size);
 
-	iio_dac->dmac->flags = DMA_CYCLIC;
+	iio_dac->dmac->flags = buffer->cyclic ? DMA_CYCLIC : 0;
+
+	ret = axi_dmac_transfer(iio_dac->dmac, (uintptr_t)buff, buffer->size);
+	if (ret)
+		return ret;
 
-	return axi_dmac_transfer(iio_dac->dmac, (uintptr_t)buff, bytes);
+	return iio_buffer_block_done(buffer);
 }
 
 enum ch_type {
@@ -617,7 +643,8 @@ static int32_t iio_axi_dac_create_device_descriptor(
 			goto error;
 	}
 	iio_device->pre_enable = iio_axi_dac_prepare_transfer;
-	iio_device->write_dev = iio_axi_dac_write_data;
+	iio_device->post_disable = iio_axi_dac_end_transfer;
+	iio_device->submit = iio_axi_dac_submit;
 
 	return 0;
 
@@ -433,6 +433,7 @@ err:
  */
 int32_t adxcvr_remove(struct adxcvr *xcvr)
 {
+	no_os_axi_io_release(xcvr->base);
 	free(xcvr);
 
 	return 0;
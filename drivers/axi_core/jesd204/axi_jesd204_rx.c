@@ -592,6 +592,7 @@ err:
  */
 int32_t axi_jesd204_rx_remove(struct axi_jesd204_rx *jesd)
 {
+	no_os_axi_io_release(jesd->base);
 	free(jesd);
 
 	return 0;
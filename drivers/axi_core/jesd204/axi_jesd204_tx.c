@@ -440,6 +440,7 @@ err:
  */
 int32_t axi_jesd204_tx_remove(struct axi_jesd204_tx *jesd)
 {
+	no_os_axi_io_release(jesd->base);
 	free(jesd);
 
 	return 0;
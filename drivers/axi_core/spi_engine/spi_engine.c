@@ -49,6 +49,7 @@ significant delays */
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sleep.h>
 #include <inttypes.h>
 
@@ -226,120 +227,7 @@ static int32_t spi_get_sleep_div(struct no_os_spi_desc *desc,
 }
 
 /**
- * @brief Create a new commands queue used in a spi transfer
- *
- * @param fifo Command buffer, usualy used in fifo mode
- * @param cmd Command with wich the buffer will be initiated
- * @return int32_t Failure if the memory allocation failed
- */
-static int32_t spi_engine_queue_new_cmd(struct spi_engine_cmd_queue **fifo,
-					uint32_t cmd)
-{
-	struct spi_engine_cmd_queue *local_fifo;
-
-	local_fifo = (spi_engine_cmd_queue*)malloc(sizeof(*local_fifo));
-
-	if(!local_fifo)
-		return -1;
-
-	local_fifo->cmd = cmd;
-	local_fifo->next = NULL;
-	*fifo = local_fifo;
-
-	return 0;
-}
-
-/**
- * @brief Add a command at the end of an existing queue
- *
- * @param fifo Command buffer, usualy used in fifo mode
- * @param cmd Command to be added
- */
-static void spi_engine_queue_add_cmd(struct spi_engine_cmd_queue **fifo,
-				     uint32_t cmd)
-{
-	struct spi_engine_cmd_queue *to_add = NULL;
-	struct spi_engine_cmd_queue *local_fifo;
-
-	local_fifo = *fifo;
-	while (local_fifo->next != NULL) {
-		// Get the last element
-		local_fifo = local_fifo->next;
-	}
-
-	// Create a new element
-	spi_engine_queue_new_cmd(&to_add, cmd);
-	// Add as the next element
-	local_fifo->next = to_add;
-}
-
-/**
- * @brief Add a command at the beginning of an existing queue
- *
- * @param fifo Command buffer, usualy used in fifo mode
- * @param cmd Command to be added
- */
-static void spi_engine_queue_append_cmd(struct spi_engine_cmd_queue **fifo,
-					uint32_t cmd)
-{
-	struct spi_engine_cmd_queue *to_add = NULL;
-
-	// Create a new element
-	spi_engine_queue_new_cmd(&to_add, cmd);
-	// Interchange the addresses
-	to_add->next = *fifo;
-	*fifo = to_add;
-}
-
-
-/**
- * @brief Get the command from the beginning of the queue
- *
- * @param fifo Command buffer, usualy used in fifo mode
- * @param cmd Value of the command that was extracted
- * @return int32_t Return -1 if the queue is empty
- */
-static int32_t spi_engine_queue_get_cmd(struct spi_engine_cmd_queue **fifo,
-					uint32_t *cmd)
-{
-	struct spi_engine_cmd_queue *local_fifo;
-
-	if (!*fifo)
-		return -1;
-
-	local_fifo = *fifo;
-	*cmd = local_fifo->cmd;
-	if ((*fifo)->next) {
-		*fifo = local_fifo->next;
-		free(local_fifo);
-	} else {
-		free(*fifo);
-		*fifo = NULL;
-	}
-
-	return 0;
-}
-
-/**
- * @brief Free the memory allocated by a queue
- *
- * @param fifo The queue that needs it's memory freed
- * @return int32_t This function allways returns 0
- */
-static int32_t spi_engine_queue_free(struct spi_engine_cmd_queue **fifo)
-{
-	if(*fifo && (*fifo)->next)
-		spi_engine_queue_free(&(*fifo)->next);
-	if((*fifo) != NULL) {
-		free(*fifo);
-		*fifo = NULL;
-	}
-
-	return 0;
-}
-
-/**
- * @brief Write the SPI engine's command fifo
+ * @brief Write a command to the SPI engine's command fifo or offload memory
  *
  * @param desc Decriptor containing SPI Engine's parameters
  * @param cmd The command that will be written
@@ -366,99 +254,49 @@ static int32_t spi_engine_write_cmd_reg(struct spi_engine_desc *desc,
 }
 
 /**
- * @brief Write a transfer command to the SPI engine's command fifo
+ * @brief Add a command to a program, if there is room for it
  *
- * @param desc Decriptor containing SPI Engine's parameters
- * @param read_write Read/Write operation flag
- * @param bytes_number Number of bytes to transfer
- * @return int32_t This function allways returns 0
+ * @param prog The program being compiled
+ * @param cmd The engine command
+ * @return int32_t - 0 if the command was added
+ *		   - -ENOMEM if the program is full
  */
-static int32_t spi_engine_transfer(struct spi_engine_desc *desc,
-				   uint8_t read_write,
-				   uint8_t bytes_number)
+static int32_t spi_engine_program_add(struct spi_engine_program *prog,
+				      uint32_t cmd)
 {
-	uint8_t words_number;
-
-	words_number = spi_get_words_number(desc, bytes_number);
-
-	desc->offload_tx_len += words_number;
-
-	/*
-	 * Engine Wiki:
-	 *
-	 * https://wiki.analog.com/resources/fpga/peripherals/spi_engine
-	 *
-	 * The words number is zero based
-	 */
+	if (prog->no_cmds == prog->max_cmds)
+		return -ENOMEM;
 
-	spi_engine_write_cmd_reg(desc,
-				 SPI_ENGINE_CMD_TRANSFER(read_write,
-						 words_number  - 1));
+	prog->cmds[prog->no_cmds++] = cmd;
 
 	return 0;
 }
 
 /**
- * @brief Change the state of the chip select port
+ * @brief Translate a user command into the engine command
  *
- * @param desc Decriptor containing SPI interface parameters
- * @param assert Chip select state.
- * 		 The supported values are :
- * 			-true (HIGH)
- * 			-false (LOW)
- */
-static void spi_engine_set_cs(struct no_os_spi_desc *desc,
-			      bool assert)
-{
-	uint8_t			mask;
-	struct spi_engine_desc	*eng_desc;
-
-	eng_desc = desc->extra;
-
-	mask = 0xFF;
-	/* Switch the state only of the selected chip select */
-	if (!assert)
-		mask ^= NO_OS_BIT(desc->chip_select);
-
-	spi_engine_write_cmd_reg(eng_desc,
-				 SPI_ENGINE_CMD_ASSERT(eng_desc->cs_delay,
-						 mask));
-}
-
-/**
- * @brief Add a delay bewtheen the engine commands
+ * The transfer lengths are converted from bytes to engine words, the chip
+ * select commands are limited to the descriptor's chip select and the sleep
+ * time is converted to a clock prescaler.
  *
  * @param desc Decriptor containing SPI interface parameters
- * @param sleep_time_ns Number of nanoseconds to sleep between commands
+ * @param prog The program being compiled
+ * @param cmd Command to translate
+ * @return int32_t - 0 if the command was translated
+ *		   - -EINVAL if the command format is invalid
+ *		   - -ENOMEM if the program is full
  */
-static void spi_gen_sleep_ns(struct no_os_spi_desc *desc,
-			     uint32_t sleep_time_ns)
+static int32_t spi_engine_program_add_cmd(struct no_os_spi_desc *desc,
+		struct spi_engine_program *prog,
+		uint32_t cmd)
 {
-	uint32_t 		sleep_div;
-	struct spi_engine_desc	*eng_desc;
-
-	eng_desc = desc->extra;
-
-	spi_get_sleep_div(desc, sleep_time_ns, &sleep_div);
-
-	spi_engine_write_cmd_reg(eng_desc, SPI_ENGINE_CMD_SLEEP(sleep_div));
-}
-
-/**
- * @brief Spi engine command interpreter
- *
- * @param desc Decriptor containing SPI interface parameters
- * @param cmd Command to send to the engine
- * @return int32_t - 0 if the command is transfered
- *		   - -1 if the command format is invalid
- */
-static int32_t spi_engine_write_cmd(struct no_os_spi_desc *desc,
-				    uint32_t cmd)
-{
-	uint8_t				engine_command;
-	uint8_t				parameter;
-	uint8_t				modifier;
-	struct spi_engine_desc		*desc_extra;
+	struct spi_engine_desc	*desc_extra;
+	uint32_t		sleep_div;
+	uint8_t			engine_command;
+	uint8_t			parameter;
+	uint8_t			modifier;
+	uint8_t			words_number;
+	uint8_t			mask;
 
 	desc_extra = desc->extra;
 
@@ -468,144 +306,265 @@ static int32_t spi_engine_write_cmd(struct no_os_spi_desc *desc,
 
 	switch(engine_command) {
 	case SPI_ENGINE_INST_TRANSFER:
-		spi_engine_transfer(desc_extra, modifier, parameter);
-		break;
+		words_number = spi_get_words_number(desc_extra, parameter);
+		prog->no_words += words_number;
+		if (modifier & SPI_ENGINE_INSTRUCTION_TRANSFER_W)
+			prog->tx_words += words_number;
+		if (modifier & SPI_ENGINE_INSTRUCTION_TRANSFER_R)
+			prog->rx_words += words_number;
+
+		/*
+		 * Engine Wiki:
+		 *
+		 * https://wiki.analog.com/resources/fpga/peripherals/spi_engine
+		 *
+		 * The words number is zero based
+		 */
+		return spi_engine_program_add(prog,
+					      SPI_ENGINE_CMD_TRANSFER(modifier,
+							      words_number - 1));
 
 	case SPI_ENGINE_INST_ASSERT:
-		if(parameter == 0xFF) {
-			/* Set the CS HIGH */
-			spi_engine_set_cs(desc, true);
-		} else if(parameter == 0x00) {
-			/* Set the CS LOW */
-			spi_engine_set_cs(desc, false);
-		}
-		break;
+		/* Switch the state only of the selected chip select */
+		mask = 0xFF;
+		if(parameter == 0x00)
+			mask ^= NO_OS_BIT(desc->chip_select);
+		else if(parameter != 0xFF)
+			return 0;
+
+		return spi_engine_program_add(prog,
+					      SPI_ENGINE_CMD_ASSERT(desc_extra->cs_delay,
+							      mask));
 
 	/* The SYNC and SLEEP commands got the same value but different
 	modifier */
 	case SPI_ENGINE_INST_SYNC_SLEEP:
-		/* SYNC instruction */
-		if(modifier == 0x00) {
-			spi_engine_write_cmd_reg(desc_extra, cmd);
-		} else if(modifier == 0x01) {
-			spi_gen_sleep_ns(desc, parameter);
+		if(modifier == SPI_ENGINE_MISC_SYNC)
+			return spi_engine_program_add(prog, cmd);
+
+		if(modifier == SPI_ENGINE_MISC_SLEEP) {
+			spi_get_sleep_div(desc, parameter, &sleep_div);
+			return spi_engine_program_add(prog,
+						      SPI_ENGINE_CMD_SLEEP(sleep_div));
 		}
-		break;
-	case SPI_ENGINE_INST_CONFIG:
-		spi_engine_write_cmd_reg(desc_extra, cmd);
 
-		break;
+		return 0;
 
-	default:
+	case SPI_ENGINE_INST_CONFIG:
+		return spi_engine_program_add(prog, cmd);
 
-		return -1;
+	default:
+		return -EINVAL;
 	}
-
-	return 0;
 }
 
 /**
- * @brief Prepare the command queue before sending it to the engine
+ * @brief Compile a list of commands into a program
+ *
+ * The program is framed by the descriptor's clock divider, word length and SPI
+ * mode configuration and ends with a sync command. The caller provides the
+ * command storage in prog->cmds and its size in prog->max_cmds, which has to
+ * be at least no_commands + SPI_ENGINE_PROGRAM_EXTRA_CMDS.
  *
  * @param desc Decriptor containing SPI interface parameters
- * @param msg Structure used to store the transfer messages
- * @return int32_t This function allways returns 0
+ * @param prog The program to compile
+ * @param commands The commands to compile
+ * @param no_commands Number of commands
+ * @return int32_t - 0 if the program was compiled
+ *		   - negative error code otherwise
  */
-static int32_t spi_engine_compile_message(struct no_os_spi_desc *desc,
-		struct spi_engine_msg *msg)
+int32_t spi_engine_program_compile(struct no_os_spi_desc *desc,
+				   struct spi_engine_program *prog,
+				   const uint32_t *commands,
+				   uint32_t no_commands)
 {
 	struct spi_engine_desc	*desc_extra;
+	int32_t			ret;
+	uint32_t		i;
+
+	if (!desc || !prog || !prog->cmds || (no_commands && !commands))
+		return -EINVAL;
 
 	desc_extra = desc->extra;
 
+	prog->desc = desc;
+	prog->no_cmds = 0;
+	prog->no_words = 0;
+	prog->tx_words = 0;
+	prog->rx_words = 0;
+
 	/* Configure the prescaler */
-	spi_engine_queue_append_cmd(&msg->cmds,
-				    SPI_ENGINE_CMD_CONFIG(
-					    SPI_ENGINE_CMD_REG_CLK_DIV,
-					    desc_extra->clk_div));
+	ret = spi_engine_program_add(prog,
+				     SPI_ENGINE_CMD_CONFIG(SPI_ENGINE_CMD_REG_CLK_DIV,
+						     desc_extra->clk_div));
+	if (ret)
+		return ret;
 
 	/* Set the data transfer length */
-	spi_engine_queue_append_cmd(&msg->cmds,
-				    SPI_ENGINE_CMD_CONFIG(
-					    SPI_ENGINE_CMD_DATA_TRANSFER_LEN,
-					    desc_extra->data_width));
+	ret = spi_engine_program_add(prog,
+				     SPI_ENGINE_CMD_CONFIG(SPI_ENGINE_CMD_DATA_TRANSFER_LEN,
+						     desc_extra->data_width));
+	if (ret)
+		return ret;
+
 	/*
 	 * Configure the spi mode :
 	 *	- 3 wire
 	 *	- CPOL
 	 *	- CPHA
 	 */
-	spi_engine_queue_append_cmd(&msg->cmds,
-				    SPI_ENGINE_CMD_CONFIG(
-					    SPI_ENGINE_CMD_REG_CONFIG,
-					    desc->mode));
+	ret = spi_engine_program_add(prog,
+				     SPI_ENGINE_CMD_CONFIG(SPI_ENGINE_CMD_REG_CONFIG,
+						     desc->mode));
+	if (ret)
+		return ret;
+
+	for (i = 0; i < no_commands; i++) {
+		ret = spi_engine_program_add_cmd(desc, prog, commands[i]);
+		if (ret)
+			return ret;
+	}
 
-	/* Add a sync command to signal that the transfer has finished */
-	spi_engine_queue_add_cmd(&msg->cmds, SPI_ENGINE_CMD_SYNC(_sync_id));
+	/* Add a sync command to signal that the transfer has finished. The
+	 * id is updated every time the program is run. */
+	prog->sync_idx = prog->no_cmds;
+
+	return spi_engine_program_add(prog, SPI_ENGINE_CMD_SYNC(_sync_id));
+}
+
+/**
+ * @brief Allocate and compile a program
+ *
+ * @param desc Decriptor containing SPI interface parameters
+ * @param prog Where the allocated program is returned
+ * @param commands The commands to compile
+ * @param no_commands Number of commands
+ * @return int32_t - 0 if the program was created
+ *		   - negative error code otherwise
+ */
+int32_t spi_engine_program_init(struct no_os_spi_desc *desc,
+				struct spi_engine_program **prog,
+				const uint32_t *commands,
+				uint32_t no_commands)
+{
+	struct spi_engine_program	*p;
+	int32_t				ret;
+
+	if (!prog)
+		return -EINVAL;
+
+	p = calloc(1, sizeof(*p));
+	if (!p)
+		return -ENOMEM;
+
+	p->max_cmds = no_commands + SPI_ENGINE_PROGRAM_EXTRA_CMDS;
+	p->cmds = calloc(p->max_cmds, sizeof(*p->cmds));
+	if (!p->cmds) {
+		free(p);
+		return -ENOMEM;
+	}
+
+	ret = spi_engine_program_compile(desc, p, commands, no_commands);
+	if (ret) {
+		spi_engine_program_remove(p);
+		return ret;
+	}
+
+	*prog = p;
+
+	return 0;
+}
+
+/**
+ * @brief Free a program created by spi_engine_program_init()
+ *
+ * @param prog The program
+ * @return int32_t This function allways returns 0
+ */
+int32_t spi_engine_program_remove(struct spi_engine_program *prog)
+{
+	if (!prog)
+		return 0;
+
+	free(prog->cmds);
+	free(prog);
 
 	return 0;
 }
 
 /**
- * @brief Initiate a spi transfer
+ * @brief Write the program commands to the command fifo or offload memory
+ *
+ * @param desc Decriptor containing SPI Engine's parameters
+ * @param prog The program
+ */
+static void spi_engine_program_write(struct spi_engine_desc *desc,
+				     struct spi_engine_program *prog)
+{
+	uint32_t i;
+
+	for (i = 0; i < prog->no_cmds; i++)
+		spi_engine_write_cmd_reg(desc, prog->cmds[i]);
+}
+
+/**
+ * @brief Run a compiled program in FIFO mode
  *
  * @param desc Decriptor containing SPI interface parameters
- * @param msg Structure used to store the transfer messages
+ * @param prog The program, compiled for this descriptor
+ * @param tx_buf prog->tx_words words to send, may be NULL to send zeros
+ * @param rx_buf Where prog->rx_words received words are stored, may be NULL
  * @return int32_t - 0 if the transfer finished
- *		   - -1 if the memory allocation failed
+ *		   - -EINVAL if the program was compiled for another descriptor
  */
-static int32_t spi_engine_transfer_message(struct no_os_spi_desc *desc,
-		struct spi_engine_msg *msg)
+int32_t spi_engine_program_run(struct no_os_spi_desc *desc,
+			       struct spi_engine_program *prog,
+			       const uint32_t *tx_buf,
+			       uint32_t *rx_buf)
 {
-	uint32_t		i;
-	uint32_t		data;
-	uint32_t		sync_id;
-	bool 			offload_en;
 	struct spi_engine_desc	*desc_extra;
+	uint32_t		sync_id;
+	uint32_t		data;
+	uint32_t		i;
 
-	desc_extra = desc->extra;
+	if (!desc || !prog || prog->desc != desc)
+		return -EINVAL;
 
-	spi_engine_compile_message(desc, msg);
+	desc_extra = desc->extra;
 
-	offload_en = (desc_extra->offload_config & OFFLOAD_TX_EN) |
-		     (desc_extra->offload_config & OFFLOAD_RX_EN);
+	/* The offload module owns the engine during a continuous capture */
+	if (desc_extra->offload_prog)
+		return -EBUSY;
 
-	/* Write the command fifo buffer */
-	while(msg->cmds != NULL) {
-		spi_engine_queue_get_cmd(&msg->cmds, &data);
-		spi_engine_write_cmd(desc, data);
+	/* If we want to access SPI interface and SPI engine offload module was
+	 * activated, we need to disable it
+	 * This is set in spi_engine_offload_init() */
+	if (desc_extra->offload_config) {
+		desc_extra->offload_config = OFFLOAD_DISABLED;
+		/* This is set in spi_engine_offload_transfer() */
+		spi_engine_write(desc_extra, SPI_ENGINE_REG_OFFLOAD_CTRL(0), 0);
 	}
 
-	/* Write a number of tx_length WORDS on the SDO line */
+	prog->cmds[prog->sync_idx] = SPI_ENGINE_CMD_SYNC(_sync_id);
+	spi_engine_program_write(desc_extra, prog);
 
-	if(offload_en) {
-		for(i = 0; i < desc_extra->offload_tx_len; i++)
-			spi_engine_write(desc_extra,
-					 SPI_ENGINE_REG_OFFLOAD_SDO_MEM(0),
-					 msg->tx_buf[i]);
+	/* Write a number of tx_words WORDS on the SDO line */
+	for (i = 0; i < prog->tx_words; i++)
+		spi_engine_write(desc_extra, SPI_ENGINE_REG_SDO_DATA_FIFO,
+				 tx_buf ? tx_buf[i] : 0);
 
-	} else {
-		for(i = 0; i < msg->length; i++)
-			spi_engine_write(desc_extra,
-					 SPI_ENGINE_REG_SDO_DATA_FIFO,
-					 msg->tx_buf[i]);
-		do {
-			spi_engine_read(desc_extra,
-					SPI_ENGINE_REG_SYNC_ID,
-					&sync_id);
-		}
-		/* Wait for the end sync signal */
-		while(sync_id != _sync_id);
-		_sync_id++;
-
-		/* Read a number of rx_length WORDS from the SDI line and store
-		them */
-		for(i = 0; i < msg->length; i++) {
-			spi_engine_read(desc_extra,
-					SPI_ENGINE_REG_SDI_DATA_FIFO,
-					&data);
-			msg->rx_buf[i] = data;
-		}
+	do {
+		spi_engine_read(desc_extra, SPI_ENGINE_REG_SYNC_ID, &sync_id);
+	}
+	/* Wait for the end sync signal */
+	while(sync_id != _sync_id);
+	_sync_id++;
+
+	/* Read a number of rx_words WORDS from the SDI line and store them */
+	for (i = 0; i < prog->rx_words; i++) {
+		spi_engine_read(desc_extra, SPI_ENGINE_REG_SDI_DATA_FIFO, &data);
+		if (rx_buf)
+			rx_buf[i] = data;
 	}
 
 	return 0;
@@ -650,6 +609,9 @@ int32_t spi_engine_init(struct no_os_spi_desc **desc,
 	(*desc)->extra = eng_desc;
 
 	eng_desc->offload_config = OFFLOAD_DISABLED;
+	eng_desc->offload_prog = NULL;
+	eng_desc->offload_tx_dma = NULL;
+	eng_desc->offload_rx_dma = NULL;
 	eng_desc->spi_engine_baseaddr = spi_engine_init->spi_engine_baseaddr;
 	eng_desc->type = spi_engine_init->type;
 	eng_desc->cs_delay = spi_engine_init->cs_delay;
@@ -692,57 +654,62 @@ int32_t spi_engine_write_and_read(struct no_os_spi_desc *desc,
 				  uint8_t *data,
 				  uint16_t bytes_number)
 {
-	uint8_t 		i;
+	uint32_t		stack_buf[SPI_ENGINE_STACK_WORDS];
+	uint32_t		cmds[4 + SPI_ENGINE_PROGRAM_EXTRA_CMDS];
+	uint32_t		user_cmds[4];
+	uint32_t		*buf = stack_buf;
+	uint32_t		i;
 	uint8_t 		word_len;
-	uint8_t 		words_number;
+	uint32_t 		words_number;
 	int32_t 		ret;
-	struct spi_engine_msg	msg;
+	struct spi_engine_program	prog;
 	struct spi_engine_desc	*desc_extra;
 
 	desc_extra = desc->extra;
 
-	/* If we want to access SPI interface and SPI engine offload module was
-	 * activated, we need to disable it
-	 * This is set in spi_engine_offload_init() */
-	desc_extra->offload_config = OFFLOAD_DISABLED;
-	/* This is set in spi_engine_offload_transfer() */
-	spi_engine_write(desc_extra, SPI_ENGINE_REG_OFFLOAD_CTRL(0), 0);
+	/* The transfer command length is limited to 8 bits */
+	if (!bytes_number || bytes_number > 0xFF)
+		return -EINVAL;
 
 	words_number = spi_get_words_number(desc_extra, bytes_number);
+	if (words_number > SPI_ENGINE_STACK_WORDS) {
+		buf = calloc(words_number, sizeof(*buf));
+		if (!buf)
+			return -ENOMEM;
+	} else {
+		memset(buf, 0, words_number * sizeof(*buf));
+	}
 
-	msg.cmds = (spi_engine_cmd_queue*)malloc(sizeof(*msg.cmds));
-	if (!msg.cmds)
-		return -1;
-
-	msg.tx_buf =(uint32_t*)calloc(words_number, sizeof(msg.tx_buf[0]));
-	msg.rx_buf =(uint32_t*)calloc(words_number, sizeof(msg.rx_buf[0]));
-	msg.length = words_number;
+	/* Make sure the CS is HIGH before starting a transaction */
+	user_cmds[0] = CS_HIGH;
+	user_cmds[1] = CS_LOW;
+	user_cmds[2] = WRITE_READ(bytes_number);
+	user_cmds[3] = CS_HIGH;
+
+	prog.cmds = cmds;
+	prog.max_cmds = NO_OS_ARRAY_SIZE(cmds);
+	ret = spi_engine_program_compile(desc, &prog, user_cmds,
+					 NO_OS_ARRAY_SIZE(user_cmds));
+	if (ret)
+		goto out;
 
 	/* Get the length of transfered word */
 	word_len = spi_get_word_lenght(desc_extra);
 
-	/* Make sure the CS is HIGH before starting a transaction */
-	msg.cmds->next = NULL;
-	msg.cmds->cmd = CS_HIGH;
-	spi_engine_queue_add_cmd(&msg.cmds, CS_LOW);
-	spi_engine_queue_add_cmd(&msg.cmds, WRITE_READ(bytes_number));
-	spi_engine_queue_add_cmd(&msg.cmds, CS_HIGH);
-
 	/* Pack the bytes into engine WORDS */
 	for (i = 0; i < bytes_number; i++)
-		msg.tx_buf[i / word_len] |= data[i] << (desc_extra->data_width-
-							(i % word_len + 1) * 8);
+		buf[i / word_len] |= data[i] << (desc_extra->data_width -
+						 (i % word_len + 1) * 8);
 
-	ret = spi_engine_transfer_message(desc, &msg);
+	ret = spi_engine_program_run(desc, &prog, buf, buf);
 
 	for (i = 0; i < bytes_number; i++)
-		data[i] = msg.rx_buf[(i) / word_len] >>
-			  (desc_extra->data_width -
-			   ((i) % word_len + 1) * 8);
+		data[i] = buf[i / word_len] >>
+			  (desc_extra->data_width - (i % word_len + 1) * 8);
 
-	spi_engine_queue_free(&msg.cmds);
-	free(msg.tx_buf);
-	free(msg.rx_buf);
+out:
+	if (buf != stack_buf)
+		free(buf);
 
 	return ret;
 }
@@ -763,6 +730,9 @@ int32_t spi_engine_offload_init(struct no_os_spi_desc *desc,
 
 	eng_desc = desc->extra;
 
+	if (eng_desc->offload_prog)
+		return -EBUSY;
+
 	eng_desc->offload_config = param->offload_config;
 
 	if(!(param->dma_flags))
@@ -770,7 +740,10 @@ int32_t spi_engine_offload_init(struct no_os_spi_desc *desc,
 	else
 		dma_flags = *(param->dma_flags);
 
-	if(param->offload_config & OFFLOAD_TX_EN) {
+	/* Reuse the DMACs of a previous initialization */
+	if(param->offload_config & OFFLOAD_TX_EN && eng_desc->offload_tx_dma) {
+		eng_desc->offload_tx_dma->flags = dma_flags;
+	} else if(param->offload_config & OFFLOAD_TX_EN) {
 		dmac_init.name = "DAC DMAC";
 		dmac_init.base = param->tx_dma_baseaddr;
 		dmac_init.direction = DMA_MEM_TO_DEV;
@@ -779,7 +752,9 @@ int32_t spi_engine_offload_init(struct no_os_spi_desc *desc,
 		if(!eng_desc->offload_tx_dma)
 			return -1;
 	}
-	if(param->offload_config & OFFLOAD_RX_EN) {
+	if(param->offload_config & OFFLOAD_RX_EN && eng_desc->offload_rx_dma) {
+		eng_desc->offload_rx_dma->flags = dma_flags;
+	} else if(param->offload_config & OFFLOAD_RX_EN) {
 		dmac_init.name = "ADC DMAC";
 		dmac_init.base = param->rx_dma_baseaddr;
 		dmac_init.direction = DMA_DEV_TO_MEM;
@@ -793,76 +768,320 @@ int32_t spi_engine_offload_init(struct no_os_spi_desc *desc,
 }
 
 /**
- * @brief Initiate a SPI transfer in offload mode
+ * @brief Load a compiled program in the offload module
+ *
+ * The program and its SDO data stay in the offload memories, so the offload
+ * can be started again with spi_engine_offload_start() without reloading.
  *
  * @param desc Decriptor containing SPI interface parameters
- * @param msg Offload message that get's to be transferred
- * @param no_samples Number of time the messages will be transferred
- * @return int32_t This function allways returns 0
+ * @param prog The program, compiled for this descriptor
+ * @param sdo_data prog->tx_words words sent on each trigger, may be NULL
+ * @return int32_t - 0 if the program was loaded
+ *		   - -EINVAL if offload is disabled or the program is invalid
  */
-int32_t spi_engine_offload_transfer(struct no_os_spi_desc *desc,
-				    struct spi_engine_offload_message msg,
-				    uint32_t no_samples)
+int32_t spi_engine_offload_load(struct no_os_spi_desc *desc,
+				struct spi_engine_program *prog,
+				const uint32_t *sdo_data)
 {
-	struct spi_engine_msg	transfer;
 	struct spi_engine_desc	*eng_desc;
-	uint32_t 		i;
-	uint8_t 		word_length;
+	uint32_t		i;
+
+	if (!desc || !prog || prog->desc != desc)
+		return -EINVAL;
 
 	eng_desc = desc->extra;
 
 	/* Check if offload is disabled */
-	if(!((eng_desc->offload_config & OFFLOAD_TX_EN) |
-	     (eng_desc->offload_config & OFFLOAD_RX_EN)))
-		return -1;
+	if(!(eng_desc->offload_config & (OFFLOAD_TX_EN | OFFLOAD_RX_EN)))
+		return -EINVAL;
 
+	spi_engine_write(eng_desc, SPI_ENGINE_REG_OFFLOAD_CTRL(0), 0);
 	spi_engine_write(eng_desc, SPI_ENGINE_REG_OFFLOAD_RESET(0), 1);
 	spi_engine_write(eng_desc, SPI_ENGINE_REG_OFFLOAD_RESET(0), 0);
 
-	eng_desc->offload_tx_len = 0;
-	eng_desc->offload_rx_len = 0;
+	spi_engine_program_write(eng_desc, prog);
 
-	transfer.cmds = (spi_engine_cmd_queue*)malloc(sizeof(*transfer.cmds));
+	if (sdo_data)
+		for(i = 0; i < prog->tx_words; i++)
+			spi_engine_write(eng_desc,
+					 SPI_ENGINE_REG_OFFLOAD_SDO_MEM(0),
+					 sdo_data[i]);
 
-	if (!transfer.cmds)
-		return -1;
+	eng_desc->offload_tx_len = prog->no_words;
+	eng_desc->offload_rx_len = prog->rx_words;
 
-	transfer.tx_buf = msg.commands_data;
+	return 0;
+}
 
-	/* Load the commands into the message */
-	transfer.cmds->next = NULL;
-	transfer.cmds->cmd = msg.commands[0];
-	i = 1;
-	while(i < msg.no_commands) {
-		spi_engine_queue_add_cmd(&transfer.cmds, msg.commands[i++]);
+/**
+ * @brief Start the offload module with the loaded program
+ *
+ * The DMA transfers are blocking, unless the DMAC works in cyclic mode.
+ *
+ * @param desc Decriptor containing SPI interface parameters
+ * @param tx_addr The address of the data sent by the TX DMAC
+ * @param rx_addr The address where the RX DMAC stores the data
+ * @param no_samples Number of times the program is run
+ * @return int32_t - 0 if the transfers were started
+ *		   - negative error code otherwise
+ */
+int32_t spi_engine_offload_start(struct no_os_spi_desc *desc,
+				 uint32_t tx_addr,
+				 uint32_t rx_addr,
+				 uint32_t no_samples)
+{
+	struct spi_engine_desc	*eng_desc;
+	uint32_t		size;
+	int32_t			ret;
 
-	}
+	if (!desc)
+		return -EINVAL;
 
-	spi_engine_transfer_message(desc, &transfer);
+	eng_desc = desc->extra;
+
+	if(!(eng_desc->offload_config & (OFFLOAD_TX_EN | OFFLOAD_RX_EN)))
+		return -EINVAL;
 
 	/* Start transfer */
 	spi_engine_write(eng_desc, SPI_ENGINE_REG_OFFLOAD_CTRL(0), 0x0001);
 
-	word_length = spi_get_word_lenght(eng_desc);
+	size = spi_get_word_lenght(eng_desc) * eng_desc->offload_tx_len *
+	       no_samples;
+
 	if(eng_desc->offload_config & OFFLOAD_TX_EN) {
-		axi_dmac_transfer(eng_desc->offload_tx_dma,
-				  msg.tx_addr,
-				  word_length * eng_desc->offload_tx_len *
-				  no_samples);
+		ret = axi_dmac_transfer(eng_desc->offload_tx_dma, tx_addr, size);
+		if (ret)
+			return ret;
 	}
 
 	if(eng_desc->offload_config & OFFLOAD_RX_EN) {
-		axi_dmac_transfer(eng_desc->offload_rx_dma,
-				  msg.rx_addr,
-				  word_length * eng_desc->offload_tx_len *
-				  no_samples);
+		ret = axi_dmac_transfer(eng_desc->offload_rx_dma, rx_addr, size);
+		if (ret)
+			return ret;
 	}
 
+	return 0;
+}
+
+/**
+ * @brief Initiate a SPI transfer in offload mode
+ *
+ * The message is compiled on every call. Use spi_engine_program_init(),
+ * spi_engine_offload_load() and spi_engine_offload_start() to avoid that.
+ *
+ * @param desc Decriptor containing SPI interface parameters
+ * @param msg Offload message that get's to be transferred
+ * @param no_samples Number of time the messages will be transferred
+ * @return int32_t - 0 if the transfer was started
+ *		   - negative error code otherwise
+ */
+int32_t spi_engine_offload_transfer(struct no_os_spi_desc *desc,
+				    struct spi_engine_offload_message msg,
+				    uint32_t no_samples)
+{
+	struct spi_engine_program	*prog;
+	int32_t				ret;
+
+	ret = spi_engine_program_init(desc, &prog, msg.commands,
+				      msg.no_commands);
+	if (ret)
+		return ret;
+
+	ret = spi_engine_offload_load(desc, prog, msg.commands_data);
+	if (ret)
+		goto out;
+
+	ret = spi_engine_offload_start(desc, msg.tx_addr, msg.rx_addr,
+				       no_samples);
+	if (ret)
+		goto out;
+
+	/* Callers of this function expect the data to be available on return,
+	 * even when the DMAC works in cyclic mode */
 	usleep(1000);
 
-	spi_engine_queue_free(&transfer.cmds);
+out:
+	spi_engine_program_remove(prog);
+
+	return ret;
+}
+
+/**
+ * @brief Start a continuous offload capture
+ *
+ * The program is loaded in the offload module, which then runs it on every
+ * trigger (e.g. the PWM driving the conversions) until the capture is
+ * stopped. The RX DMAC cycles through a ring of blocks: a captured block is
+ * overwritten only after it is given back with
+ * spi_engine_offload_stream_release_block(), when the ring is full the
+ * samples are dropped and counted as an overflow.
+ *
+ * @param desc Decriptor containing SPI interface parameters
+ * @param init Capture parameters
+ * @return int32_t - 0 if the capture was started
+ *		   - negative error code otherwise
+ */
+int32_t spi_engine_offload_stream_start(struct no_os_spi_desc *desc,
+					const struct spi_engine_offload_stream_init *init)
+{
+	struct axi_dmac_stream_init	stream_init;
+	struct spi_engine_desc		*eng_desc;
+	uint32_t			trigger_size;
+	int32_t				ret;
+
+	if (!desc || !init)
+		return -EINVAL;
+
+	eng_desc = desc->extra;
+
+	if (!(eng_desc->offload_config & OFFLOAD_RX_EN) ||
+	    !eng_desc->offload_rx_dma || eng_desc->offload_prog)
+		return -EINVAL;
+
+	ret = spi_engine_program_init(desc, &eng_desc->offload_prog,
+				      init->commands, init->no_commands);
+	if (ret)
+		return ret;
+
+	/* Every block has to hold a whole number of triggers */
+	trigger_size = spi_get_word_lenght(eng_desc) *
+		       eng_desc->offload_prog->no_words;
+	if (!trigger_size || init->block_size % trigger_size) {
+		ret = -EINVAL;
+		goto error;
+	}
+
+	ret = spi_engine_offload_load(desc, eng_desc->offload_prog,
+				      init->commands_data);
+	if (ret)
+		goto error;
+
+	stream_init.address = init->rx_addr;
+	stream_init.block_size = init->block_size;
+	stream_init.nb_blocks = init->nb_blocks;
+	stream_init.block_done = init->block_done;
+	stream_init.ctx = init->ctx;
+	ret = axi_dmac_stream_start(eng_desc->offload_rx_dma, &stream_init);
+	if (ret)
+		goto error;
+
+	/* The DMAC is ready, let the triggers in */
+	spi_engine_write(eng_desc, SPI_ENGINE_REG_OFFLOAD_CTRL(0),
+			 SPI_ENGINE_OFFLOAD_CTRL_ENABLE);
 
 	return 0;
+
+error:
+	spi_engine_program_remove(eng_desc->offload_prog);
+	eng_desc->offload_prog = NULL;
+
+	return ret;
+}
+
+/**
+ * @brief Get the oldest captured block
+ *
+ * @param desc Decriptor containing SPI interface parameters
+ * @param address Where the block address is returned
+ * @return int32_t - 0 if a block is available
+ *		   - -EAGAIN if no block was captured yet
+ *		   - -EINVAL if the capture is not running
+ */
+int32_t spi_engine_offload_stream_get_block(struct no_os_spi_desc *desc,
+		uint32_t *address)
+{
+	struct spi_engine_desc	*eng_desc;
+
+	if (!desc)
+		return -EINVAL;
+
+	eng_desc = desc->extra;
+	if (!eng_desc->offload_prog)
+		return -EINVAL;
+
+	return axi_dmac_stream_get_block(eng_desc->offload_rx_dma, address,
+					 NULL);
+}
+
+/**
+ * @brief Give the oldest captured block back to the RX DMAC
+ *
+ * @param desc Decriptor containing SPI interface parameters
+ * @return int32_t - 0 in case of success, negative error code otherwise
+ */
+int32_t spi_engine_offload_stream_release_block(struct no_os_spi_desc *desc)
+{
+	struct spi_engine_desc	*eng_desc;
+
+	if (!desc)
+		return -EINVAL;
+
+	eng_desc = desc->extra;
+	if (!eng_desc->offload_prog)
+		return -EINVAL;
+
+	return axi_dmac_stream_release_block(eng_desc->offload_rx_dma);
+}
+
+/**
+ * @brief Get the statistics of the running capture
+ *
+ * @param desc Decriptor containing SPI interface parameters
+ * @param stats Where the statistics are returned
+ * @return int32_t - 0 in case of success, negative error code otherwise
+ */
+int32_t spi_engine_offload_stream_get_stats(struct no_os_spi_desc *desc,
+		struct spi_engine_offload_stats *stats)
+{
+	struct spi_engine_desc	*eng_desc;
+	struct axi_dmac_stream	*stream;
+
+	if (!desc || !stats)
+		return -EINVAL;
+
+	eng_desc = desc->extra;
+	if (!eng_desc->offload_prog || !eng_desc->offload_rx_dma->stream)
+		return -EINVAL;
+
+	stream = eng_desc->offload_rx_dma->stream;
+	stats->blocks = stream->completed;
+	stats->overflows = stream->overflows;
+
+	return 0;
+}
+
+/**
+ * @brief Stop the continuous offload capture
+ *
+ * @param desc Decriptor containing SPI interface parameters
+ * @param stats Optional. Where the final statistics are returned
+ * @return int32_t - 0 in case of success, negative error code otherwise
+ */
+int32_t spi_engine_offload_stream_stop(struct no_os_spi_desc *desc,
+				       struct spi_engine_offload_stats *stats)
+{
+	struct spi_engine_desc	*eng_desc;
+	int32_t			ret;
+
+	if (!desc)
+		return -EINVAL;
+
+	eng_desc = desc->extra;
+	if (!eng_desc->offload_prog)
+		return -EINVAL;
+
+	/* Stop the triggers first, so the DMAC is not left with data */
+	spi_engine_write(eng_desc, SPI_ENGINE_REG_OFFLOAD_CTRL(0), 0);
+
+	if (stats)
+		spi_engine_offload_stream_get_stats(desc, stats);
+
+	ret = axi_dmac_stream_stop(eng_desc->offload_rx_dma);
+
+	spi_engine_program_remove(eng_desc->offload_prog);
+	eng_desc->offload_prog = NULL;
+
+	return ret;
 }
 
 /**
@@ -877,10 +1096,14 @@ int32_t spi_engine_remove(struct no_os_spi_desc *desc)
 
 	eng_desc = desc->extra;
 
-	if(eng_desc->offload_config & OFFLOAD_TX_EN)
+	if(eng_desc->offload_prog)
+		spi_engine_offload_stream_stop(desc, NULL);
+
+	if(eng_desc->offload_tx_dma)
 		axi_dmac_remove(eng_desc->offload_tx_dma);
-	if(eng_desc->offload_config & OFFLOAD_RX_EN)
+	if(eng_desc->offload_rx_dma)
 		axi_dmac_remove(eng_desc->offload_rx_dma);
+	no_os_axi_io_release(eng_desc->spi_engine_baseaddr);
 	free(desc->extra);
 	free(desc);
 
@@ -60,6 +60,12 @@
 
 #define SPI_ENGINE_MSG_QUEUE_END	0xFFFFFFFF
 
+/* Commands added by the compiler: 3 configuration commands and the sync */
+#define SPI_ENGINE_PROGRAM_EXTRA_CMDS	4
+
+/* Transfers up to this number of words don't allocate memory */
+#define SPI_ENGINE_STACK_WORDS		8
+
 /* Spi engine commands */
 #define	WRITE(no_bytes)			((SPI_ENGINE_INST_TRANSFER << 12) |\
 	(SPI_ENGINE_INSTRUCTION_TRANSFER_W << 8) | no_bytes)
@@ -132,6 +138,8 @@ struct spi_engine_desc {
 	uint8_t			data_width;
 	/** The maximum data width supported by the engine */
 	uint8_t 		max_data_width;
+	/** Program loaded in the offload module by the continuous mode */
+	struct spi_engine_program	*offload_prog;
 };
 
 
@@ -170,6 +178,66 @@ struct spi_engine_offload_message {
 	uint32_t rx_addr;
 };
 
+/**
+ * @struct spi_engine_program
+ * @brief  Compiled SPI engine commands, ready to be written to the command
+ * FIFO or to the offload memory. A program is bound to the descriptor it was
+ * compiled for and has to be compiled again if its speed or word length
+ * change.
+ */
+struct spi_engine_program {
+	/** Descriptor the program was compiled for */
+	struct no_os_spi_desc	*desc;
+	/** Engine commands */
+	uint32_t		*cmds;
+	/** Number of compiled commands */
+	uint32_t		no_cmds;
+	/** Size of the cmds buffer */
+	uint32_t		max_cmds;
+	/** Number of words transferred by one run */
+	uint32_t		no_words;
+	/** Number of words written to the SDO FIFO by one run */
+	uint32_t		tx_words;
+	/** Number of words read from the SDI FIFO by one run */
+	uint32_t		rx_words;
+	/** Index of the sync command */
+	uint32_t		sync_idx;
+};
+
+/**
+ * @struct spi_engine_offload_stream_init
+ * @brief  Structure containing the parameters of a continuous offload capture
+ */
+struct spi_engine_offload_stream_init {
+	/** Commands run by the offload module on each trigger */
+	uint32_t	*commands;
+	/** Number of commands */
+	uint32_t	no_commands;
+	/** Data sent on each trigger, may be NULL */
+	uint32_t	*commands_data;
+	/** Address of nb_blocks * block_size bytes where the RX DMAC writes */
+	uint32_t	rx_addr;
+	/** Size of a block in bytes, multiple of the bytes read per trigger */
+	uint32_t	block_size;
+	/** Number of blocks in the ring. Minimum 2 */
+	uint32_t	nb_blocks;
+	/** Optional. Called for each completed block */
+	void		(*block_done)(void *ctx, uint32_t address, uint32_t size);
+	/** Parameter passed to block_done */
+	void		*ctx;
+};
+
+/**
+ * @struct spi_engine_offload_stats
+ * @brief  Statistics of a continuous offload capture
+ */
+struct spi_engine_offload_stats {
+	/** Number of blocks filled by the RX DMAC since the start */
+	uint32_t	blocks;
+	/** Number of times the ring was full and samples were dropped */
+	uint32_t	overflows;
+};
+
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
@@ -209,6 +277,57 @@ int32_t spi_engine_offload_transfer(struct no_os_spi_desc *desc,
 				    struct spi_engine_offload_message msg,
 				    uint32_t no_samples);
 
+/* Compile commands in a program using caller provided storage */
+int32_t spi_engine_program_compile(struct no_os_spi_desc *desc,
+				   struct spi_engine_program *prog,
+				   const uint32_t *commands,
+				   uint32_t no_commands);
+
+/* Allocate and compile a program */
+int32_t spi_engine_program_init(struct no_os_spi_desc *desc,
+				struct spi_engine_program **prog,
+				const uint32_t *commands,
+				uint32_t no_commands);
+
+/* Free a program allocated by spi_engine_program_init() */
+int32_t spi_engine_program_remove(struct spi_engine_program *prog);
+
+/* Run a compiled program using the FIFO interface */
+int32_t spi_engine_program_run(struct no_os_spi_desc *desc,
+			       struct spi_engine_program *prog,
+			       const uint32_t *tx_buf,
+			       uint32_t *rx_buf);
+
+/* Load a compiled program in the offload module */
+int32_t spi_engine_offload_load(struct no_os_spi_desc *desc,
+				struct spi_engine_program *prog,
+				const uint32_t *sdo_data);
+
+/* Start the offload module with the loaded program */
+int32_t spi_engine_offload_start(struct no_os_spi_desc *desc,
+				 uint32_t tx_addr,
+				 uint32_t rx_addr,
+				 uint32_t no_samples);
+
+/* Start a continuous offload capture into a ring of blocks */
+int32_t spi_engine_offload_stream_start(struct no_os_spi_desc *desc,
+					const struct spi_engine_offload_stream_init *init);
+
+/* Get the oldest captured block */
+int32_t spi_engine_offload_stream_get_block(struct no_os_spi_desc *desc,
+		uint32_t *address);
+
+/* Give the oldest captured block back to the RX DMAC */
+int32_t spi_engine_offload_stream_release_block(struct no_os_spi_desc *desc);
+
+/* Get the statistics of the running capture */
+int32_t spi_engine_offload_stream_get_stats(struct no_os_spi_desc *desc,
+		struct spi_engine_offload_stats *stats);
+
+/* Stop the continuous offload capture */
+int32_t spi_engine_offload_stream_stop(struct no_os_spi_desc *desc,
+				       struct spi_engine_offload_stats *stats);
+
 /* Set SPI transfer width */
 int32_t spi_engine_set_transfer_width(struct no_os_spi_desc *desc,
 				      uint8_t data_wdith);
@@ -80,3 +80,54 @@ int32_t no_os_axi_io_write(uint32_t base, uint32_t offset, uint32_t data)
 
 	return 0;
 }
+
+/**
+ * @brief AXI IO generic read of consecutive registers.
+ * @param base - Base address
+ * @param offset - Address offset of the first register
+ * @param data - variable where returned data is stored
+ * @param count - number of 32-bit registers to be read
+ * @return 0 in case of success, -1 otherwise.
+ */
+int32_t no_os_axi_io_read_bulk(uint32_t base, uint32_t offset, uint32_t *data,
+			       uint32_t count)
+{
+	NO_OS_UNUSED_PARAM(base);
+	NO_OS_UNUSED_PARAM(offset);
+	NO_OS_UNUSED_PARAM(data);
+	NO_OS_UNUSED_PARAM(count);
+
+	return 0;
+}
+
+/**
+ * @brief AXI IO generic write of consecutive registers.
+ * @param base - Base address
+ * @param offset - Address offset of the first register
+ * @param data - data to be written
+ * @param count - number of 32-bit registers to be written
+ * @return 0 in case of success, -1 otherwise.
+ */
+int32_t no_os_axi_io_write_bulk(uint32_t base, uint32_t offset,
+				const uint32_t *data, uint32_t count)
+{
+	NO_OS_UNUSED_PARAM(base);
+	NO_OS_UNUSED_PARAM(offset);
+	NO_OS_UNUSED_PARAM(data);
+	NO_OS_UNUSED_PARAM(count);
+
+	return 0;
+}
+
+/**
+ * @brief AXI IO generic release function.
+ *        There is nothing to release.
+ * @param base - Base address
+ * @return 0 in case of success, -1 otherwise.
+ */
+int32_t no_os_axi_io_release(uint32_t base)
+{
+	NO_OS_UNUSED_PARAM(base);
+
+	return 0;
+}
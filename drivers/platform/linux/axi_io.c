@@ -1,6 +1,6 @@
 /***************************************************************************//**
  *   @file   linux/axi_io.c
- *   @brief  Implementation of AXI IO through UIO/devmem.
+ *   @brief  Implementation of AXI IO through persistent UIO/devmem mappings.
  *   @author Dragos Bogdan (dragos.bogdan@analog.com)
 ********************************************************************************
  * Copyright 2020(c) Analog Devices, Inc.
@@ -45,120 +45,205 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <pthread.h>
 #include <sys/mman.h>
 #include "no_os_error.h"
 #include "no_os_axi_io.h"
 
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/** Maximum number of register windows kept mapped at the same time */
+#define AXI_IO_MAX_REGIONS	32
+
+#ifdef DEVMEM
+/** Default /dev/mem window size, matching the AXI core register space */
+#define AXI_IO_DEVMEM_WINDOW	0x10000
+#endif
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct axi_io_region
+ * @brief Register window mapped once and reused for every access.
+ */
+struct axi_io_region {
+	/** UIO index (/dev/uioX) or physical base address (DEVMEM) */
+	uint32_t base;
+	/** File descriptor of /dev/uioX or /dev/mem */
+	int fd;
+	/** Address returned by mmap() */
+	void *map;
+	/** Length passed to mmap() */
+	size_t map_size;
+	/** Address of the first register of the window */
+	volatile uint8_t *regs;
+	/** Number of bytes accessible starting from regs */
+	size_t size;
+};
+
+/******************************************************************************/
+/************************ Variables Definitions *******************************/
+/******************************************************************************/
+
+static struct axi_io_region axi_io_regions[AXI_IO_MAX_REGIONS];
+static uint32_t axi_io_nb_regions;
+static struct axi_io_region *axi_io_last_region;
+/**
+ * Protects the region table. It is held for the whole access, so a window
+ * can't be remapped or released while another thread uses it.
+ */
+static pthread_mutex_t axi_io_lock = PTHREAD_MUTEX_INITIALIZER;
+
 /******************************************************************************/
 /************************ Functions Definitions *******************************/
 /******************************************************************************/
 
 /**
- * @brief AXI IO through UIO read/write function.
+ * @brief Round a size up to the system page size.
+ * @param size - Size in bytes.
+ * @return Size rounded up to a multiple of the page size.
+ */
+static size_t axi_io_page_align(size_t size)
+{
+	size_t page = sysconf(_SC_PAGESIZE);
+
+	return (size + page - 1) & ~(page - 1);
+}
+
+#ifndef DEVMEM
+/**
+ * @brief Get the size of the first UIO memory map from sysfs.
  * @param base - UIO index (/dev/uioX).
- * @param offset - Address offset.
- * @param read - Location where read data will be stored.
- * @param write - Data to be written.
- * @return 0 in case of success, -1 otherwise.
+ * @return Size of the map, 0 if it can't be determined.
  */
-static int32_t uio_read_write(uint32_t base, uint32_t offset, uint32_t *read,
-			      uint32_t *write)
+static size_t axi_io_uio_map_size(uint32_t base)
 {
-	char buf[32];
-	int ret;
-	int uio_fd;
-	int32_t status = 0;
-	void *uio_addr;
+	char path[64];
+	unsigned long size = 0;
+	FILE *f;
 
-	sprintf(buf, "/dev/uio%"PRIu32"", base);
+	snprintf(path, sizeof(path),
+		 "/sys/class/uio/uio%"PRIu32"/maps/map0/size", base);
 
-	uio_fd = open(buf, O_RDWR);
-	if (uio_fd < 0) {
-		printf("%s: Can't open %s\n\r", __func__, buf);
-		return -1;
-	}
+	f = fopen(path, "r");
+	if (!f)
+		return 0;
+
+	if (fscanf(f, "%lx", &size) != 1)
+		size = 0;
+
+	fclose(f);
 
-	uio_addr = mmap(NULL,
-			offset + sizeof(*read),
-			PROT_READ|PROT_WRITE,
-			MAP_SHARED,
-			uio_fd,
-			0);
-	if (uio_addr == MAP_FAILED) {
+	return size;
+}
+#endif
+
+/**
+ * @brief Map (or remap to a larger size) the window of a region.
+ * @param region - Region to be mapped. fd and base must be valid.
+ * @param size - Minimum number of bytes accessible from the region start.
+ * @return 0 in case of success, -1 otherwise.
+ */
+static int32_t axi_io_region_map(struct axi_io_region *region, size_t size)
+{
+	size_t map_size;
+	off_t map_offset = 0;
+	size_t skip = 0;
+	void *map;
+
+#ifdef DEVMEM
+	skip = region->base & (sysconf(_SC_PAGESIZE) - 1);
+	map_offset = region->base - skip;
+#endif
+	map_size = axi_io_page_align(skip + size);
+
+	map = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+		   region->fd, map_offset);
+	if (map == MAP_FAILED) {
 		printf("%s: mmap() failed\n\r", __func__);
-		status = -1;
-		goto close;
+		return -1;
 	}
 
-	if (read)
-		*read = *(uint32_t *)((uintptr_t)uio_addr + offset);
-	if (write)
-		*(uint32_t *)((uintptr_t)uio_addr + offset) = *write;
-
-	ret = munmap(uio_addr, offset + sizeof(*read));
-	if (ret < 0) {
+	if (region->map && munmap(region->map, region->map_size) < 0)
 		printf("%s: munmap() failed\n\r", __func__);
-		status = -1;
-	}
 
-close:
-	ret = close(uio_fd);
-	if (ret < 0) {
-		printf("%s: Can't close %s\n\r", __func__, buf);
-		status = -1;
-	}
+	region->map = map;
+	region->map_size = map_size;
+	region->regs = (volatile uint8_t *)map + skip;
+	region->size = map_size - skip;
 
-	return status;
+	return 0;
 }
 
-#ifdef DEVMEM
 /**
- * @brief AXI IO through devmem read/write function.
- * @param base - Base address.
- * @param offset - Address offset.
- * @param read - Location where read data will be stored.
- * @param write - Data to be written.
- * @return 0 in case of success, -1 otherwise.
+ * @brief Get the mapped region of a base, mapping it on first use.
+ *        Must be called with axi_io_lock held.
+ * @param base - UIO index (/dev/uioX)/base address.
+ * @param end - Offset of the first byte past the accessed registers.
+ * @return Pointer to the region, NULL in case of failure.
  */
-static int32_t devmem_read_write(uint32_t base, uint32_t offset, uint32_t *read,
-				 uint32_t *write)
+static struct axi_io_region *axi_io_get_region(uint32_t base, size_t end)
 {
-	char command[64];
-	char answer[64];
-	FILE *stream;
-	int32_t ret;
-
-	if (write)
-		ret = snprintf(command, sizeof(command),
-			       "busybox devmem 0x%x w 0x%x", base + offset, *write);
-	else if (read)
-		ret = snprintf(command, sizeof(command),
-			       "busybox devmem 0x%x", base + offset);
-	else
-		return -1;
+	struct axi_io_region *region = axi_io_last_region;
+	size_t size;
+	char path[32];
+	uint32_t i;
 
-	if (ret < 0 || ret >= (int32_t) sizeof(command))
-		return -1;
+	if (!region || region->base != base) {
+		region = NULL;
+		for (i = 0; i < axi_io_nb_regions; i++) {
+			if (axi_io_regions[i].base == base) {
+				region = &axi_io_regions[i];
+				break;
+			}
+		}
+	}
 
-	stream = popen(command, "r");
-	if (stream == NULL)
-		return -1;
+	if (region) {
+		if (end > region->size && axi_io_region_map(region, end))
+			return NULL;
+		axi_io_last_region = region;
 
-	if (!(fgets(answer, sizeof(answer), stream))) {
-		ret = -1;
-		goto close;
+		return region;
 	}
 
-	if (read)
-		*read = strtol(answer, NULL, 0);
+	if (axi_io_nb_regions == AXI_IO_MAX_REGIONS) {
+		printf("%s: Too many mapped regions\n\r", __func__);
+		return NULL;
+	}
 
-	ret = 0;
-close:
-	pclose(stream);
+	region = &axi_io_regions[axi_io_nb_regions];
+	region->base = base;
+	region->map = NULL;
+#ifdef DEVMEM
+	snprintf(path, sizeof(path), "/dev/mem");
+	region->fd = open(path, O_RDWR | O_SYNC);
+	size = AXI_IO_DEVMEM_WINDOW;
+#else
+	snprintf(path, sizeof(path), "/dev/uio%"PRIu32"", base);
+	region->fd = open(path, O_RDWR);
+	size = axi_io_uio_map_size(base);
+#endif
+	if (region->fd < 0) {
+		printf("%s: Can't open %s\n\r", __func__, path);
+		return NULL;
+	}
 
-	return ret;
+	if (axi_io_region_map(region, size > end ? size : end)) {
+		close(region->fd);
+		return NULL;
+	}
+
+	axi_io_nb_regions++;
+	axi_io_last_region = region;
+
+	return region;
 }
-#endif //DEVMEM
+
 /**
  * @brief AXI IO through UIO/devmem read function.
  * @param base - UIO index (/dev/uioX)/base address.
@@ -168,25 +253,139 @@ close:
  */
 int32_t no_os_axi_io_read(uint32_t base, uint32_t offset, uint32_t *data)
 {
-#ifdef DEVMEM
-	return devmem_read_write(base, offset, data, NULL);
-#else
-	return uio_read_write(base, offset, data, NULL);
-#endif
+	struct axi_io_region *region;
+	int32_t ret = -1;
+
+	pthread_mutex_lock(&axi_io_lock);
+	region = axi_io_get_region(base, (size_t)offset + sizeof(*data));
+	if (region) {
+		*data = *(volatile uint32_t *)(region->regs + offset);
+		ret = 0;
+	}
+	pthread_mutex_unlock(&axi_io_lock);
+
+	return ret;
 }
 
 /**
- * @brief AXI IO through UIO specific write function.
- * @param base - UIO index (/dev/uioX).
+ * @brief AXI IO through UIO/devmem write function.
+ * @param base - UIO index (/dev/uioX)/base address.
  * @param offset - Address offset.
  * @param data - Data to be written.
  * @return 0 in case of success, -1 otherwise.
  */
 int32_t no_os_axi_io_write(uint32_t base, uint32_t offset, uint32_t data)
 {
-#ifdef DEVMEM
-	return devmem_read_write(base, offset, NULL, &data);
-#else
-	return uio_read_write(base, offset, NULL, &data);
-#endif
+	struct axi_io_region *region;
+	int32_t ret = -1;
+
+	pthread_mutex_lock(&axi_io_lock);
+	region = axi_io_get_region(base, (size_t)offset + sizeof(data));
+	if (region) {
+		*(volatile uint32_t *)(region->regs + offset) = data;
+		ret = 0;
+	}
+	pthread_mutex_unlock(&axi_io_lock);
+
+	return ret;
+}
+
+/**
+ * @brief AXI IO through UIO/devmem read of consecutive registers.
+ * @param base - UIO index (/dev/uioX)/base address.
+ * @param offset - Address offset of the first register.
+ * @param data - Location where read data will be stored.
+ * @param count - Number of 32-bit registers to be read.
+ * @return 0 in case of success, -1 otherwise.
+ */
+int32_t no_os_axi_io_read_bulk(uint32_t base, uint32_t offset, uint32_t *data,
+			       uint32_t count)
+{
+	struct axi_io_region *region;
+	volatile uint32_t *regs;
+	uint32_t i;
+
+	pthread_mutex_lock(&axi_io_lock);
+	region = axi_io_get_region(base, (size_t)offset + count * sizeof(*data));
+	if (!region) {
+		pthread_mutex_unlock(&axi_io_lock);
+		return -1;
+	}
+
+	regs = (volatile uint32_t *)(region->regs + offset);
+	for (i = 0; i < count; i++)
+		data[i] = regs[i];
+	pthread_mutex_unlock(&axi_io_lock);
+
+	return 0;
+}
+
+/**
+ * @brief AXI IO through UIO/devmem write of consecutive registers.
+ * @param base - UIO index (/dev/uioX)/base address.
+ * @param offset - Address offset of the first register.
+ * @param data - Data to be written.
+ * @param count - Number of 32-bit registers to be written.
+ * @return 0 in case of success, -1 otherwise.
+ */
+int32_t no_os_axi_io_write_bulk(uint32_t base, uint32_t offset,
+				const uint32_t *data, uint32_t count)
+{
+	struct axi_io_region *region;
+	volatile uint32_t *regs;
+	uint32_t i;
+
+	pthread_mutex_lock(&axi_io_lock);
+	region = axi_io_get_region(base, (size_t)offset + count * sizeof(*data));
+	if (!region) {
+		pthread_mutex_unlock(&axi_io_lock);
+		return -1;
+	}
+
+	regs = (volatile uint32_t *)(region->regs + offset);
+	for (i = 0; i < count; i++)
+		regs[i] = data[i];
+	pthread_mutex_unlock(&axi_io_lock);
+
+	return 0;
+}
+
+/**
+ * @brief Unmap the register window of a base and close its device file.
+ *        The window is mapped again on the next access.
+ * @param base - UIO index (/dev/uioX)/base address.
+ * @return 0 in case of success, -1 otherwise.
+ */
+int32_t no_os_axi_io_release(uint32_t base)
+{
+	struct axi_io_region *region = NULL;
+	int32_t ret = 0;
+	uint32_t i;
+
+	pthread_mutex_lock(&axi_io_lock);
+	for (i = 0; i < axi_io_nb_regions; i++) {
+		if (axi_io_regions[i].base == base) {
+			region = &axi_io_regions[i];
+			break;
+		}
+	}
+	if (!region)
+		goto unlock;
+
+	if (munmap(region->map, region->map_size) < 0) {
+		printf("%s: munmap() failed\n\r", __func__);
+		ret = -1;
+	}
+	close(region->fd);
+
+	/* Keep the table packed by moving the last region in the freed slot. */
+	axi_io_nb_regions--;
+	if (region != &axi_io_regions[axi_io_nb_regions])
+		*region = axi_io_regions[axi_io_nb_regions];
+	axi_io_last_region = NULL;
+
+unlock:
+	pthread_mutex_unlock(&axi_io_lock);
+
+	return ret;
 }
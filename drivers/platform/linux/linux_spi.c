@@ -45,7 +45,10 @@
 #include "no_os_spi.h"
 #include "linux_spi.h"
 
+#include <errno.h>
 #include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/ioctl.h>
@@ -63,6 +66,26 @@
 struct linux_spi_desc {
 	/** /dev/spidev"device_id"."chip_select" file descriptor */
 	int spidev_fd;
+	/** Transfer pool, reused by every SPI_IOC_MESSAGE() call */
+	struct spi_ioc_transfer tr[LINUX_SPI_MAX_TRANSFERS];
+	/** Number of transfers queued in the pool */
+	uint32_t nb_queued;
+	/** Serializes the access to the transfer pool */
+	pthread_mutex_t bus_lock;
+	/** Protects the asynchronous request queue */
+	pthread_mutex_t lock;
+	/** Signals the worker that a request was queued */
+	pthread_cond_t cond;
+	/** Worker thread sending the asynchronous requests */
+	pthread_t worker;
+	/** Set if the worker thread was created */
+	bool worker_started;
+	/** Set to make the worker exit once the queue is empty */
+	bool worker_stop;
+	/** First asynchronous request waiting to be sent */
+	struct no_os_spi_async_req *head;
+	/** Last asynchronous request waiting to be sent */
+	struct no_os_spi_async_req *tail;
 };
 
 /******************************************************************************/
@@ -92,6 +115,14 @@ int32_t linux_spi_init(struct no_os_spi_desc **desc,
 	if (!linux_desc)
 		goto free_desc;
 
+	linux_desc->nb_queued = 0;
+	linux_desc->worker_started = false;
+	linux_desc->worker_stop = false;
+	linux_desc->head = NULL;
+	linux_desc->tail = NULL;
+	pthread_mutex_init(&linux_desc->bus_lock, NULL);
+	pthread_mutex_init(&linux_desc->lock, NULL);
+	pthread_cond_init(&linux_desc->cond, NULL);
 	descriptor->extra = linux_desc;
 
 	snprintf(path, sizeof(path), "/dev/spidev%d.%d",
@@ -135,34 +166,182 @@ free_desc:
 	return -1;
 }
 
+/**
+ * @brief Send the transfers queued in the pool with a single ioctl call.
+ * @param linux_desc - The Linux SPI descriptor.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t linux_spi_submit(struct linux_spi_desc *linux_desc)
+{
+	uint32_t nb = linux_desc->nb_queued;
+	int ret;
+
+	if (!nb)
+		return 0;
+
+	linux_desc->nb_queued = 0;
+
+	/*
+	 * For the last transfer of a message, spidev keeps CS asserted if
+	 * cs_change is set. CS is always released at the end of the message.
+	 */
+	linux_desc->tr[nb - 1].cs_change = 0;
+
+	ret = ioctl(linux_desc->spidev_fd, SPI_IOC_MESSAGE(nb), linux_desc->tr);
+	if (ret < 0) {
+		ret = -errno;
+		printf("%s: Can't send spi message (%d)\n\r", __func__, ret);
+		return ret;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Add a message to the transfer pool. The transfer size is only
+ * limited by the spidev bufsiz module parameter.
+ * @param linux_desc - The Linux SPI descriptor.
+ * @param msg - The message.
+ * @return 0 in case of success, -EMSGSIZE if the pool is full.
+ */
+static int32_t linux_spi_push(struct linux_spi_desc *linux_desc,
+			      struct no_os_spi_msg *msg)
+{
+	struct spi_ioc_transfer *tr;
+
+	if (linux_desc->nb_queued == LINUX_SPI_MAX_TRANSFERS)
+		return -EMSGSIZE;
+
+	tr = &linux_desc->tr[linux_desc->nb_queued++];
+	*tr = (struct spi_ioc_transfer) {
+		.tx_buf = (unsigned long)msg->tx_buff,
+		.rx_buf = (unsigned long)msg->rx_buff,
+		.len = msg->bytes_number,
+		.cs_change = msg->cs_change,
+	};
+
+	return 0;
+}
+
+/**
+ * @brief Queue a message to be sent with the next linux_spi_flush() call.
+ * Messages are sent in a single SPI_IOC_MESSAGE() call, so set cs_change
+ * to release CS between them. When the pool is full, the queue is flushed
+ * only if CS is released after the last queued message anyway, otherwise
+ * -EMSGSIZE is returned. The rx_buff content is valid only after the message
+ * was sent.
+ * @param desc - The SPI descriptor.
+ * @param msg - The message.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t linux_spi_queue(struct no_os_spi_desc *desc,
+			struct no_os_spi_msg *msg)
+{
+	struct linux_spi_desc *linux_desc;
+	int32_t ret;
+
+	if (!desc || !msg)
+		return -EINVAL;
+
+	linux_desc = desc->extra;
+
+	pthread_mutex_lock(&linux_desc->bus_lock);
+	if (linux_desc->nb_queued == LINUX_SPI_MAX_TRANSFERS &&
+	    linux_desc->tr[linux_desc->nb_queued - 1].cs_change) {
+		ret = linux_spi_submit(linux_desc);
+		if (ret)
+			goto unlock;
+	}
+
+	ret = linux_spi_push(linux_desc, msg);
+unlock:
+	pthread_mutex_unlock(&linux_desc->bus_lock);
+
+	return ret;
+}
+
+/**
+ * @brief Send all the queued messages with a single SPI_IOC_MESSAGE() call.
+ * @param desc - The SPI descriptor.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t linux_spi_flush(struct no_os_spi_desc *desc)
+{
+	struct linux_spi_desc *linux_desc;
+	int32_t ret;
+
+	if (!desc)
+		return -EINVAL;
+
+	linux_desc = desc->extra;
+
+	pthread_mutex_lock(&linux_desc->bus_lock);
+	ret = linux_spi_submit(linux_desc);
+	pthread_mutex_unlock(&linux_desc->bus_lock);
+
+	return ret;
+}
+
+/**
+ * @brief Write/read multiple messages to/from SPI. The messages are sent
+ * using the preallocated transfer pool, with a single SPI_IOC_MESSAGE() call,
+ * so at most LINUX_SPI_MAX_TRANSFERS of them. Messages still queued with
+ * linux_spi_queue() are sent first, in the same call if they fit.
+ * @param linux_desc - The Linux SPI descriptor.
+ * @param msgs - The messages array.
+ * @param len - Number of messages.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t linux_spi_transfer_msgs(struct linux_spi_desc *linux_desc,
+				       struct no_os_spi_msg *msgs,
+				       uint32_t len)
+{
+	int32_t ret;
+	uint32_t i;
+
+	/* Splitting the list would release CS in the middle of it */
+	if (len > LINUX_SPI_MAX_TRANSFERS)
+		return -EMSGSIZE;
+
+	pthread_mutex_lock(&linux_desc->bus_lock);
+
+	if (linux_desc->nb_queued + len > LINUX_SPI_MAX_TRANSFERS) {
+		ret = linux_spi_submit(linux_desc);
+		if (ret)
+			goto unlock;
+	}
+
+	for (i = 0; i < len; i++) {
+		ret = linux_spi_push(linux_desc, &msgs[i]);
+		if (ret)
+			goto unlock;
+	}
+
+	ret = linux_spi_submit(linux_desc);
+unlock:
+	pthread_mutex_unlock(&linux_desc->bus_lock);
+
+	return ret;
+}
+
 /**
  * @brief Write and read data to/from SPI.
  * @param desc - The SPI descriptor.
  * @param data - The buffer with the transmitted/received data.
  * @param bytes_number - Number of bytes to write/read.
- * @return 0 in case of success, -1 otherwise.
+ * @return 0 in case of success, negative error code otherwise.
  */
 int32_t linux_spi_write_and_read(struct no_os_spi_desc *desc,
 				 uint8_t *data,
 				 uint16_t bytes_number)
 {
-	struct spi_ioc_transfer tr = {
-		.tx_buf = (unsigned long)data,
-		.rx_buf = (unsigned long)data,
-		.len = bytes_number,
+	struct no_os_spi_msg msg = {
+		.tx_buff = data,
+		.rx_buff = data,
+		.bytes_number = bytes_number,
 	};
-	struct linux_spi_desc *linux_desc;
-	int ret;
 
-	linux_desc = desc->extra;
-
-	ret = ioctl(linux_desc->spidev_fd, SPI_IOC_MESSAGE(1), &tr);
-	if (ret == 1) {
-		printf("%s: Can't send spi message\n\r", __func__);
-		return -1;
-	}
-
-	return 0;
+	return linux_spi_transfer_msgs(desc->extra, &msg, 1);
 }
 
 /**
@@ -177,6 +356,18 @@ int32_t linux_spi_remove(struct no_os_spi_desc *desc)
 
 	linux_desc = desc->extra;
 
+	if (linux_desc->worker_started) {
+		pthread_mutex_lock(&linux_desc->lock);
+		linux_desc->worker_stop = true;
+		pthread_cond_signal(&linux_desc->cond);
+		pthread_mutex_unlock(&linux_desc->lock);
+		pthread_join(linux_desc->worker, NULL);
+	}
+
+	pthread_cond_destroy(&linux_desc->cond);
+	pthread_mutex_destroy(&linux_desc->lock);
+	pthread_mutex_destroy(&linux_desc->bus_lock);
+
 	ret = close(linux_desc->spidev_fd);
 	if (ret < 0) {
 		printf("%s: Can't close device\n\r", __func__);
@@ -189,37 +380,96 @@ int32_t linux_spi_remove(struct no_os_spi_desc *desc)
 	return 0;
 }
 
+/**
+ * @brief Write/read multiple messages to/from SPI.
+ * @param desc - The SPI descriptor.
+ * @param msgs - The messages array.
+ * @param len - Number of messages.
+ * @return 0 in case of success, negative error code otherwise.
+ */
 static int32_t linux_spi_transfer(struct no_os_spi_desc *desc,
 				  struct no_os_spi_msg *msgs,
 				  uint32_t len)
+{
+	return linux_spi_transfer_msgs(desc->extra, msgs, len);
+}
 
+/**
+ * @brief Send the asynchronous requests in submission order, until
+ * linux_spi_remove() is called.
+ * @param arg - The Linux SPI descriptor.
+ * @return NULL.
+ */
+static void *linux_spi_worker(void *arg)
 {
-	struct spi_ioc_transfer *tr;
-	struct linux_spi_desc	*linux_desc;
-	int			ret;
-	uint32_t		i;
+	struct linux_spi_desc *linux_desc = arg;
+	struct no_os_spi_async_req *req;
+	int32_t ret;
+
+	pthread_mutex_lock(&linux_desc->lock);
+	while (true) {
+		while (!linux_desc->head && !linux_desc->worker_stop)
+			pthread_cond_wait(&linux_desc->cond, &linux_desc->lock);
+
+		req = linux_desc->head;
+		if (!req)
+			break;
+
+		linux_desc->head = req->next;
+		if (!linux_desc->head)
+			linux_desc->tail = NULL;
+		pthread_mutex_unlock(&linux_desc->lock);
+
+		ret = linux_spi_transfer_msgs(linux_desc, req->msgs, req->len);
+		req->callback(req->ctx, ret);
+
+		pthread_mutex_lock(&linux_desc->lock);
+	}
+	pthread_mutex_unlock(&linux_desc->lock);
+
+	return NULL;
+}
+
+/**
+ * @brief Queue a request to be sent by the worker thread. The worker is
+ * created on the first call and the callback is called from its context.
+ * @param desc - The SPI descriptor.
+ * @param req - The request.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t linux_spi_transfer_async(struct no_os_spi_desc *desc,
+					struct no_os_spi_async_req *req)
+{
+	struct linux_spi_desc *linux_desc;
+	int32_t ret = 0;
 
 	linux_desc = desc->extra;
 
-	tr = (struct spi_ioc_transfer *)calloc(len, sizeof(*tr));
-	if (!tr)
-		return -ENOMEM;
+	pthread_mutex_lock(&linux_desc->lock);
 
-	for (i = 0; i < len; i++) {
-		tr[i].tx_buf = (unsigned long) msgs[i].tx_buff;
-		tr[i].rx_buf = (unsigned long) msgs[i].rx_buff;
-		tr[i].len = msgs[i].bytes_number;
-		tr[i].cs_change = msgs[i].cs_change;
+	if (!linux_desc->worker_started) {
+		ret = -pthread_create(&linux_desc->worker, NULL,
+				      linux_spi_worker, linux_desc);
+		if (ret) {
+			printf("%s: Can't create worker thread\n\r", __func__);
+			goto unlock;
+		}
+		linux_desc->worker_started = true;
 	}
 
-	ret = ioctl(linux_desc->spidev_fd, SPI_IOC_MESSAGE(len), tr);
-	if (ret < 0)
-		printf("%s: Can't send spi message (%d)\n\r", __func__, errno);
+	if (linux_desc->tail)
+		linux_desc->tail->next = req;
+	else
+		linux_desc->head = req;
+	linux_desc->tail = req;
 
-	free(tr);
+	pthread_cond_signal(&linux_desc->cond);
+unlock:
+	pthread_mutex_unlock(&linux_desc->lock);
 
 	return ret;
 }
+
 /**
  * @brief Linux platform specific SPI platform ops structure
  */
@@ -227,5 +477,6 @@ const struct no_os_spi_platform_ops linux_spi_ops = {
 	.init = &linux_spi_init,
 	.write_and_read = &linux_spi_write_and_read,
 	.remove = &linux_spi_remove,
-	.transfer = &linux_spi_transfer
+	.transfer = &linux_spi_transfer,
+	.transfer_async = &linux_spi_transfer_async
 };
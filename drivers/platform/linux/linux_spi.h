@@ -40,9 +40,26 @@
 #ifndef LINUX_SPI_H_
 #define LINUX_SPI_H_
 
+#include <stdint.h>
+#include "no_os_spi.h"
+
+/**
+ * @brief Number of transfers preallocated per descriptor, i.e. the maximum
+ * number of messages sent with one SPI_IOC_MESSAGE() call. Longer message
+ * lists are rejected with -EMSGSIZE.
+ */
+#define LINUX_SPI_MAX_TRANSFERS		64
+
 /**
  * @brief Linux specific SPI platform ops structure
  */
 extern const struct no_os_spi_platform_ops linux_spi_ops;
 
+/* Queue a message to be sent with the next linux_spi_flush() call. */
+int32_t linux_spi_queue(struct no_os_spi_desc *desc,
+			struct no_os_spi_msg *msg);
+
+/* Send all the queued messages with a single SPI_IOC_MESSAGE() call. */
+int32_t linux_spi_flush(struct no_os_spi_desc *desc);
+
 #endif // LINUX_SPI_H_
@@ -0,0 +1,277 @@
+/***************************************************************************//**
+ *   @file   linux/linux_timer.c
+ *   @brief  Implementation of Linux platform Timer Driver.
+********************************************************************************
+ * Copyright 2022(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+#include "no_os_timer.h"
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct linux_timer_desc
+ * @brief Linux platform specific timer state, kept in no_os_timer_desc.extra
+ */
+struct linux_timer_desc {
+	/** Time of the last start */
+	struct timespec start;
+	/** Time counted before the last start, in ns */
+	uint64_t elapsed;
+	/** Set while the timer counts */
+	bool running;
+};
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/* Monotonic time since start in ns */
+static uint64_t linux_timer_since(struct timespec *start)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (uint64_t)(now.tv_sec - start->tv_sec) * 1000000000ull +
+	       now.tv_nsec - start->tv_nsec;
+}
+
+/**
+ * @brief Initialize a timer counting the CLOCK_MONOTONIC time.
+ * @param desc - Timer descriptor.
+ * @param param - Timer initialization parameters.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t no_os_timer_init(struct no_os_timer_desc **desc,
+			 struct no_os_timer_init_param *param)
+{
+	struct no_os_timer_desc *ldesc;
+	struct linux_timer_desc *extra;
+
+	if (!desc || !param || !param->freq_hz)
+		return -EINVAL;
+
+	ldesc = calloc(1, sizeof(*ldesc));
+	if (!ldesc)
+		return -ENOMEM;
+
+	extra = calloc(1, sizeof(*extra));
+	if (!extra) {
+		free(ldesc);
+		return -ENOMEM;
+	}
+
+	ldesc->id = param->id;
+	ldesc->freq_hz = param->freq_hz;
+	ldesc->load_value = param->load_value;
+	ldesc->extra = extra;
+	*desc = ldesc;
+
+	return 0;
+}
+
+/**
+ * @brief Free the memory allocated by no_os_timer_init().
+ * @param desc - Timer descriptor.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t no_os_timer_remove(struct no_os_timer_desc *desc)
+{
+	if (!desc)
+		return -EINVAL;
+
+	free(desc->extra);
+	free(desc);
+
+	return 0;
+}
+
+/**
+ * @brief Start counting.
+ * @param desc - Timer descriptor.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t no_os_timer_start(struct no_os_timer_desc *desc)
+{
+	struct linux_timer_desc *extra;
+
+	if (!desc)
+		return -EINVAL;
+
+	extra = desc->extra;
+	if (extra->running)
+		return 0;
+
+	clock_gettime(CLOCK_MONOTONIC, &extra->start);
+	extra->running = true;
+
+	return 0;
+}
+
+/**
+ * @brief Stop counting. The time counted so far is kept.
+ * @param desc - Timer descriptor.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t no_os_timer_stop(struct no_os_timer_desc *desc)
+{
+	struct linux_timer_desc *extra;
+
+	if (!desc)
+		return -EINVAL;
+
+	extra = desc->extra;
+	if (!extra->running)
+		return 0;
+
+	extra->elapsed += linux_timer_since(&extra->start);
+	extra->running = false;
+
+	return 0;
+}
+
+/**
+ * @brief Get the elapsed time in nsec.
+ * @param desc - Timer descriptor.
+ * @param elapsed_time - Time counted since the timer was started.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t no_os_timer_get_elapsed_time_nsec(struct no_os_timer_desc *desc,
+		uint64_t *elapsed_time)
+{
+	struct linux_timer_desc *extra;
+
+	if (!desc || !elapsed_time)
+		return -EINVAL;
+
+	extra = desc->extra;
+	*elapsed_time = extra->elapsed;
+	if (extra->running)
+		*elapsed_time += linux_timer_since(&extra->start);
+
+	return 0;
+}
+
+/**
+ * @brief Get the counter value, in ticks of freq_hz from load_value.
+ * @param desc - Timer descriptor.
+ * @param counter - Counter value.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t no_os_timer_counter_get(struct no_os_timer_desc *desc,
+				uint32_t *counter)
+{
+	uint64_t ns;
+	int32_t ret;
+
+	if (!counter)
+		return -EINVAL;
+
+	ret = no_os_timer_get_elapsed_time_nsec(desc, &ns);
+	if (ret)
+		return ret;
+
+	*counter = desc->load_value + ns / 1000 * desc->freq_hz / 1000000;
+
+	return 0;
+}
+
+/**
+ * @brief Set the counter value. Counting continues from it.
+ * @param desc - Timer descriptor.
+ * @param new_val - Counter value.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t no_os_timer_counter_set(struct no_os_timer_desc *desc,
+				uint32_t new_val)
+{
+	struct linux_timer_desc *extra;
+
+	if (!desc)
+		return -EINVAL;
+
+	extra = desc->extra;
+	desc->load_value = new_val;
+	extra->elapsed = 0;
+	if (extra->running)
+		clock_gettime(CLOCK_MONOTONIC, &extra->start);
+
+	return 0;
+}
+
+/**
+ * @brief Get the counter frequency.
+ * @param desc - Timer descriptor.
+ * @param freq_hz - Counter frequency.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t no_os_timer_count_clk_get(struct no_os_timer_desc *desc,
+				  uint32_t *freq_hz)
+{
+	if (!desc || !freq_hz)
+		return -EINVAL;
+
+	*freq_hz = desc->freq_hz;
+
+	return 0;
+}
+
+/**
+ * @brief Set the counter frequency. Only changes how the time is converted
+ * into counter ticks.
+ * @param desc - Timer descriptor.
+ * @param freq_hz - Counter frequency.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t no_os_timer_count_clk_set(struct no_os_timer_desc *desc,
+				  uint32_t freq_hz)
+{
+	if (!desc || !freq_hz)
+		return -EINVAL;
+
+	desc->freq_hz = freq_hz;
+
+	return 0;
+}
@@ -41,6 +41,7 @@
 /************************* Include Files **************************************/
 /******************************************************************************/
 
+#include <stdbool.h>
 #include <stdlib.h>
 #include <errno.h>
 #include "spi.h"
@@ -51,10 +52,52 @@
 #define SPI_MASTER_MODE	1
 #define SPI_SINGLE_MODE	0
 
+/**
+ * @struct max_spi_async_state
+ * @brief State of the asynchronous transfers on a SPI port
+ */
+struct max_spi_async_state {
+	/** Request of the message in progress, must be the first member */
+	mxc_spi_req_t req;
+	/** Request in progress */
+	struct no_os_spi_async_req *head;
+	/** Last queued request */
+	struct no_os_spi_async_req *tail;
+	/** Index of the message in progress */
+	uint32_t msg_idx;
+	/** Set while a message is being sent */
+	bool busy;
+};
+
+/**
+* @brief Asynchronous transfer state of each SPI port
+*/
+static struct max_spi_async_state async_state[2];
+
 /******************************************************************************/
 /************************ Functions Definitions *******************************/
 /******************************************************************************/
 
+/**
+ * @brief SPI0 interrupt handler.
+ * @return void
+ */
+void SPI0_IRQHandler(void)
+{
+	MXC_SPI_AsyncHandler(MXC_SPI0);
+}
+
+#ifdef MXC_SPI1
+/**
+ * @brief SPI1 interrupt handler.
+ * @return void
+ */
+void SPI1_IRQHandler(void)
+{
+	MXC_SPI_AsyncHandler(MXC_SPI1);
+}
+#endif
+
 /**
  * @brief Initialize the SPI communication peripheral.
  * @param desc - The SPI descriptor.
@@ -222,6 +265,129 @@ int32_t max_spi_transfer(struct no_os_spi_desc *desc,
 	return 0;
 }
 
+static void max_spi_async_complete(void *req, int result);
+
+/**
+ * @brief Start sending the current message of the request in progress.
+ * @param state - The state of the SPI port.
+ * @return 0 in case of success, errno codes otherwise.
+ */
+static int32_t max_spi_async_start(struct max_spi_async_state *state)
+{
+	struct no_os_spi_async_req *req = state->head;
+	struct no_os_spi_msg *msg = &req->msgs[state->msg_idx];
+	int32_t ret;
+
+	state->req.spi = MXC_SPI_GET_SPI(req->desc->device_id);
+	state->req.ssIdx = req->desc->chip_select;
+	state->req.txData = msg->tx_buff;
+	state->req.rxData = msg->rx_buff;
+	state->req.txCnt = 0;
+	state->req.rxCnt = 0;
+	state->req.ssDeassert = msg->cs_change ||
+				state->msg_idx == req->len - 1;
+	state->req.txLen = msg->bytes_number;
+	state->req.rxLen = msg->bytes_number;
+	state->req.completeCB = max_spi_async_complete;
+
+	ret = MXC_SPI_MasterTransactionAsync(&state->req);
+	if (ret == E_BAD_PARAM)
+		return -EINVAL;
+	if (ret == E_BAD_STATE || ret == E_BUSY)
+		return -EBUSY;
+
+	return 0;
+}
+
+/**
+ * @brief Called from the SPI interrupt when a message was sent. Starts the
+ * next message of the request, or calls the request callback and starts the
+ * next queued request.
+ * @param req - The mxc_spi_req_t of the finished message.
+ * @param result - E_NO_ERROR in case of success.
+ * @return void
+ */
+static void max_spi_async_complete(void *req, int result)
+{
+	struct max_spi_async_state *state = req;
+	struct no_os_spi_async_req *done;
+	int32_t ret;
+
+	ret = (result == E_NO_ERROR) ? 0 : -EIO;
+	if (!ret && state->msg_idx < state->head->len - 1) {
+		state->msg_idx++;
+		ret = max_spi_async_start(state);
+		if (!ret)
+			return;
+	}
+
+	/* Requests queued from the callback are started by the loop below */
+	while (true) {
+		done = state->head;
+		state->head = done->next;
+		if (!state->head)
+			state->tail = NULL;
+		state->msg_idx = 0;
+
+		done->callback(done->ctx, ret);
+		if (!state->head)
+			break;
+
+		ret = max_spi_async_start(state);
+		if (!ret)
+			return;
+	}
+
+	state->busy = false;
+}
+
+/**
+ * @brief Queue a request to be sent using the SPI interrupt. The callback is
+ * called from interrupt context.
+ * @param desc - The SPI descriptor.
+ * @param req - The request.
+ * @return 0 in case of success, errno codes otherwise.
+ */
+int32_t max_spi_transfer_async(struct no_os_spi_desc *desc,
+			       struct no_os_spi_async_req *req)
+{
+	struct max_spi_async_state *state;
+	IRQn_Type irq;
+	int32_t ret = 0;
+
+	if (!desc || !req || !req->len || desc->device_id >= 2)
+		return -EINVAL;
+
+	state = &async_state[desc->device_id];
+#ifdef MXC_SPI1
+	irq = desc->device_id == 0 ? SPI0_IRQn : SPI1_IRQn;
+#else
+	irq = SPI0_IRQn;
+#endif
+
+	NVIC_DisableIRQ(irq);
+
+	if (state->busy) {
+		state->tail->next = req;
+		state->tail = req;
+	} else {
+		state->head = req;
+		state->tail = req;
+		state->msg_idx = 0;
+		ret = max_spi_async_start(state);
+		if (ret) {
+			state->head = NULL;
+			state->tail = NULL;
+		} else {
+			state->busy = true;
+		}
+	}
+
+	NVIC_EnableIRQ(irq);
+
+	return ret;
+}
+
 /**
  * @brief maxim platform specific SPI platform ops structure
  */
@@ -229,5 +395,6 @@ const struct no_os_spi_platform_ops max_spi_ops = {
 	.init = &max_spi_init,
 	.write_and_read = &max_spi_write_and_read,
 	.transfer = &max_spi_transfer,
+	.transfer_async = &max_spi_transfer_async,
 	.remove = &max_spi_remove
 };
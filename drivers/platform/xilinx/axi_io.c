@@ -43,6 +43,7 @@
 
 #include <xil_io.h>
 #include "no_os_error.h"
+#include "no_os_util.h"
 #include "no_os_axi_io.h"
 
 /******************************************************************************/
@@ -77,3 +78,53 @@ int32_t no_os_axi_io_write(uint32_t base, uint32_t offset, uint32_t data)
 	return 0;
 }
 
+/**
+ * @brief AXI IO Xilinx specific read of consecutive registers.
+ * @param base - Base address
+ * @param offset - Address offset of the first register
+ * @param data - variable where returned data is stored
+ * @param count - number of 32-bit registers to be read
+ * @return 0 in case of success, -1 otherwise.
+ */
+int32_t no_os_axi_io_read_bulk(uint32_t base, uint32_t offset, uint32_t *data,
+			       uint32_t count)
+{
+	uint32_t i;
+
+	for (i = 0; i < count; i++)
+		data[i] = Xil_In32(base + offset + i * 4);
+
+	return 0;
+}
+
+/**
+ * @brief AXI IO Xilinx specific write of consecutive registers.
+ * @param base - Base address
+ * @param offset - Address offset of the first register
+ * @param data - data to be written
+ * @param count - number of 32-bit registers to be written
+ * @return 0 in case of success, -1 otherwise.
+ */
+int32_t no_os_axi_io_write_bulk(uint32_t base, uint32_t offset,
+				const uint32_t *data, uint32_t count)
+{
+	uint32_t i;
+
+	for (i = 0; i < count; i++)
+		Xil_Out32(base + offset + i * 4, data[i]);
+
+	return 0;
+}
+
+/**
+ * @brief AXI IO Xilinx specific release function.
+ *        Registers are accessed directly, there is nothing to release.
+ * @param base - Base address
+ * @return 0 in case of success, -1 otherwise.
+ */
+int32_t no_os_axi_io_release(uint32_t base)
+{
+	NO_OS_UNUSED_PARAM(base);
+
+	return 0;
+}
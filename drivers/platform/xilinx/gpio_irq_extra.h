@@ -46,9 +46,17 @@
 
 #include "stdbool.h"
 #include "no_os_list.h"
+#include "no_os_pool.h"
 #include "xgpiops.h"
 #include "no_os_irq.h"
 
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/** Maximum number of pins with a callback registered at the same time */
+#define XIL_GPIO_IRQ_MAX_CALLBACKS	16
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
@@ -82,6 +90,12 @@ struct xil_gpio_irq_desc {
 	XGpioPs my_Gpio;
 	struct no_os_list_desc *callback_list;
 	struct no_os_iterator *it;
+	/* Callbacks and their list elements are taken from these pools */
+	struct no_os_pool callback_pool;
+	struct xil_callback_desc callback_mem[XIL_GPIO_IRQ_MAX_CALLBACKS];
+	struct no_os_pool elem_pool;
+	void *elem_mem[NO_OS_LIST_ELEM_SIZE / sizeof(void *) *
+		       XIL_GPIO_IRQ_MAX_CALLBACKS];
 };
 
 /**
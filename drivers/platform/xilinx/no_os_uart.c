@@ -75,8 +75,10 @@ static int32_t uart_fifo_insert(struct no_os_uart_desc *desc)
 		ret = no_os_irq_disable(irq_desc, xil_uart_desc->irq_id);
 		if (ret < 0)
 			return ret;
-		ret = no_os_fifo_insert(&xil_uart_desc->fifo, xil_uart_desc->buff,
-					xil_uart_desc->bytes_received);
+		ret = no_os_fifo_insert_pool(&xil_uart_desc->fifo,
+					     &xil_uart_desc->fifo_pool,
+					     xil_uart_desc->buff,
+					     xil_uart_desc->bytes_received);
 		if (ret < 0)
 			return ret;
 		xil_uart_desc->bytes_received = 0;
@@ -366,6 +368,13 @@ int32_t no_os_uart_init(struct no_os_uart_desc **desc,
 		xil_uart_desc->instance = calloc(1, sizeof(XUartPs));
 		if (!(xil_uart_desc->instance))
 			goto error_free_xil_uart_desc;
+
+		status = no_os_pool_cfg(&xil_uart_desc->fifo_pool,
+					xil_uart_desc->fifo_mem,
+					sizeof(xil_uart_desc->fifo_mem),
+					NO_OS_FIFO_ELEM_SIZE(UART_BUFF_LENGTH));
+		if (status)
+			goto error_free_instance;
 		/*
 		 * Initialize the UART driver so that it's ready to use
 		 * Look up the configuration in the config table, then initialize it.
@@ -44,11 +44,19 @@
 /***************************** Include Files **********************************/
 /******************************************************************************/
 
+#include "no_os_fifo.h"
+#include "no_os_pool.h"
+
 /******************************************************************************/
 /********************** Macros and Constants Definitions **********************/
 /******************************************************************************/
 
 #define UART_BUFF_LENGTH 256
+/* A chunk is queued only once the previous one has been read */
+#define UART_FIFO_DEPTH 1
+#define UART_FIFO_MEM_LENGTH \
+	((NO_OS_FIFO_ELEM_SIZE(UART_BUFF_LENGTH) + sizeof(void *) - 1) / \
+	 sizeof(void *) * UART_FIFO_DEPTH)
 
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
@@ -94,6 +102,10 @@ struct xil_uart_desc {
 	struct no_os_fifo_element	*fifo;
 	/** FIFO read offset */
 	uint32_t 			fifo_read_offset;
+	/** Pool of the FIFO elements, no heap is used when receiving */
+	struct no_os_pool		fifo_pool;
+	/** Memory of the FIFO elements pool */
+	void				*fifo_mem[UART_FIFO_MEM_LENGTH];
 	/** UART Buffer */
 	char 				buff[UART_BUFF_LENGTH];
 	/** Number of bytes received */
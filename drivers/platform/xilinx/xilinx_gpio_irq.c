@@ -166,11 +166,26 @@ int32_t xil_gpio_irq_ctrl_init(struct no_os_irq_ctrl_desc **desc,
 	ldesc->extra = xil_desc;
 	xil_desc->parent_desc = xil_ip->parent_desc;
 
+	status = no_os_pool_cfg(&xil_desc->callback_pool, xil_desc->callback_mem,
+				sizeof(xil_desc->callback_mem),
+				sizeof(struct xil_callback_desc));
+	if(status)
+		goto error_desc;
+
+	status = no_os_pool_cfg(&xil_desc->elem_pool, xil_desc->elem_mem,
+				sizeof(xil_desc->elem_mem), NO_OS_LIST_ELEM_SIZE);
+	if(status)
+		goto error_desc;
+
 	status = no_os_list_init(&xil_desc->callback_list, NO_OS_LIST_DEFAULT,
 				 call_cmp);
 	if(status)
 		goto error_list;
 
+	status = no_os_list_set_pool(xil_desc->callback_list, &xil_desc->elem_pool);
+	if(status)
+		goto error_list;
+
 	status = no_os_iterator_init(&xil_desc->it, xil_desc->callback_list, 0);
 	if(status) {
 		no_os_iterator_remove(xil_desc->it);
@@ -246,19 +261,25 @@ int32_t xil_gpio_irq_register_callback(struct no_os_irq_ctrl_desc *desc,
 {
 	struct xil_callback_desc *dev_callback;
 	struct xil_gpio_irq_desc *extra;
+	int32_t status;
 
-	dev_callback = (struct xil_callback_desc *)calloc(1, sizeof(*dev_callback));
+	extra = desc->extra;
+	dev_callback = no_os_pool_alloc(&extra->callback_pool);
 	if(!dev_callback)
-		return -1;
+		return -ENOMEM;
 
 	dev_callback->pin_nb = irq_id;
 	dev_callback->callback.callback = callback_desc->callback;
 	dev_callback->callback.ctx = callback_desc->ctx;
 	dev_callback->triggered = false;
+	dev_callback->enabled = false;
 
-	extra = desc->extra;
+	status = no_os_list_add_last(extra->callback_list, dev_callback);
+	if(status) {
+		no_os_pool_free(&extra->callback_pool, dev_callback);
+		return -ENOMEM;
+	}
 	XGpioPs_SetDirectionPin(&extra->my_Gpio, irq_id, 0);
-	no_os_list_add_last(extra->callback_list, dev_callback);
 
 	return 0;
 }
@@ -284,7 +305,7 @@ int32_t xil_gpio_irq_unregister(struct no_os_irq_ctrl_desc *desc,
 	if(status)
 		return -ENXIO;
 
-	free(dev_callback);
+	no_os_pool_free(&extra->callback_pool, dev_callback);
 
 	return 0;
 }
@@ -334,7 +355,7 @@ int32_t xil_gpio_irq_ctrl_remove(struct no_os_irq_ctrl_desc *desc)
 
 	extra = desc->extra;
 	while (0 == no_os_list_get_first(extra->callback_list, &callback_desc))
-		free(callback_desc);
+		no_os_pool_free(&extra->callback_pool, callback_desc);
 
 	no_os_iterator_remove(extra->it);
 	no_os_list_remove(extra->callback_list);
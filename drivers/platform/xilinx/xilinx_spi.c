@@ -450,11 +450,98 @@ error:
 	return ret;
 }
 
+/**
+ * @brief Transfer a list of messages.
+ *
+ * On the PS controller, the options and the slave select are configured once
+ * for the whole list and CS is only toggled between messages that request it.
+ * The PL controller transfers the messages one by one.
+ * @param desc - The SPI descriptor.
+ * @param msgs - Array of messages.
+ * @param len - Number of messages.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t xil_spi_transfer(struct no_os_spi_desc *desc,
+			 struct no_os_spi_msg *msgs,
+			 uint32_t len)
+{
+	struct xil_spi_desc	*xdesc;
+	int32_t			ret;
+	uint32_t		i;
+
+	if (!desc || !desc->extra || !msgs)
+		return -EINVAL;
+
+	xdesc = desc->extra;
+
+	switch (xdesc->type) {
+	case SPI_PS:
+#ifdef XSPIPS_H
+		ret = XSpiPs_SetOptions(xdesc->instance,
+					XSPIPS_MASTER_OPTION |
+					((xdesc->flags & SPI_CS_DECODE) ?
+					 XSPIPS_DECODE_SSELECT_OPTION : 0) |
+					XSPIPS_FORCE_SSELECT_OPTION |
+					((desc->mode & NO_OS_SPI_CPOL) ?
+					 XSPIPS_CLK_ACTIVE_LOW_OPTION : 0) |
+					((desc->mode & NO_OS_SPI_CPHA) ?
+					 XSPIPS_CLK_PHASE_1_OPTION : 0));
+		if (ret != 0)
+			return -EIO;
+
+		ret = XSpiPs_SetSlaveSelect(xdesc->instance, desc->chip_select);
+		if (ret != 0)
+			return -EIO;
+
+		for (i = 0; i < len; i++) {
+			if (!msgs[i].tx_buff)
+				return -EINVAL;
+
+			ret = XSpiPs_PolledTransfer(xdesc->instance,
+						    msgs[i].tx_buff,
+						    msgs[i].rx_buff,
+						    msgs[i].bytes_number);
+			if (ret != 0)
+				break;
+
+			if (msgs[i].cs_change && i != len - 1) {
+				XSpiPs_SetSlaveSelect(xdesc->instance,
+						      SPI_DEASSERT_CURRENT_SS);
+				XSpiPs_SetSlaveSelect(xdesc->instance,
+						      desc->chip_select);
+			}
+		}
+
+		XSpiPs_SetSlaveSelect(xdesc->instance, SPI_DEASSERT_CURRENT_SS);
+
+		return ret ? -EIO : 0;
+#endif
+		break;
+	case SPI_PL:
+		for (i = 0; i < len; i++) {
+			if (msgs[i].rx_buff != msgs[i].tx_buff || !msgs[i].tx_buff)
+				return -EINVAL;
+
+			ret = xil_spi_write_and_read(desc, msgs[i].tx_buff,
+						     msgs[i].bytes_number);
+			if (ret != 0)
+				return -EIO;
+		}
+
+		return 0;
+	default:
+		break;
+	}
+
+	return -EINVAL;
+}
+
 /**
  * @brief Xilinx platform specific SPI platform ops structure
  */
 const struct no_os_spi_platform_ops xil_spi_ops = {
 	.init = &xil_spi_init,
 	.write_and_read = &xil_spi_write_and_read,
+	.transfer = &xil_spi_transfer,
 	.remove = &xil_spi_remove
 };
@@ -689,15 +689,15 @@ const char *ad9361_ensm_states[] = {
 };
 
 /**
- * SPI multiple bytes register read.
+ * SPI multiple bytes register read, bypassing the register cache.
  * @param spi
  * @param reg The register address.
  * @param rbuf The data buffer.
  * @param num The number of bytes to read.
  * @return 0 in case of success, negative error code otherwise.
  */
-int32_t ad9361_spi_readm(struct no_os_spi_desc *spi, uint32_t reg,
-			 uint8_t *rbuf, uint32_t num)
+static int32_t __ad9361_spi_readm(struct no_os_spi_desc *spi, uint32_t reg,
+				  uint8_t *rbuf, uint32_t num)
 {
 	int32_t ret = 0;
 	uint16_t cmd;
@@ -731,6 +731,335 @@ int32_t ad9361_spi_readm(struct no_os_spi_desc *spi, uint32_t reg,
 	return ret;
 }
 
+/**
+ * SPI multiple bytes register write, bypassing the register cache.
+ * @param spi
+ * @param reg The register address.
+ * @param tbuf The data buffer.
+ * @param num The number of bytes to read.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t __ad9361_spi_writem(struct no_os_spi_desc *spi,
+				   uint32_t reg, uint8_t *tbuf, uint32_t num)
+{
+	uint8_t buf[10];
+	int32_t ret;
+	uint16_t cmd;
+
+	if (num > MAX_MBYTE_SPI)
+		return -EINVAL;
+
+	cmd = AD_WRITE | AD_CNT(num) | AD_ADDR(reg);
+	buf[0] = cmd >> 8;
+	buf[1] = cmd & 0xFF;
+
+#ifndef ALTERA_PLATFORM
+	memcpy(&buf[2], tbuf, num);
+#else
+	int32_t i;
+	for (i = 0; i < num; i++)
+		buf[2 + i] =  tbuf[i];
+#endif
+	ret = no_os_spi_write_and_read(spi, buf, num + 2);
+	if (ret < 0) {
+		dev_err(&spi->dev, "Write Error %"PRId32, ret);
+		return ret;
+	}
+
+#ifdef _DEBUG
+	{
+		int32_t i;
+		for (i = 0; i < num; i++)
+			dev_dbg(&spi->dev, "Reg 0x%"PRIX32" val 0x%X", reg--, tbuf[i]);
+	}
+#endif
+
+	return 0;
+}
+
+/*
+ * Registers changed by the device itself (status, read ports, calibration
+ * results, self clearing bits). They are never cached.
+ */
+static const struct {
+	uint16_t start;
+	uint16_t end;
+} ad9361_volatile_regs[] = {
+	{ REG_SPI_CONF, REG_SPI_CONF },
+	{ REG_START_TEMP_READING, REG_TEMPERATURE },
+	{ REG_CALIBRATION_CTRL, REG_STATE },
+	{ REG_AUXADC_WORD_MSB, REG_AUXADC_LSB },
+	{ REG_PRODUCT_ID, REG_PRODUCT_ID },
+	{ REG_CH_1_OVERFLOW, REG_CH_2_OVERFLOW },
+	{ REG_TX_FILTER_COEF_READ_DATA_1, REG_TX_FILTER_COEF_READ_DATA_2 },
+	{ REG_TX_RSSI1, REG_TX_RSSI_LSB },
+	{ REG_TX1_OUT_1_PHASE_CORR, REG_TX2_OUT_2_OFFSET_Q },
+	{ REG_QUAD_CAL_STATUS_TX1, REG_QUAD_CAL_STATUS_TX2 },
+	{ REG_RX_FILTER_COEF_READ_DATA_1, REG_RX_FILTER_COEF_READ_DATA_2 },
+	{ REG_GAIN_TABLE_READ_DATA1, REG_GAIN_TABLE_READ_DATA3 },
+	{ REG_GM_SUB_TABLE_GAIN_READ, REG_GM_SUB_TABLE_CTRL_READ },
+	{ REG_GAIN_ERROR_READ, REG_GAIN_ERROR_READ },
+	{ REG_LNA_GAIN_DIFF_READ_BACK, REG_LNA_GAIN_DIFF_READ_BACK },
+	{ REG_CH1_ADC_POWER, REG_CH2_RX_FILTER_POWER },
+	{ REG_RX1_INPUT_A_PHASE_CORR, REG_RX2_INPUT_BC_I_OFFSET },
+	{ REG_RX1_BB_DC_WORD_I_MSB, REG_RX_PATH_GAIN_LSB },
+	{ REG_INPUT_A_MSBS, REG_INPUTS_BC_MSBS },
+	{ REG_RX1_BBF_R1A, REG_RX_BBF_TUNE },
+	{ REG_RESET, REG_RESET },
+	{ REG_RX_FORCE_ALC, REG_RX_VCO_OUTPUT },
+	{ REG_RX_CAL_STATUS, REG_RX_CAL_STATUS },
+	{ REG_RX_CP_OVERRANGE_VCO_LOCK, REG_RX_CP_OVERRANGE_VCO_LOCK },
+	{ REG_RX_FAST_LOCK_PROGRAM_READ, REG_RX_FAST_LOCK_PROGRAM_READ },
+	{ REG_TX_FORCE_ALC, REG_TX_VCO_OUTPUT },
+	{ REG_TX_CAL_STATUS, REG_TX_CAL_STATUS },
+	{ REG_TX_CP_OVERRANGE_VCO_LOCK, REG_TX_CP_OVERRANGE_VCO_LOCK },
+	{ REG_DCXO_TEMPCO_READ, REG_DCXO_TEMPCO_READ },
+	{ REG_DELTA_T_READ, REG_DELTA_T_READ },
+	{ REG_TX_FAST_LOCK_PROGRAM_READ, REG_TX_FAST_LOCK_PROGRAM_READ },
+	{ REG_GAIN_RX1, REG_OVRG_SIGS_RX2 },
+};
+
+/* Register caches, looked up by SPI descriptor (one per device) */
+static struct ad9361_regcache *ad9361_regcaches[AD9361_REGCACHE_MAX];
+
+static inline bool ad9361_regcache_test(const uint32_t *map, uint32_t reg)
+{
+	return map[reg >> 5] & (1u << (reg & 0x1F));
+}
+
+static inline void ad9361_regcache_set(uint32_t *map, uint32_t reg)
+{
+	map[reg >> 5] |= 1u << (reg & 0x1F);
+}
+
+static inline void ad9361_regcache_clr(uint32_t *map, uint32_t reg)
+{
+	map[reg >> 5] &= ~(1u << (reg & 0x1F));
+}
+
+static struct ad9361_regcache *ad9361_regcache_get(struct no_os_spi_desc *spi)
+{
+	uint32_t i;
+
+	for (i = 0; i < AD9361_REGCACHE_MAX; i++)
+		if (ad9361_regcaches[i] && ad9361_regcaches[i]->spi == spi)
+			return ad9361_regcaches[i];
+
+	return NULL;
+}
+
+/* Check if the value of reg can be taken from the cache */
+static inline bool ad9361_regcache_hit(struct ad9361_regcache *cache,
+				       uint32_t reg)
+{
+	return ad9361_regcache_test(cache->valid, reg) &&
+	       !ad9361_regcache_test(cache->volatile_map, reg);
+}
+
+/* Update the cache with num registers accessed from reg downwards */
+static void ad9361_regcache_store(struct ad9361_regcache *cache, uint32_t reg,
+				  const uint8_t *buf, uint32_t num)
+{
+	uint32_t i;
+
+	for (i = 0; i < num; i++, reg--) {
+		reg = AD_ADDR(reg);
+		if (ad9361_regcache_test(cache->volatile_map, reg))
+			continue;
+
+		cache->val[reg] = buf[i];
+		ad9361_regcache_set(cache->valid, reg);
+		ad9361_regcache_clr(cache->dirty, reg);
+	}
+}
+
+/*
+ * Write the dirty registers to the device. Consecutive registers are
+ * written with one multiple bytes access.
+ */
+static int32_t __ad9361_regcache_sync(struct ad9361_regcache *cache)
+{
+	uint8_t buf[MAX_MBYTE_SPI];
+	uint32_t reg, start, end, i;
+	int32_t ret;
+
+	if (!cache->nb_dirty)
+		return 0;
+
+	for (reg = 0; reg < AD9361_NUM_REGS; reg++) {
+		if (!ad9361_regcache_test(cache->dirty, reg))
+			continue;
+
+		start = reg;
+		end = reg;
+		while (end + 1 < AD9361_NUM_REGS &&
+		       end - start + 1 < MAX_MBYTE_SPI &&
+		       ad9361_regcache_test(cache->dirty, end + 1))
+			end++;
+
+		/* Multiple bytes accesses go from the highest address down */
+		for (i = 0; i <= end - start; i++) {
+			buf[i] = cache->val[end - i];
+			ad9361_regcache_clr(cache->dirty, end - i);
+		}
+		cache->nb_dirty -= end - start + 1;
+
+		ret = __ad9361_spi_writem(cache->spi, end, buf,
+					  end - start + 1);
+		if (ret < 0) {
+			/* The device state is unknown now */
+			ad9361_regcache_invalidate(cache->spi);
+			return ret;
+		}
+
+		reg = end;
+	}
+
+	return 0;
+}
+
+/**
+ * Allocate the register cache of a device.
+ * @param spi The SPI descriptor of the device.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_regcache_init(struct no_os_spi_desc *spi)
+{
+	struct ad9361_regcache *cache;
+	uint32_t i, reg;
+
+	for (i = 0; i < AD9361_REGCACHE_MAX; i++)
+		if (!ad9361_regcaches[i])
+			break;
+	if (i == AD9361_REGCACHE_MAX)
+		return -ENOMEM;
+
+	cache = calloc(1, sizeof(*cache));
+	if (!cache)
+		return -ENOMEM;
+
+	cache->spi = spi;
+	for (i = 0; i < NO_OS_ARRAY_SIZE(ad9361_volatile_regs); i++)
+		for (reg = ad9361_volatile_regs[i].start;
+		     reg <= ad9361_volatile_regs[i].end; reg++)
+			ad9361_regcache_set(cache->volatile_map, reg);
+
+	for (i = 0; i < AD9361_REGCACHE_MAX; i++)
+		if (!ad9361_regcaches[i]) {
+			ad9361_regcaches[i] = cache;
+			break;
+		}
+
+	return 0;
+}
+
+/**
+ * Free the register cache of a device. Pending writes are lost.
+ * @param spi The SPI descriptor of the device.
+ */
+void ad9361_regcache_remove(struct no_os_spi_desc *spi)
+{
+	uint32_t i;
+
+	for (i = 0; i < AD9361_REGCACHE_MAX; i++)
+		if (ad9361_regcaches[i] && ad9361_regcaches[i]->spi == spi) {
+			free(ad9361_regcaches[i]);
+			ad9361_regcaches[i] = NULL;
+		}
+}
+
+/**
+ * Drop all cached values. Must be called when the device is reset.
+ * @param spi The SPI descriptor of the device.
+ */
+void ad9361_regcache_invalidate(struct no_os_spi_desc *spi)
+{
+	struct ad9361_regcache *cache = ad9361_regcache_get(spi);
+
+	if (!cache)
+		return;
+
+	memset(cache->valid, 0, sizeof(cache->valid));
+	memset(cache->dirty, 0, sizeof(cache->dirty));
+	cache->nb_dirty = 0;
+}
+
+/**
+ * Write the pending (deferred) register writes to the device.
+ * @param spi The SPI descriptor of the device.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_regcache_sync(struct no_os_spi_desc *spi)
+{
+	struct ad9361_regcache *cache = ad9361_regcache_get(spi);
+
+	if (!cache)
+		return 0;
+
+	return __ad9361_regcache_sync(cache);
+}
+
+/**
+ * Enable/disable deferred writes.
+ * While enabled, writes to non volatile registers only update the cache and
+ * are sent to the device, in address order, on the next sync or on the next
+ * access that needs the device. Only the last value written to a register is
+ * sent, so registers with write side effects must not be written twice while
+ * deferring. Disabling syncs the pending writes.
+ * @param spi The SPI descriptor of the device.
+ * @param enable Enable (true), disable (false) deferred writes.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_regcache_defer(struct no_os_spi_desc *spi, bool enable)
+{
+	struct ad9361_regcache *cache = ad9361_regcache_get(spi);
+
+	if (!cache)
+		return 0;
+
+	cache->defer = enable;
+	if (enable)
+		return 0;
+
+	return __ad9361_regcache_sync(cache);
+}
+
+/**
+ * SPI multiple bytes register read.
+ * @param spi
+ * @param reg The register address.
+ * @param rbuf The data buffer.
+ * @param num The number of bytes to read.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_spi_readm(struct no_os_spi_desc *spi, uint32_t reg,
+			 uint8_t *rbuf, uint32_t num)
+{
+	struct ad9361_regcache *cache = ad9361_regcache_get(spi);
+	int32_t ret;
+
+	if (!cache)
+		return __ad9361_spi_readm(spi, reg, rbuf, num);
+
+	if (num == 1 && ad9361_regcache_hit(cache, reg)) {
+		rbuf[0] = cache->val[reg];
+		return 0;
+	}
+
+	/* Deferred writes must reach the device before it is read */
+	ret = __ad9361_regcache_sync(cache);
+	if (ret < 0)
+		return ret;
+
+	ret = __ad9361_spi_readm(spi, reg, rbuf, num);
+	if (ret < 0)
+		return ret;
+
+	ad9361_regcache_store(cache, reg, rbuf, num);
+
+	return ret;
+}
+
 /**
  * SPI register read.
  * @param spi
@@ -786,6 +1115,37 @@ static int32_t __ad9361_spi_readf(struct no_os_spi_desc *spi, uint32_t reg,
 #define ad9361_spi_readf(spi, reg, mask) \
 	__ad9361_spi_readf(spi, reg, mask, find_first_bit(mask))
 
+/**
+ * SPI multiple bytes register write.
+ * @param spi
+ * @param reg The register address.
+ * @param tbuf The data buffer.
+ * @param num The number of bytes to read.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t ad9361_spi_writem(struct no_os_spi_desc *spi,
+				 uint32_t reg, uint8_t *tbuf, uint32_t num)
+{
+	struct ad9361_regcache *cache = ad9361_regcache_get(spi);
+	int32_t ret;
+
+	if (cache) {
+		/* Keep the order with the deferred writes */
+		ret = __ad9361_regcache_sync(cache);
+		if (ret < 0)
+			return ret;
+	}
+
+	ret = __ad9361_spi_writem(spi, reg, tbuf, num);
+	if (ret < 0)
+		return ret;
+
+	if (cache)
+		ad9361_regcache_store(cache, reg, tbuf, num);
+
+	return 0;
+}
+
 /**
  * SPI register write.
  * @param spi
@@ -796,24 +1156,29 @@ static int32_t __ad9361_spi_readf(struct no_os_spi_desc *spi, uint32_t reg,
 int32_t ad9361_spi_write(struct no_os_spi_desc *spi,
 			 uint32_t reg, uint32_t val)
 {
-	uint8_t buf[3];
+	struct ad9361_regcache *cache = ad9361_regcache_get(spi);
+	uint8_t buf = val;
 	int32_t ret;
-	uint16_t cmd;
 
-	cmd = AD_WRITE | AD_CNT(1) | AD_ADDR(reg);
-	buf[0] = cmd >> 8;
-	buf[1] = cmd & 0xFF;
-	buf[2] = val;
+	reg = AD_ADDR(reg);
+	if (cache && cache->defer &&
+	    !ad9361_regcache_test(cache->volatile_map, reg)) {
+		cache->val[reg] = buf;
+		ad9361_regcache_set(cache->valid, reg);
+		if (!ad9361_regcache_test(cache->dirty, reg)) {
+			ad9361_regcache_set(cache->dirty, reg);
+			cache->nb_dirty++;
+		}
 
-	ret = no_os_spi_write_and_read(spi, buf, 3);
-	if (ret < 0) {
-		dev_err(&spi->dev, "Write Error %"PRId32, ret);
-		return ret;
+		return 0;
 	}
 
-#ifdef _DEBUG
-	dev_dbg(&spi->dev, "%s: reg 0x%"PRIX32" val 0x%X", __func__, reg, buf[2]);
-#endif
+	ret = ad9361_spi_writem(spi, reg, &buf, 1);
+	if (ret < 0)
+		return ret;
+
+	if (reg == REG_SPI_CONF && (val & SOFT_RESET))
+		ad9361_regcache_invalidate(spi);
 
 	return 0;
 }
@@ -836,6 +1201,7 @@ static int32_t __ad9361_spi_writef(struct no_os_spi_desc *spi, uint32_t reg,
 	if (!mask)
 		return -EINVAL;
 
+	/* Served from the register cache when possible */
 	ret = ad9361_spi_readm(spi, reg, &buf, 1);
 	if (ret < 0)
 		return ret;
@@ -857,52 +1223,6 @@ static int32_t __ad9361_spi_writef(struct no_os_spi_desc *spi, uint32_t reg,
 #define ad9361_spi_writef(spi, reg, mask, val) \
 	__ad9361_spi_writef(spi, reg, mask, find_first_bit(mask), val)
 
-/**
- * SPI multiple bytes register write.
- * @param spi
- * @param reg The register address.
- * @param tbuf The data buffer.
- * @param num The number of bytes to read.
- * @return 0 in case of success, negative error code otherwise.
- */
-static int32_t ad9361_spi_writem(struct no_os_spi_desc *spi,
-				 uint32_t reg, uint8_t *tbuf, uint32_t num)
-{
-	uint8_t buf[10];
-	int32_t ret;
-	uint16_t cmd;
-
-	if (num > MAX_MBYTE_SPI)
-		return -EINVAL;
-
-	cmd = AD_WRITE | AD_CNT(num) | AD_ADDR(reg);
-	buf[0] = cmd >> 8;
-	buf[1] = cmd & 0xFF;
-
-#ifndef ALTERA_PLATFORM
-	memcpy(&buf[2], tbuf, num);
-#else
-	int32_t i;
-	for (i = 0; i < num; i++)
-		buf[2 + i] =  tbuf[i];
-#endif
-	ret = no_os_spi_write_and_read(spi, buf, num + 2);
-	if (ret < 0) {
-		dev_err(&spi->dev, "Write Error %"PRId32, ret);
-		return ret;
-	}
-
-#ifdef _DEBUG
-	{
-		int32_t i;
-		for (i = 0; i < num; i++)
-			dev_dbg(&spi->dev, "Reg 0x%"PRIX32" val 0x%X", reg--, tbuf[i]);
-	}
-#endif
-
-	return 0;
-}
-
 /**
  * Validate RF BW frequency.
  * @param phy The AD9361 state structure.
@@ -1013,6 +1333,8 @@ int32_t ad9361_1rx1tx_channel_map(struct ad9361_rf_phy *phy, bool tx,
  */
 int32_t ad9361_reset(struct ad9361_rf_phy *phy)
 {
+	ad9361_regcache_invalidate(phy->spi);
+
 	if (phy->gpio_desc_resetb) {
 		no_os_gpio_set_value(phy->gpio_desc_resetb, 0);
 		no_os_mdelay(1);
@@ -1476,6 +1798,12 @@ static int32_t ad9361_load_gt(struct ad9361_rf_phy *phy, uint64_t freq,
 
 	phy->tx_quad_lpf_tia_match = -EINVAL;
 
+	/*
+	 * Address and data words go to consecutive registers. Let the cache
+	 * send them in one burst, flushed by the first dummy write.
+	 */
+	ad9361_regcache_defer(spi, true);
+
 	for (i = 0; i < index_max; i++) {
 		ad9361_spi_write(spi, REG_GAIN_TABLE_ADDRESS, i); /* Gain Table Index */
 		ad9361_spi_write(spi, REG_GAIN_TABLE_WRITE_DATA1,
@@ -1498,6 +1826,8 @@ static int32_t ad9361_load_gt(struct ad9361_rf_phy *phy, uint64_t freq,
 
 	}
 
+	ad9361_regcache_defer(spi, false);
+
 	ad9361_spi_write(spi, REG_GAIN_TABLE_CONFIG, START_GAIN_TABLE_CLOCK |
 			 RECEIVER_SELECT(dest)); /* Clear Write Bit */
 	ad9361_spi_write(spi, REG_GAIN_TABLE_READ_DATA1,
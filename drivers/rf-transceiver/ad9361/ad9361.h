@@ -2848,6 +2848,8 @@
 #define MAX_BASEBAND_RATE		61440000UL
 
 #define MAX_MBYTE_SPI			8
+#define AD9361_NUM_REGS			0x400
+#define AD9361_REGCACHE_MAX		4
 
 #define RFPLL_MODULUS			8388593UL
 #define BBPLL_MODULUS			2088960UL
@@ -3337,6 +3339,17 @@ enum dev_id {
 	ID_AD9363A
 };
 
+/* Register cache with deferred writes, see ad9361_regcache_defer() */
+struct ad9361_regcache {
+	struct no_os_spi_desc	*spi;
+	uint8_t			val[AD9361_NUM_REGS];
+	uint32_t		valid[AD9361_NUM_REGS / 32];
+	uint32_t		dirty[AD9361_NUM_REGS / 32];
+	uint32_t		volatile_map[AD9361_NUM_REGS / 32];
+	uint32_t		nb_dirty;
+	bool			defer;
+};
+
 struct ad9361_rf_phy {
 	enum dev_id		dev_sel;
 	struct no_os_spi_desc 	*spi;
@@ -3445,6 +3458,11 @@ int32_t ad9361_spi_readm(struct no_os_spi_desc *spi, uint32_t reg,
 int32_t ad9361_spi_read(struct no_os_spi_desc *spi, uint32_t reg);
 int32_t ad9361_spi_write(struct no_os_spi_desc *spi,
 			 uint32_t reg, uint32_t val);
+int32_t ad9361_regcache_init(struct no_os_spi_desc *spi);
+void ad9361_regcache_remove(struct no_os_spi_desc *spi);
+void ad9361_regcache_invalidate(struct no_os_spi_desc *spi);
+int32_t ad9361_regcache_sync(struct no_os_spi_desc *spi);
+int32_t ad9361_regcache_defer(struct no_os_spi_desc *spi, bool enable);
 int32_t ad9361_reset(struct ad9361_rf_phy *phy);
 int32_t ad9361_register_clocks(struct ad9361_rf_phy *phy);
 int32_t ad9361_unregister_clocks(struct ad9361_rf_phy *phy);
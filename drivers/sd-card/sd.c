@@ -46,6 +46,7 @@
 #include "sd.h"
 #include "no_os_delay.h"
 #include "no_os_error.h"
+#include "no_os_util.h"
 
 /******************************************************************************/
 /********************** Macros and Constants Definitions **********************/
@@ -58,11 +59,15 @@
 #define ACMD(x)				(CMD(x) | BIT_APPLICATION_CMD)
 
 #define CMD0_RETRY_NUMBER		(5u)
-#define WAIT_RESP_TIMEOUT		(1000u) //1000ms
+#define WAIT_RESP_TIMEOUT_US		(1000000u) //1000ms
+#define POLL_FAST_TRIES			(64u)
+#define POLL_DELAY_US			(10u)
+#define BUSY_POLL_LEN			(8u)
 
 #define R1_READY_STATE			(0x00u)
 #define R1_IDLE_STATE			(0x01u)
 #define R1_ILLEGAL_COMMAND		(0x04u)
+#define R1_ERROR_MASK			(0xFEu)
 
 #define R1_LEN				(1u)
 #define R2_LEN				(2u)
@@ -75,6 +80,7 @@
 #define STUFF_ARG			(0x00000000u)
 #define CMD8_ARG			(0x000001AAu)
 #define ACMD41_ARG			(0x40000000u)
+#define ACMD23_ARG_MASK			(0x007FFFFFu)
 
 #define DATA_BLOCK_BITS			(9u)
 #define MASK_ADDR_IN_BLOCK		(DATA_BLOCK_LEN - 1u)
@@ -91,6 +97,26 @@
 /************************ Functions Definitions *******************************/
 /******************************************************************************/
 
+/**
+ * Wait between two polls of the SD card. The first POLL_FAST_TRIES polls are
+ * done back to back, since most responses arrive within a few bytes.
+ * @param tries		- Number of polls done so far
+ * @param waited_us	- Time waited so far, updated by this function
+ * @return true if the timeout was not reached, false otherwise.
+ */
+static bool poll_wait(uint32_t tries, uint32_t *waited_us)
+{
+	if (tries < POLL_FAST_TRIES)
+		return true;
+	if (*waited_us >= WAIT_RESP_TIMEOUT_US)
+		return false;
+
+	no_os_udelay(POLL_DELAY_US);
+	*waited_us += POLL_DELAY_US;
+
+	return true;
+}
+
 /**
  * Read SD card bytes until one is different from 0xFF
  * @param sd_desc	- Instance of the SD card
@@ -99,50 +125,43 @@
  */
 static int32_t wait_for_response(struct sd_desc *sd_desc, uint8_t *data_out)
 {
-	uint32_t	not_timeout;
-	int32_t		ret;
+	uint32_t	waited_us = 0;
+	uint32_t	tries = 0;
 
-	ret = -1;
-	not_timeout = WAIT_RESP_TIMEOUT;
 	do {
+		*data_out = 0xFF;
 		if (0 != no_os_spi_write_and_read(sd_desc->spi_desc,
 						  data_out, 1))
-			break;
-		if (*data_out != 0xFF) {
-			ret = 0;
-			break;
-		}
-		no_os_mdelay(1);
-	} while (not_timeout--);
+			return -1;
+		if (*data_out != 0xFF)
+			return 0;
+	} while (poll_wait(tries++, &waited_us));
 
-	return ret;
+	return -1;
 }
 
 /**
- * Read SD card bytes until one is different from 0x00
+ * Read SD card bytes until one is different from 0x00. Bytes are read
+ * BUSY_POLL_LEN at a time, the card keeps the line high once it is ready.
  * @param sd_desc - Instance of the SD card
  * @return 0 in case of success, -1 otherwise.
  */
 static int32_t wait_until_not_busy(struct sd_desc *sd_desc)
 {
-	uint32_t	not_timeout;
-	int32_t		ret;
-	uint8_t		data;
+	uint8_t		data[BUSY_POLL_LEN];
+	uint32_t	waited_us = 0;
+	uint32_t	tries = 0;
 
-	ret = -1;
-	not_timeout = WAIT_RESP_TIMEOUT;
 	do {
-		data = 0xFF;
-		if (0 != no_os_spi_write_and_read(sd_desc->spi_desc, &data, 1))
-			break;
-		if (data != 0x00) {
-			ret = 0;
-			break;
-		}
-		no_os_mdelay(1);
-	} while (not_timeout--);
+		memset(data, 0xFF, BUSY_POLL_LEN);
+		if (0 != no_os_spi_write_and_read(sd_desc->spi_desc, data,
+						  BUSY_POLL_LEN))
+			return -1;
+		if (data[BUSY_POLL_LEN - 1] != 0x00)
+			return 0;
+	} while (poll_wait(tries++, &waited_us));
 
-	return ret;
+	return -1;
 }
 
 /**
@@ -175,7 +194,7 @@ static int32_t send_command(struct sd_desc *sd_desc, struct cmd_desc *cmd_desc)
 		cmd_desc_local.response_len = R1_LEN;
 		if (0 != send_command(sd_desc, &cmd_desc_local))
 			return -1;
-		if (cmd_desc_local.response[0] != R1_IDLE_STATE) {
+		if (cmd_desc_local.response[0] & R1_ERROR_MASK) {
 			DEBUG_MSG("Not the expected response for CMD55\n");
 			return -1;
 		}
@@ -214,15 +233,16 @@ static int32_t send_command(struct sd_desc *sd_desc, struct cmd_desc *cmd_desc)
  * Send one block of data to the SD card
  * @param sd_desc	- Instance of the SD card
  * @param data		- Data to be written
- * @param nb_of_blocks	- Number of blocks written in the executing command
+ * @param multiple	- true if the block is part of a write multiple block
+ * 			  command
  * @return 0 in case of success, -1 otherwise.
  */
 static int32_t write_block(struct sd_desc *sd_desc, uint8_t *data,
-			   uint32_t nb_of_blocks)
+			   bool multiple)
 {
 	/* Send start block token */
 	sd_desc->buff[0] = START_N_BLOCK_TOKEN;
-	if (nb_of_blocks == 1)
+	if (!multiple)
 		sd_desc->buff[0] = START_1_BLOCK_TOKEN;
 	if (0 != no_os_spi_write_and_read(sd_desc->spi_desc, sd_desc->buff, 1))
 		return -1;
@@ -342,16 +362,16 @@ static int32_t write_multiple_blocks(struct sd_desc *sd_desc,
 			buff_copy_len = ((addr + len - 1) & MASK_ADDR_IN_BLOCK) - buff_first_idx + 1;
 		if (buff_first_idx == 0x0000u && buff_copy_len == DATA_BLOCK_LEN) {
 			/* Write every block beside the first and last if the write is not the entire block */
-			if (0 != write_block(sd_desc, data + data_idx, nb_of_blocks))
+			if (0 != write_block(sd_desc, data + data_idx, nb_of_blocks > 1))
 				return -1;
 		} else {			/* If we are not writing a full block */
 			if (i == 0) {		/* If is the first block */
 				memcpy(first_block + buff_first_idx, data + data_idx, buff_copy_len);
-				if (0 != write_block(sd_desc, first_block, nb_of_blocks))
+				if (0 != write_block(sd_desc, first_block, nb_of_blocks > 1))
 					return -1;
 			} else {		/* Is the last block */
 				memcpy(last_block, data + data_idx, buff_copy_len);
-				if (0 != write_block(sd_desc, last_block, nb_of_blocks))
+				if (0 != write_block(sd_desc, last_block, nb_of_blocks > 1))
 					return -1;
 			}
 		}
@@ -405,6 +425,151 @@ static int32_t read_multiple_blocks(struct sd_desc *sd_desc,
 	return 0;
 }
 
+/**
+ * Close the write multiple block session, if one is open
+ * @param sd_desc	- Instance of the SD card
+ * @return 0 in case of success, -1 otherwise.
+ */
+static int32_t stream_close(struct sd_desc *sd_desc)
+{
+	if (!sd_desc->stream_open)
+		return 0;
+
+	sd_desc->stream_open = false;
+
+	/* Send stop transmission token */
+	sd_desc->buff[0] = STOP_TRANSMISSION_TOKEN;
+	sd_desc->buff[1] = 0xFF;
+	if (0 != no_os_spi_write_and_read(sd_desc->spi_desc, sd_desc->buff, 2))
+		return -1;
+
+	return wait_until_not_busy(sd_desc);
+}
+
+/**
+ * Open a write multiple block session. ACMD23 is sent first so the card can
+ * pre-erase the blocks about to be written. Inside the preallocated area the
+ * blocks up to its end are pre-erased, since the caller declared it is going
+ * to write them.
+ * @param sd_desc	- Instance of the SD card
+ * @param block		- First block to be written
+ * @param nb_of_blocks	- Number of blocks known to follow
+ * @return 0 in case of success, -1 otherwise.
+ */
+static int32_t stream_open(struct sd_desc *sd_desc, uint64_t block,
+			   uint32_t nb_of_blocks)
+{
+	struct cmd_desc	cmd_desc;
+	uint64_t	nb_erase = nb_of_blocks;
+
+	if (block >= sd_desc->prealloc_start && block < sd_desc->prealloc_end)
+		nb_erase = no_os_max(nb_erase, sd_desc->prealloc_end - block);
+
+	cmd_desc.cmd = ACMD(23);
+	cmd_desc.arg = no_os_min(nb_erase, ACMD23_ARG_MASK);
+	cmd_desc.response_len = R1_LEN;
+	if (0 != send_command(sd_desc, &cmd_desc))
+		return -1;
+	if (cmd_desc.response[0] != R1_READY_STATE) {
+		DEBUG_MSG("Failed to set pre-erase block count\n");
+		return -1;
+	}
+
+	cmd_desc.cmd = CMD(25);
+	cmd_desc.arg = block;
+	cmd_desc.response_len = R1_LEN;
+	if (0 != send_command(sd_desc, &cmd_desc))
+		return -1;
+	if (cmd_desc.response[0] != R1_READY_STATE) {
+		DEBUG_MSG("Failed to write Data command\n");
+		return -1;
+	}
+
+	sd_desc->stream_open = true;
+	sd_desc->stream_next_block = block;
+
+	return 0;
+}
+
+/**
+ * Write whole blocks using the write multiple block session. The session is
+ * kept open after the write, so a write continuing at the next block doesn't
+ * need a new command. It is closed by sd_sync(), by a read or by a write to
+ * another address.
+ * @param sd_desc	- Instance of the SD card
+ * @param data		- Data to write
+ * @param block		- First block to be written
+ * @param nb_of_blocks	- Number of blocks to be written
+ * @return 0 in case of success, -1 otherwise.
+ */
+static int32_t stream_write(struct sd_desc *sd_desc, uint8_t *data,
+			    uint64_t block, uint32_t nb_of_blocks)
+{
+	uint32_t	i;
+
+	if (!sd_desc->stream_open || sd_desc->stream_next_block != block) {
+		if (0 != stream_close(sd_desc))
+			return -1;
+		if (0 != stream_open(sd_desc, block, nb_of_blocks))
+			return -1;
+	}
+
+	for (i = 0; i < nb_of_blocks; i++) {
+		if (0 != write_block(sd_desc, data + i * DATA_BLOCK_LEN, true)) {
+			sd_desc->stream_open = false;
+			return -1;
+		}
+		sd_desc->stream_next_block++;
+	}
+
+	/* Blocks of the preallocated area are pre-erased only once */
+	if (block < sd_desc->prealloc_end &&
+	    sd_desc->stream_next_block > sd_desc->prealloc_start)
+		sd_desc->prealloc_start = no_os_min(sd_desc->stream_next_block,
+						    sd_desc->prealloc_end);
+
+	return 0;
+}
+
+/**
+ * Finish the pending write multiple block session, if any. Should be called
+ * before the card is removed or powered down.
+ * @param sd_desc	- Instance of the SD card
+ * @return 0 in case of success, -1 otherwise.
+ */
+int32_t sd_sync(struct sd_desc *sd_desc)
+{
+	if (!sd_desc)
+		return -1;
+
+	return stream_close(sd_desc);
+}
+
+/**
+ * Declare the blocks the caller is going to write one after the other, e.g.
+ * data already buffered for a contiguous file. A write session opened inside
+ * the area pre-erases the blocks up to its end, so it must only hold blocks
+ * that will be written. Only one area is kept; a len of 0 removes it.
+ * @param sd_desc	- Instance of the SD card
+ * @param address	- Start address of the area, multiple of the block size
+ * @param len		- Length of the area in bytes, multiple of the block size
+ * @return 0 in case of success, -1 otherwise.
+ */
+int32_t sd_set_prealloc(struct sd_desc *sd_desc, uint64_t address,
+			uint64_t len)
+{
+	if (!sd_desc || (address & MASK_ADDR_IN_BLOCK) ||
+	    (len & MASK_ADDR_IN_BLOCK) || address + len > sd_desc->memory_size)
+		return -1;
+
+	sd_desc->prealloc_start = address >> DATA_BLOCK_BITS;
+	sd_desc->prealloc_end = (address + len) >> DATA_BLOCK_BITS;
+	if (!len)
+		sd_desc->prealloc_start = sd_desc->prealloc_end = 0;
+
+	return 0;
+}
+
 /**
  * Read data of size len from the specified address and store it in data.
  * This operation returns only when the read is complete
@@ -425,6 +590,9 @@ int32_t sd_read(struct sd_desc *sd_desc,
 	    address + len > sd_desc->memory_size)
 		return -1;
 
+	if (0 != stream_close(sd_desc))
+		return -1;
+
 	/* Send read command */
 	cmd_desc.cmd = (get_nb_of_blocks(address, len) == 1) ? CMD(17): CMD(18);
 	cmd_desc.arg = address >> DATA_BLOCK_BITS;;
@@ -477,6 +645,16 @@ int32_t sd_write(struct sd_desc *sd_desc, uint8_t *data, uint64_t address,
 	    len > sd_desc->memory_size || address + len > sd_desc->memory_size)
 		return -1;
 
+	/* Whole blocks written as one sequence go through the open session */
+	if ((address & MASK_ADDR_IN_BLOCK) == 0 &&
+	    (len & MASK_ADDR_IN_BLOCK) == 0 &&
+	    (sd_desc->stream_open || len > DATA_BLOCK_LEN))
+		return stream_write(sd_desc, data, address >> DATA_BLOCK_BITS,
+				    len >> DATA_BLOCK_BITS);
+
+	if (0 != stream_close(sd_desc))
+		return -1;
+
 	/* Read first and last block in memory if needed to be updated with user data and then written back                                                                        */
 	/* If not writing from the beginning of a block or */
 	if ((address & MASK_ADDR_IN_BLOCK) != 0 ||
@@ -641,6 +819,7 @@ int32_t sd_remove(struct sd_desc *desc)
 	if (desc == NULL)
 		return -1;
 
+	stream_close(desc);
 	free(desc);
 	return 0;
 }
@@ -100,6 +100,14 @@ struct sd_desc {
 	uint8_t		high_capacity;
 	/** Buffer used for the driver implementation */
 	uint8_t		buff[18];
+	/** First block of the preallocated area not written yet */
+	uint64_t	prealloc_start;
+	/** Block following the preallocated area, 0 if there is none */
+	uint64_t	prealloc_end;
+	/** true while a write multiple block session is open */
+	bool		stream_open;
+	/** Block expected by the open write session */
+	uint64_t	stream_next_block;
 };
 
 /**
@@ -132,6 +140,10 @@ int32_t sd_write(struct sd_desc *desc,
 		 uint8_t *data,
 		 uint64_t address,
 		 uint64_t len);
+int32_t sd_sync(struct sd_desc *desc);
+int32_t sd_set_prealloc(struct sd_desc *desc,
+			uint64_t address,
+			uint64_t len);
 
 #endif /* __SD_H__ */
 
@@ -54,8 +54,11 @@
 #include "no_os_uart.h"
 #include "no_os_error.h"
 #include "no_os_circular_buffer.h"
+#include "no_os_spsc_ring.h"
 #include <inttypes.h>
+#include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #ifdef ENABLE_IIO_NETWORK
@@ -71,6 +74,15 @@
 #define MAX_SOCKET_TO_HANDLE	10
 #define REG_ACCESS_ATTRIBUTE	"direct_reg_access"
 #define IIOD_CONN_BUFFER_SIZE	0x1000
+#define IIO_CH_ID_SIZE		IIOD_NAME_MAX
+#define FNV_OFFSET_BASIS	2166136261u
+#define FNV_PRIME		16777619u
+/* Big enough for any xml element, except for very long names */
+#define IIO_XML_TMP_SIZE	128
+/* Upper limit of the blocks allocated per device buffer */
+#define IIO_MAX_BUFFERS_COUNT	16
+/* Events queued per device. Power of 2 */
+#define IIO_EVENTS_FIFO_SIZE	16
 
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
@@ -102,6 +114,26 @@ static char header[] =
 	"<context-attribute name=\"no-OS\" value=\"1.1.0-g0000000\" />";
 static char header_end[] = "</context>";
 
+/* Linux numbering of the channel types, used by clients to decode events */
+static const uint8_t iio_chan_type_code[] = {
+	[IIO_VOLTAGE] = 0,
+	[IIO_CURRENT] = 1,
+	[IIO_ALTVOLTAGE] = 15,
+	[IIO_ANGL_VEL] = 4,
+	[IIO_TEMP] = 9,
+	[IIO_CAPACITANCE] = 14,
+	[IIO_ACCEL] = 3,
+	[IIO_TIMESTAMP] = 13,
+};
+
+/* Linux numbering of the modifiers, used by clients to decode events */
+static const uint8_t iio_modifier_code[] = {
+	[IIO_NO_MOD] = 0,
+	[IIO_MOD_X] = 1,
+	[IIO_MOD_Y] = 2,
+	[IIO_MOD_Z] = 3,
+};
+
 static const char * const iio_chan_type_string[] = {
 	[IIO_VOLTAGE] = "voltage",
 	[IIO_CURRENT] = "current",
@@ -110,6 +142,7 @@ static const char * const iio_chan_type_string[] = {
 	[IIO_TEMP] = "temp",
 	[IIO_CAPACITANCE] = "capacitance",
 	[IIO_ACCEL] = "accel",
+	[IIO_TIMESTAMP] = "timestamp",
 };
 
 static const char * const iio_modifier_names[] = {
@@ -118,6 +151,15 @@ static const char * const iio_modifier_names[] = {
 	[IIO_MOD_Z] = "z",
 };
 
+/* Renders the part of the xml that falls in [start, start + len) */
+struct iio_xml_writer {
+	char		*buf;
+	uint32_t	start;
+	uint32_t	len;
+	/* Offset in the xml of the next character */
+	uint32_t	pos;
+};
+
 /* Parameters used in show and store functions */
 struct attr_fun_params {
 	void			*dev_instance;
@@ -139,6 +181,16 @@ struct iio_buffer_priv {
 	bool			initalized;
 	/* Set when calloc was used to initalize cb.buf */
 	bool			allocated;
+	/* Set once the block of a cyclic buffer was pushed to the device */
+	bool			cyclic_loaded;
+	/* Number of blocks requested with SET BUFFERS_COUNT */
+	uint32_t		nb_blocks;
+	/* Number of blocks the circular buffer holds */
+	uint32_t		nb_blocks_alloc;
+	/* Set when blocks are captured in advance, between requests */
+	bool			prefetch;
+	/* Scans pushed from the trigger interrupt. Allocated when enabled */
+	struct no_os_spsc_ring	trig_ring;
 };
 
 /**
@@ -149,6 +201,10 @@ struct iio_buffer_priv {
 struct iio_dev_priv {
 	/** Will be: iio:device[0...n] n beeing the count of registerd devices*/
 	char			dev_id[21];
+	/** Channel ids, rendered once at init. Same order as channels */
+	char			(*ch_ids)[IIO_CH_ID_SIZE];
+	/** Size of the xml describing the device */
+	uint32_t		xml_size;
 	/** Device name */
 	const char		*name;
 	/** Physical instance of a device */
@@ -161,16 +217,47 @@ struct iio_dev_priv {
 	struct iio_device	*dev_descriptor;
 	/* Structure storing buffer related fields */
 	struct iio_buffer_priv buffer;
+	/** Index in devs of the trigger used by the device, -1 if none */
+	int32_t			trig_idx;
+	/** Set while the trigger handler may be called from interrupt */
+	volatile bool		trig_enabled;
+	/** Trigger callbacks. Only set for triggers */
+	struct iio_trigger	*trig_descriptor;
+	/** Number of enabled buffers using the trigger */
+	uint32_t		trig_users;
+	/** Event FIFO. Only allocated if channels have event specs */
+	struct no_os_spsc_ring	events;
+	/** Connection reading the events, NULL if events are not queued */
+	void * volatile		ev_conn;
+};
+
+/* Entry of the attribute lookup table. Empty when attr is NULL */
+struct iio_attr_entry {
+	uint32_t		hash;
+	struct iio_attribute	*attr;
+	struct iio_channel	*ch;
+	uint16_t		dev_idx;
+	uint8_t			type;
 };
 
 struct iio_desc {
 	struct iiod_desc	*iiod;
 	struct iiod_ops		iiod_ops;
 	void			*phy_desc;
-	char			*xml_desc;
+	/* Size of the context xml. It is rendered when requested */
 	uint32_t		xml_size;
 	struct iio_dev_priv	*devs;
+	/* Devices followed by triggers */
 	uint32_t		nb_devs;
+	uint32_t		nb_trigs;
+	/* Descriptors holding the attributes of the triggers */
+	struct iio_device	*trig_devs;
+	/* Clock of the timestamp channels */
+	int32_t (*get_timestamp)(void *ctx, uint64_t *ns);
+	void			*timestamp_ctx;
+	/* Open addressing hash of all attributes. Size is a power of 2 */
+	struct iio_attr_entry	*attr_table;
+	uint32_t		attr_table_mask;
 	struct no_os_uart_desc	*uart_desc;
 	int (*recv)(void *conn, uint8_t *buf, uint32_t len);
 	int (*send)(void *conn, uint8_t *buf, uint32_t len);
@@ -250,19 +337,18 @@ static inline void _print_ch_id(char *buff, struct iio_channel *ch)
 /**
  * @brief Get channel ID from a list of channels.
  * @param channel - Channel name.
- * @param desc - Device descriptor
+ * @param dev - Device whose channels are searched.
  * @param ch_out - If "true" is output channel, if "false" is input channel.
  * @return Channel ID, or negative value if attribute is not found.
  */
 static inline struct iio_channel *iio_get_channel(const char *channel,
-		struct iio_device *desc, bool ch_out)
+		struct iio_dev_priv *dev, bool ch_out)
 {
+	struct iio_device *desc = dev->dev_descriptor;
 	int16_t i = 0;
-	char	ch_id[64];
 
 	while (i < desc->num_ch) {
-		_print_ch_id(ch_id, &desc->channels[i]);
-		if (!strcmp(channel, ch_id) &&
+		if (!strcmp(channel, dev->ch_ids[i]) &&
 		    (desc->channels[i].ch_out == ch_out))
 			return &desc->channels[i];
 		i++;
@@ -280,11 +366,112 @@ static inline struct iio_channel *iio_get_channel(const char *channel,
 static struct iio_dev_priv *get_iio_device(struct iio_desc *desc,
 		const char *device_name)
 {
+	const char *prefix = "iio:device";
+	uint32_t nb = desc->nb_devs - desc->nb_trigs;
+	uint32_t first = 0;
+	uint32_t len;
+	char *end;
 	uint32_t i;
 
-	for (i = 0; i < desc->nb_devs; i++) {
-		if (strcmp(desc->devs[i].dev_id, device_name) == 0)
-			return &desc->devs[i];
+	/* Ids are "iio:device<index>" or "trigger<index>", no need to search */
+	if (device_name[0] == 't') {
+		prefix = "trigger";
+		first = nb;
+		nb = desc->nb_trigs;
+	}
+
+	len = strlen(prefix);
+	if (strncmp(device_name, prefix, len))
+		return NULL;
+
+	i = strtoul(device_name + len, &end, 10);
+	if (end == device_name + len || *end != '\0' || i >= nb)
+		return NULL;
+
+	return &desc->devs[first + i];
+}
+
+/**
+ * @brief Find a trigger by id or by name.
+ * @param desc - IIO descriptor.
+ * @param trigger - Id or name of the trigger.
+ * @return Index of the trigger in devs or negative value if not found.
+ */
+static int32_t iio_find_trigger(struct iio_desc *desc, const char *trigger)
+{
+	struct iio_dev_priv *dev;
+	uint32_t i;
+
+	dev = get_iio_device(desc, trigger);
+	if (dev && dev->trig_descriptor)
+		return dev - desc->devs;
+
+	for (i = desc->nb_devs - desc->nb_trigs; i < desc->nb_devs; i++)
+		if (desc->devs[i].name && !strcmp(desc->devs[i].name, trigger))
+			return i;
+
+	return -ENODEV;
+}
+
+/* FNV-1a of a string, including the terminator as separator */
+static uint32_t iio_hash_str(uint32_t hash, const char *str)
+{
+	do {
+		hash ^= (uint8_t)*str;
+		hash *= FNV_PRIME;
+	} while (*str++);
+
+	return hash;
+}
+
+static uint32_t iio_attr_hash(uint32_t dev_idx, enum iio_attr_type type,
+			      const char *channel, const char *name)
+{
+	uint32_t hash = FNV_OFFSET_BASIS;
+
+	hash = (hash ^ dev_idx) * FNV_PRIME;
+	hash = (hash ^ type) * FNV_PRIME;
+	hash = iio_hash_str(hash, channel ? channel : "");
+
+	return iio_hash_str(hash, name);
+}
+
+/**
+ * @brief Find an attribute in the lookup table.
+ * @param desc - IIO descriptor.
+ * @param dev - Device of the attribute.
+ * @param type - Attribute type.
+ * @param channel - Channel id for channel attributes, NULL otherwise.
+ * @param name - Attribute name.
+ * @return Table entry or NULL if the attribute is not found.
+ */
+static struct iio_attr_entry *iio_find_attr(struct iio_desc *desc,
+		struct iio_dev_priv *dev, enum iio_attr_type type,
+		const char *channel, const char *name)
+{
+	struct iio_attr_entry *entry;
+	uint32_t dev_idx = dev - desc->devs;
+	uint32_t hash, i;
+
+	if (type == IIO_ATTR_TYPE_CH_IN || type == IIO_ATTR_TYPE_CH_OUT) {
+		if (!channel)
+			return NULL;
+	} else {
+		channel = NULL;
+	}
+
+	hash = iio_attr_hash(dev_idx, type, channel, name);
+	for (i = hash & desc->attr_table_mask; desc->attr_table[i].attr;
+	     i = (i + 1) & desc->attr_table_mask) {
+		entry = &desc->attr_table[i];
+		if (entry->hash != hash || entry->dev_idx != dev_idx ||
+		    entry->type != type || strcmp(entry->attr->name, name))
+			continue;
+		if (entry->ch && strcmp(channel, dev->ch_ids[entry->ch -
+					dev->dev_descriptor->channels]))
+			continue;
+
+		return entry;
 	}
 
 	return NULL;
@@ -384,42 +571,28 @@ static int iio_write_all_attr(struct attr_fun_params *params,
 /**
  * @brief Read/write attribute.
  * @param params - Structure describing parameters for store and show functions
- * @param attributes - Array of attributes.
- * @param attr_name - Attribute name to be modified
+ * @param attribute - Attribute to be accessed.
  * @param is_write -If it has value "1", writes attribute, otherwise reads
  * 		attribute.
  * @return Length of chars written/read or negative value in case of error.
  */
 static int iio_rd_wr_attribute(struct attr_fun_params *params,
-			       struct iio_attribute *attributes,
-			       const char *attr_name,
+			       struct iio_attribute *attribute,
 			       bool is_write)
 {
-	int16_t i = 0;
-
-	/* Search attribute */
-	while (attributes[i].name) {
-		if (!strcmp(attr_name, attributes[i].name))
-			break;
-		i++;
-	}
-
-	if (!attributes[i].name)
-		return -ENOENT;
-
 	if (is_write) {
-		if (!attributes[i].store)
+		if (!attribute->store)
 			return -ENOENT;
 
-		return attributes[i].store(params->dev_instance, params->buf,
-					   params->len, params->ch_info,
-					   attributes[i].priv);
+		return attribute->store(params->dev_instance, params->buf,
+					params->len, params->ch_info,
+					attribute->priv);
 	} else {
-		if (!attributes[i].show)
+		if (!attribute->show)
 			return -ENOENT;
-		return attributes[i].show(params->dev_instance, params->buf,
-					  params->len, params->ch_info,
-					  attributes[i].priv);
+		return attribute->show(params->dev_instance, params->buf,
+				       params->len, params->ch_info,
+				       attribute->priv);
 	}
 }
 
@@ -644,6 +817,7 @@ static int iio_read_attr(struct iiod_ctx *ctx, const char *device,
 	struct iio_channel *ch = NULL;
 	struct attr_fun_params params;
 	struct iio_attribute *attributes;
+	struct iio_attr_entry *entry = NULL;
 	int8_t ch_out;
 
 	dev = get_iio_device(ctx->instance, device);
@@ -658,12 +832,20 @@ static int iio_read_attr(struct iiod_ctx *ctx, const char *device,
 			return -ENOENT;
 	}
 
-	if (attr->channel) {
-		ch_out = attr->type == IIO_ATTR_TYPE_CH_OUT ? 1 : 0;
-		ch = iio_get_channel(attr->channel, dev->dev_descriptor,
-				     ch_out);
+	ch_out = attr->type == IIO_ATTR_TYPE_CH_OUT ? 1 : 0;
+	if (attr->name[0]) {
+		entry = iio_find_attr(ctx->instance, dev, attr->type,
+				      attr->channel, attr->name);
+		if (!entry)
+			return -ENOENT;
+		ch = entry->ch;
+	} else if (attr->channel) {
+		ch = iio_get_channel(attr->channel, dev, ch_out);
 		if (!ch)
 			return -ENOENT;
+	}
+
+	if (ch) {
 		ch_info.ch_out = ch_out;
 		ch_info.ch_num = ch->channel;
 		ch_info.type = ch->ch_type;
@@ -677,11 +859,12 @@ static int iio_read_attr(struct iiod_ctx *ctx, const char *device,
 	params.buf = buf;
 	params.len = len;
 	params.dev_instance = dev->dev_instance;
+	if (entry)
+		return iio_rd_wr_attribute(&params, entry->attr, 0);
+
 	attributes = get_attributes(attr->type, dev, ch);
-	if (!strcmp(attr->name, ""))
-		return iio_read_all_attr(&params, attributes);
-	else
-		return iio_rd_wr_attribute(&params, attributes, attr->name, 0);
+
+	return iio_read_all_attr(&params, attributes);
 }
 
 /**
@@ -701,6 +884,7 @@ static int iio_write_attr(struct iiod_ctx *ctx, const char *device,
 	struct iio_attribute	*attributes;
 	struct iio_ch_info ch_info;
 	struct iio_channel *ch = NULL;
+	struct iio_attr_entry *entry = NULL;
 	int8_t ch_out;
 
 	dev = get_iio_device(ctx->instance, device);
@@ -715,13 +899,20 @@ static int iio_write_attr(struct iiod_ctx *ctx, const char *device,
 			return -ENOENT;
 	}
 
-	if (attr->channel) {
-		ch_out = attr->type == IIO_ATTR_TYPE_CH_OUT ? 1 : 0;
-		ch = iio_get_channel(attr->channel, dev->dev_descriptor,
-				     ch_out);
+	ch_out = attr->type == IIO_ATTR_TYPE_CH_OUT ? 1 : 0;
+	if (attr->name[0]) {
+		entry = iio_find_attr(ctx->instance, dev, attr->type,
+				      attr->channel, attr->name);
+		if (!entry)
+			return -ENOENT;
+		ch = entry->ch;
+	} else if (attr->channel) {
+		ch = iio_get_channel(attr->channel, dev, ch_out);
 		if (!ch)
 			return -ENOENT;
+	}
 
+	if (ch) {
 		ch_info.ch_out = ch_out;
 		ch_info.ch_num = ch->channel;
 		ch_info.type = ch->ch_type;
@@ -735,11 +926,12 @@ static int iio_write_attr(struct iiod_ctx *ctx, const char *device,
 	params.buf = (char *)buf;
 	params.len = len;
 	params.dev_instance = dev->dev_instance;
+	if (entry)
+		return iio_rd_wr_attribute(&params, entry->attr, 1);
+
 	attributes = get_attributes(attr->type, dev, ch);
-	if (!strcmp(attr->name, ""))
-		return iio_write_all_attr(&params, attributes);
-	else
-		return iio_rd_wr_attribute(&params, attributes, attr->name, 1);
+
+	return iio_write_all_attr(&params, attributes);
 }
 
 static uint32_t bytes_per_scan(struct iio_channel *channels, uint32_t mask)
@@ -758,19 +950,296 @@ static uint32_t bytes_per_scan(struct iio_channel *channels, uint32_t mask)
 	return cnt;
 }
 
+/* Mask of the channels that can be enabled, at most the first 32 */
+static uint32_t iio_channels_mask(struct iio_device *dev)
+{
+	if (!dev->num_ch)
+		return 0;
+
+	return NO_OS_GENMASK(no_os_min(dev->num_ch, 32) - 1, 0);
+}
+
+/* Mask of the timestamp channel, 0 if the device doesn't have one */
+static uint32_t iio_timestamp_mask(struct iio_device *dev)
+{
+	/* It has to be the last channel, one that can be enabled */
+	if (!dev->channels || !dev->num_ch || dev->num_ch > 32 ||
+	    dev->channels[dev->num_ch - 1].ch_type != IIO_TIMESTAMP)
+		return 0;
+
+	return NO_OS_BIT(dev->num_ch - 1);
+}
+
+/*
+ * The core only adds the timestamp to scans it handles: the ones pushed by the
+ * trigger handler and the blocks of read_dev. Blocks filled by submit, e.g. by
+ * DMA, have no room for it.
+ */
+static bool iio_fills_timestamp(struct iio_dev_priv *dev)
+{
+	return dev->trig_idx >= 0 || !dev->dev_descriptor->submit;
+}
+
+/*
+ * Size of a scan with the channels in mask. The timestamp is aligned to its
+ * size, as clients expect. ts_size is set to the bytes added for it.
+ */
+static uint32_t iio_scan_size(struct iio_device *dev, uint32_t mask,
+			      uint32_t *ts_size)
+{
+	uint32_t ts_mask = iio_timestamp_mask(dev);
+	uint32_t size;
+
+	size = bytes_per_scan(dev->channels, mask & ~ts_mask);
+	*ts_size = 0;
+	if (mask & ts_mask)
+		*ts_size = sizeof(int64_t) +
+			   (sizeof(int64_t) - size % sizeof(int64_t)) %
+			   sizeof(int64_t);
+
+	return size + *ts_size;
+}
+
+/* Current time of the timestamp clock in ns, 0 if there is none */
+static int64_t iio_get_timestamp(struct iio_desc *desc)
+{
+	uint64_t ns;
+
+	if (!desc->get_timestamp ||
+	    NO_OS_IS_ERR_VALUE(desc->get_timestamp(desc->timestamp_ctx, &ns)))
+		return 0;
+
+	return ns;
+}
+
+/**
+ * @brief Resolve indexes of the binary protocol into names.
+ * @param ctx - IIO instance and conn instance
+ * @param dev_idx - Index of the device.
+ * @param chn_idx - Index of the channel or -1 for device level attributes.
+ * @param attr_idx - Index of the attribute or -1 if not needed.
+ * @param type - Type of the attribute.
+ * @param names - Where the names are stored.
+ * @return 0 in case of success or negative value otherwise.
+ */
+static int iio_get_names(struct iiod_ctx *ctx, uint32_t dev_idx,
+			 int32_t chn_idx, int32_t attr_idx,
+			 enum iio_attr_type type, struct iiod_names *names)
+{
+	struct iio_desc *desc = ctx->instance;
+	struct iio_attribute *attributes;
+	struct iio_channel *ch = NULL;
+	struct iio_dev_priv *dev;
+	int32_t i;
+
+	if (dev_idx >= desc->nb_devs)
+		return -ENODEV;
+
+	dev = &desc->devs[dev_idx];
+	strcpy(names->device, dev->dev_id);
+	names->channel[0] = '\0';
+	names->ch_out = false;
+	names->nb_channels = dev->dev_descriptor->num_ch;
+	names->attr = NULL;
+
+	if (chn_idx >= 0) {
+		if (!dev->dev_descriptor->channels ||
+		    chn_idx >= dev->dev_descriptor->num_ch)
+			return -ENOENT;
+
+		ch = &dev->dev_descriptor->channels[chn_idx];
+		strcpy(names->channel, dev->ch_ids[chn_idx]);
+		names->ch_out = ch->ch_out;
+	}
+
+	if (attr_idx < 0)
+		return 0;
+
+	/* Attributes are indexed in the order they appear in the XML */
+	attributes = get_attributes(type, dev, ch);
+	for (i = 0; attributes && attributes[i].name; i++)
+		if (i == attr_idx) {
+			names->attr = attributes[i].name;
+			return 0;
+		}
+
+	if (type == IIO_ATTR_TYPE_DEBUG && i == attr_idx &&
+	    (dev->dev_descriptor->debug_reg_read ||
+	     dev->dev_descriptor->debug_reg_write)) {
+		names->attr = REG_ACCESS_ATTRIBUTE;
+		return 0;
+	}
+
+	return -ENOENT;
+}
+
+/**
+ * @brief Get the buffer layout for a channel mask.
+ * @param ctx - IIO instance and conn instance
+ * @param device - String containing device name.
+ * @param mask - Channels to be used.
+ * @param scan_size - Size in bytes of a sample for all channels in mask.
+ * @param is_output - Set if the channels in mask are output channels.
+ * @return 0 in case of success or negative value otherwise.
+ */
+static int iio_get_buffer_info(struct iiod_ctx *ctx, const char *device,
+			       uint32_t mask, uint32_t *scan_size,
+			       bool *is_output)
+{
+	struct iio_dev_priv *dev;
+	struct iio_channel *ch;
+	uint32_t ts_size;
+
+	dev = get_iio_device(ctx->instance, device);
+	if (!dev)
+		return -ENODEV;
+
+	if (!dev->dev_descriptor->channels)
+		return -EINVAL;
+
+	/* Same masking as done when the device is opened */
+	mask &= iio_channels_mask(dev->dev_descriptor);
+	if (!iio_fills_timestamp(dev))
+		mask &= ~iio_timestamp_mask(dev->dev_descriptor);
+	if (!mask)
+		return -ENOENT;
+
+	ch = &dev->dev_descriptor->channels[no_os_find_first_set_bit(mask)];
+	*scan_size = iio_scan_size(dev->dev_descriptor, mask, &ts_size);
+	*is_output = ch->ch_out;
+
+	return 0;
+}
+
+/* Free the trigger ring. The trigger handler must not be called anymore */
+static void iio_free_trig_ring(struct iio_buffer_priv *buffer)
+{
+	buffer->public.trig_ring = NULL;
+	free(buffer->trig_ring.buff);
+	buffer->trig_ring.buff = NULL;
+}
+
+/*
+ * Allocate the ring the trigger handler pushes scans to. It holds at least a
+ * block and its size is a power of two.
+ */
+static int32_t iio_alloc_trig_ring(struct iio_buffer_priv *buffer)
+{
+	uint32_t size = 1;
+	uint8_t *buf;
+	int32_t ret;
+
+	while (size < buffer->public.size) {
+		size <<= 1;
+		if (!size)
+			return -ENOMEM;
+	}
+
+	/* Free in case iio_close_dev wasn't called to free it */
+	iio_free_trig_ring(buffer);
+	buf = calloc(1, size);
+	if (!buf)
+		return -ENOMEM;
+
+	ret = no_os_spsc_ring_cfg(&buffer->trig_ring, buf, size);
+	if (NO_OS_IS_ERR_VALUE(ret)) {
+		free(buf);
+		return ret;
+	}
+	buffer->public.trig_ring = &buffer->trig_ring;
+
+	return 0;
+}
+
+/*
+ * Move the scans pushed from the trigger interrupt to the device buffer. Only
+ * whole scans are moved, the rest waits in the ring until there is room.
+ */
+static void iio_trigger_drain(struct iio_dev_priv *dev)
+{
+	struct iio_buffer_priv *buffer = &dev->buffer;
+	struct no_os_spsc_span span;
+	uint32_t size;
+	uint32_t len;
+	int32_t ret;
+
+	if (!buffer->public.trig_ring)
+		return;
+
+	ret = no_os_cb_size(&buffer->cb, &size);
+	if (NO_OS_IS_ERR_VALUE(ret) && ret != -NO_OS_EOVERRUN)
+		return;
+
+	len = buffer->cb.size - size;
+	len -= len % buffer->public.bytes_per_scan;
+	len = no_os_spsc_ring_read_reserve(&buffer->trig_ring, len, &span);
+	if (!len)
+		return;
+
+	no_os_cb_write(&buffer->cb, span.data[0], span.len[0]);
+	if (span.len[1])
+		no_os_cb_write(&buffer->cb, span.data[1], span.len[1]);
+	no_os_spsc_ring_read_commit(&buffer->trig_ring, len);
+}
+
+/**
+ * @brief Enable the trigger of a device when its buffer is enabled. The
+ * trigger is enabled by the first buffer using it.
+ * @param desc - IIO descriptor.
+ * @param dev - Device using the trigger.
+ * @return 0 in case of success or negative value otherwise.
+ */
+static int iio_trigger_attach(struct iio_desc *desc, struct iio_dev_priv *dev)
+{
+	struct iio_dev_priv *trig = &desc->devs[dev->trig_idx];
+	int ret;
+
+	/* Set before enabling so the first interrupt is not lost */
+	dev->trig_enabled = true;
+	if (!trig->trig_users && trig->trig_descriptor->enable) {
+		ret = trig->trig_descriptor->enable(trig->dev_instance);
+		if (NO_OS_IS_ERR_VALUE(ret)) {
+			dev->trig_enabled = false;
+			return ret;
+		}
+	}
+	trig->trig_users++;
+
+	return 0;
+}
+
+/**
+ * @brief Stop calling the trigger handler of a device. The trigger is
+ * disabled with the last buffer using it.
+ * @param desc - IIO descriptor.
+ * @param dev - Device using the trigger.
+ * @return 0 in case of success or negative value otherwise.
+ */
+static int iio_trigger_detach(struct iio_desc *desc, struct iio_dev_priv *dev)
+{
+	struct iio_dev_priv *trig = &desc->devs[dev->trig_idx];
+
+	dev->trig_enabled = false;
+	if (--trig->trig_users || !trig->trig_descriptor->disable)
+		return 0;
+
+	return trig->trig_descriptor->disable(trig->dev_instance);
+}
+
 /**
  * @brief  Open device.
  * @param ctx - IIO instance and conn instance
  * @param device - String containing device name.
  * @param sample_size - Sample size.
  * @param mask - Channels to be opened.
+ * @param cyclic - Output data is pushed once and repeated until close.
  * @return 0, negative value in case of failure.
  */
 static int iio_open_dev(struct iiod_ctx *ctx, const char *device,
 			uint32_t samples, uint32_t mask, bool cyclic)
 {
 	struct iio_dev_priv *dev;
-	uint32_t ch_mask;
+	uint32_t nb_blocks;
 	int32_t ret;
 	int8_t *buf;
 
@@ -781,19 +1250,40 @@ static int iio_open_dev(struct iiod_ctx *ctx, const char *device,
 	if (!dev->buffer.initalized)
 		return -EINVAL;
 
-	ch_mask = 0xFFFFFFFF >> (32 - dev->dev_descriptor->num_ch);
-	mask &= ch_mask;
+	/* A device only having a trigger handler needs a trigger to capture */
+	if (dev->trig_idx < 0 && !dev->dev_descriptor->read_dev &&
+	    !dev->dev_descriptor->write_dev && !dev->dev_descriptor->submit)
+		return -EINVAL;
+
+	mask &= iio_channels_mask(dev->dev_descriptor);
+	if (!iio_fills_timestamp(dev))
+		mask &= ~iio_timestamp_mask(dev->dev_descriptor);
 	if (!mask)
 		return -ENOENT;
 
 	dev->buffer.public.active_mask = mask;
+	dev->buffer.public.cyclic = cyclic;
+	dev->buffer.cyclic_loaded = false;
 	dev->buffer.public.bytes_per_scan =
-		bytes_per_scan(dev->dev_descriptor->channels, mask);
+		iio_scan_size(dev->dev_descriptor, mask,
+			      &dev->buffer.public.timestamp_size);
 	dev->buffer.public.size = dev->buffer.public.bytes_per_scan * samples;
+	if (!dev->buffer.public.size) {
+		ret = -EINVAL;
+		goto clear_mask;
+	}
+
+	/* Each request is one block, the circular buffer holds nb_blocks */
+	nb_blocks = no_os_max(dev->buffer.nb_blocks, 1);
+	dev->buffer.prefetch = false;
 	if (dev->buffer.raw_buf && dev->buffer.raw_buf_len) {
-		if (dev->buffer.raw_buf_len < dev->buffer.public.size)
+		nb_blocks = no_os_min(nb_blocks, dev->buffer.raw_buf_len /
+				      dev->buffer.public.size);
+		if (!nb_blocks) {
 			/* Need a bigger buffer or to allocate */
-			return -ENOMEM;
+			ret = -ENOMEM;
+			goto clear_mask;
+		}
 
 		buf = dev->buffer.raw_buf;
 	} else {
@@ -802,29 +1292,63 @@ static int iio_open_dev(struct iiod_ctx *ctx, const char *device,
 			free(dev->buffer.cb.buff);
 			dev->buffer.allocated = 0;
 		}
-		buf = (int8_t *)calloc(dev->buffer.public.size, sizeof(*buf));
-		if (!buf)
-			return -ENOMEM;
+		buf = (int8_t *)calloc(nb_blocks, dev->buffer.public.size);
+		if (!buf && nb_blocks > 1) {
+			/* Fall back to a single block */
+			nb_blocks = 1;
+			buf = (int8_t *)calloc(1, dev->buffer.public.size);
+		}
+		if (!buf) {
+			ret = -ENOMEM;
+			goto clear_mask;
+		}
 		dev->buffer.allocated = 1;
 	}
 
-	ret = no_os_cb_cfg(&dev->buffer.cb, buf, dev->buffer.public.size);
+	dev->buffer.nb_blocks_alloc = nb_blocks;
+	ret = no_os_cb_cfg(&dev->buffer.cb, buf,
+			   dev->buffer.public.size * nb_blocks);
 	if (NO_OS_IS_ERR_VALUE(ret)) {
 		if (dev->buffer.allocated) {
-			free(dev->buffer.cb.buff);
+			free(buf);
 			dev->buffer.allocated = 0;
 		}
-
-		return ret;
+		goto clear_mask;
 	}
 
 	if (dev->dev_descriptor->pre_enable) {
+		/* The timestamp is added here, devices don't know about it */
+		mask &= ~iio_timestamp_mask(dev->dev_descriptor);
 		ret = dev->dev_descriptor->pre_enable(dev->dev_instance, mask);
-		if (NO_OS_IS_ERR_VALUE(ret) && dev->buffer.allocated) {
-			free(dev->buffer.cb.buff);
-			dev->buffer.allocated = 0;
-		}
+		if (NO_OS_IS_ERR_VALUE(ret))
+			goto free_buf;
+	}
+
+	if (dev->trig_idx >= 0) {
+		ret = iio_alloc_trig_ring(&dev->buffer);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			goto disable;
+
+		ret = iio_trigger_attach(ctx->instance, dev);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			goto free_ring;
+	}
+
+	return 0;
+
+free_ring:
+	iio_free_trig_ring(&dev->buffer);
+disable:
+	if (dev->dev_descriptor->post_disable)
+		dev->dev_descriptor->post_disable(dev->dev_instance);
+free_buf:
+	if (dev->buffer.allocated) {
+		free(dev->buffer.cb.buff);
+		dev->buffer.allocated = 0;
 	}
+clear_mask:
+	/* The buffer is not enabled */
+	dev->buffer.public.active_mask = 0;
 
 	return ret;
 }
@@ -838,6 +1362,7 @@ static int iio_open_dev(struct iiod_ctx *ctx, const char *device,
 static int iio_close_dev(struct iiod_ctx *ctx, const char *device)
 {
 	struct iio_dev_priv *dev;
+	int ret = 0;
 
 	dev = get_iio_device(ctx->instance, device);
 	if (!dev)
@@ -846,6 +1371,16 @@ static int iio_close_dev(struct iiod_ctx *ctx, const char *device)
 	if (!dev->buffer.initalized)
 		return -EINVAL;
 
+	/* No more scans are pushed once detached */
+	if (dev->trig_enabled)
+		iio_trigger_detach(ctx->instance, dev);
+	iio_free_trig_ring(&dev->buffer);
+
+	/* Stop the device, e.g. a DMA stream, before its buffer is freed */
+	dev->buffer.prefetch = false;
+	if (dev->dev_descriptor->post_disable)
+		ret = dev->dev_descriptor->post_disable(dev->dev_instance);
+
 	if (dev->buffer.allocated) {
 		/* Should something else be used to free internal strucutre */
 		free(dev->buffer.cb.buff);
@@ -853,22 +1388,19 @@ static int iio_close_dev(struct iiod_ctx *ctx, const char *device)
 	}
 
 	dev->buffer.public.active_mask = 0;
-	if (dev->dev_descriptor->post_disable)
-		return dev->dev_descriptor->post_disable(dev->dev_instance);
+	dev->buffer.public.cyclic = false;
+	dev->buffer.cyclic_loaded = false;
 
-	return 0;
+	return ret;
 }
 
-static int iio_call_submit(struct iiod_ctx *ctx, const char *device,
-			   enum iio_buffer_direction dir)
+static int iio_submit(struct iio_desc *desc, struct iio_dev_priv *dev,
+		      enum iio_buffer_direction dir)
 {
-	struct iio_dev_priv *dev;
+	/* Time of the request, read_dev timestamps are interpolated from it */
+	if (dev->buffer.public.timestamp_size)
+		dev->buffer.public.timestamp = iio_get_timestamp(desc);
 
-	dev = get_iio_device(ctx->instance, device);
-	if (!dev || !dev->buffer.initalized)
-		return -EINVAL;
-
-	dev->buffer.public.dir = dir;
 	if (dev->dev_descriptor->submit)
 		return dev->dev_descriptor->submit(&dev->dev_data);
 	else if ((dir == IIO_DIRECTION_INPUT && dev->dev_descriptor->read_dev)
@@ -894,26 +1426,292 @@ static int iio_call_submit(struct iiod_ctx *ctx, const char *device,
 		if (NO_OS_IS_ERR_VALUE(ret))
 			return ret;
 
+		/* Scans were read one after the other since the request */
+		if (dir == IIO_DIRECTION_INPUT && buffer->timestamp_size)
+			iio_buffer_add_timestamps(buffer, buff, nb_scans,
+						  buffer->timestamp,
+						  iio_get_timestamp(desc));
+
 		return iio_buffer_block_done(buffer);
 	}
 
 	return 0;
 }
 
-static int iio_push_buffer(struct iiod_ctx *ctx, const char *device)
+static int iio_call_submit(struct iiod_ctx *ctx, const char *device,
+			   enum iio_buffer_direction dir)
 {
-	return iio_call_submit(ctx, device, IIO_DIRECTION_OUTPUT);
-}
+	struct iio_dev_priv *dev;
+	bool prefetching;
+	uint32_t size;
+	int ret;
 
-static int iio_refill_buffer(struct iiod_ctx *ctx, const char *device)
-{
-	return iio_call_submit(ctx, device, IIO_DIRECTION_INPUT);
-}
+	dev = get_iio_device(ctx->instance, device);
+	if (!dev || !dev->buffer.initalized)
+		return -EINVAL;
 
-/**
- * @brief Read chunk of data from RAM to pbuf. Call
- * "iio_transfer_dev_to_mem()" first.
- * This function is probably called multiple times by libtinyiiod after a
+	/* Scans are pushed by the trigger handler, data is sent as it comes */
+	if (dev->trig_enabled)
+		return 0;
+
+	if (dir == IIO_DIRECTION_INPUT && dev->buffer.nb_blocks_alloc > 1) {
+		/* From now on, free blocks are filled between requests */
+		prefetching = dev->buffer.prefetch;
+		dev->buffer.prefetch = true;
+		ret = no_os_cb_size(&dev->buffer.cb, &size);
+		if (NO_OS_IS_ERR_VALUE(ret) && ret != -NO_OS_EOVERRUN)
+			return ret;
+		/* A block captured in advance is ready */
+		if (size >= dev->buffer.public.size)
+			return 0;
+		/* iio_prefetch is capturing it, other requests are served */
+		if (prefetching)
+			return -EAGAIN;
+	}
+
+	dev->buffer.public.dir = dir;
+	if (dir != IIO_DIRECTION_OUTPUT || !dev->buffer.public.cyclic)
+		return iio_submit(ctx->instance, dev, dir);
+
+	/* The device is already repeating the first block */
+	if (dev->buffer.cyclic_loaded)
+		return -EBUSY;
+
+	ret = iio_submit(ctx->instance, dev, dir);
+	if (!NO_OS_IS_ERR_VALUE(ret))
+		dev->buffer.cyclic_loaded = true;
+
+	return ret;
+}
+
+/**
+ * @brief Fill a free block of each device capturing with more than one block,
+ * so the next request is served while the previous one is still being sent.
+ * A device failing stops prefetching, the error is returned by the next
+ * request.
+ * @param desc - IIO descriptor.
+ */
+static void iio_prefetch(struct iio_desc *desc)
+{
+	struct iio_dev_priv *dev;
+	uint32_t size;
+	uint32_t i;
+	int ret;
+
+	for (i = 0; i < desc->nb_devs; i++) {
+		dev = &desc->devs[i];
+		if (!dev->buffer.prefetch)
+			continue;
+
+		ret = no_os_cb_size(&dev->buffer.cb, &size);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			continue;
+		if (dev->buffer.cb.size - size < dev->buffer.public.size)
+			continue;
+
+		dev->buffer.public.dir = IIO_DIRECTION_INPUT;
+		ret = iio_submit(desc, dev, IIO_DIRECTION_INPUT);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			dev->buffer.prefetch = false;
+	}
+}
+
+/**
+ * @brief Set the number of blocks of a device buffer. Applied when the buffer
+ * is opened.
+ * @param ctx - IIO instance and conn instance
+ * @param device - String containing device name.
+ * @param buffers_count - Number of blocks.
+ * @return 0, negative value in case of failure.
+ */
+static int iio_set_buffers_count(struct iiod_ctx *ctx, const char *device,
+				 uint32_t buffers_count)
+{
+	struct iio_dev_priv *dev;
+
+	dev = get_iio_device(ctx->instance, device);
+	if (!dev || !dev->buffer.initalized || !buffers_count)
+		return -EINVAL;
+
+	if (dev->buffer.public.active_mask)
+		return -EBUSY;
+
+	dev->buffer.nb_blocks = no_os_min(buffers_count,
+					  (uint32_t)IIO_MAX_BUFFERS_COUNT);
+
+	return 0;
+}
+
+/**
+ * @brief Get the trigger used by a device.
+ * @param ctx - IIO instance and conn instance
+ * @param device - String containing device name.
+ * @param trigger - Where the id of the trigger is stored.
+ * @param len - Size of trigger.
+ * @return Length of the id, 0 if no trigger is set or negative value in case
+ * of failure.
+ */
+static int iio_get_trigger(struct iiod_ctx *ctx, const char *device,
+			   char *trigger, uint32_t len)
+{
+	struct iio_desc *desc = ctx->instance;
+	struct iio_dev_priv *dev;
+	const char *id;
+
+	dev = get_iio_device(desc, device);
+	if (!dev || dev->trig_descriptor)
+		return -ENODEV;
+
+	if (dev->trig_idx < 0)
+		return 0;
+
+	id = desc->devs[dev->trig_idx].dev_id;
+	if (strlen(id) >= len)
+		return -ENOMEM;
+
+	return sprintf(trigger, "%s", id);
+}
+
+/**
+ * @brief Set the trigger used by a device. Can't be changed while the buffer
+ * is enabled.
+ * @param ctx - IIO instance and conn instance
+ * @param device - String containing device name.
+ * @param trigger - Id or name of the trigger. Empty to remove the trigger.
+ * @param len - Length of trigger.
+ * @return 0, negative value in case of failure.
+ */
+static int iio_set_trigger(struct iiod_ctx *ctx, const char *device,
+			   const char *trigger, uint32_t len)
+{
+	struct iio_desc *desc = ctx->instance;
+	struct iio_dev_priv *dev;
+	int32_t idx;
+
+	dev = get_iio_device(desc, device);
+	if (!dev || dev->trig_descriptor)
+		return -ENODEV;
+
+	if (dev->buffer.public.active_mask)
+		return -EBUSY;
+
+	if (!len || !trigger[0]) {
+		dev->trig_idx = -1;
+		return 0;
+	}
+
+	if (!dev->dev_descriptor->trigger_handler)
+		return -EINVAL;
+
+	idx = iio_find_trigger(desc, trigger);
+	if (idx < 0)
+		return idx;
+
+	dev->trig_idx = idx;
+
+	return 0;
+}
+
+/**
+ * @brief Start queuing the events of a device for a connection. Events
+ * from before are discarded.
+ * @param ctx - IIO instance and conn instance
+ * @param device - String containing device name.
+ * @return 0, negative value in case of failure.
+ */
+static int iio_open_events(struct iiod_ctx *ctx, const char *device)
+{
+	struct iio_dev_priv *dev;
+
+	dev = get_iio_device(ctx->instance, device);
+	if (!dev || !dev->events.buff)
+		return -ENODEV;
+
+	if (dev->ev_conn)
+		return dev->ev_conn == ctx->conn ? 0 : -EBUSY;
+
+	no_os_spsc_ring_read_commit(&dev->events,
+				    no_os_spsc_ring_used(&dev->events));
+	dev->ev_conn = ctx->conn;
+
+	return 0;
+}
+
+/**
+ * @brief Stop queuing the events of a device.
+ * @param ctx - IIO instance and conn instance
+ * @param device - String containing device name.
+ * @return 0, negative value in case of failure.
+ */
+static int iio_close_events(struct iiod_ctx *ctx, const char *device)
+{
+	struct iio_dev_priv *dev;
+
+	dev = get_iio_device(ctx->instance, device);
+	if (!dev || dev->ev_conn != ctx->conn)
+		return -EINVAL;
+
+	dev->ev_conn = NULL;
+
+	return 0;
+}
+
+/**
+ * @brief Get the oldest queued event of a device.
+ * @param ctx - IIO instance and conn instance
+ * @param device - String containing device name.
+ * @param buf - Where the struct iio_event_data is copied.
+ * @param len - Size of buf.
+ * @return Size of the event, -EAGAIN if there is no event or negative value
+ * in case of failure.
+ */
+static int iio_read_event(struct iiod_ctx *ctx, const char *device,
+			  char *buf, uint32_t len)
+{
+	struct iio_dev_priv *dev;
+	int32_t ret;
+
+	dev = get_iio_device(ctx->instance, device);
+	if (!dev || dev->ev_conn != ctx->conn)
+		return -EINVAL;
+
+	if (len < sizeof(struct iio_event_data))
+		return -ENOMEM;
+
+	ret = no_os_spsc_ring_pop(&dev->events, buf,
+				  sizeof(struct iio_event_data));
+	if (NO_OS_IS_ERR_VALUE(ret))
+		return ret;
+
+	return sizeof(struct iio_event_data);
+}
+
+#ifdef ENABLE_IIO_NETWORK
+/* Stop queuing events for a connection that was closed */
+static void iio_release_events(struct iio_desc *desc, void *conn)
+{
+	uint32_t i;
+
+	for (i = 0; i < desc->nb_devs; i++)
+		if (desc->devs[i].ev_conn == conn)
+			desc->devs[i].ev_conn = NULL;
+}
+#endif
+
+static int iio_push_buffer(struct iiod_ctx *ctx, const char *device)
+{
+	return iio_call_submit(ctx, device, IIO_DIRECTION_OUTPUT);
+}
+
+static int iio_refill_buffer(struct iiod_ctx *ctx, const char *device)
+{
+	return iio_call_submit(ctx, device, IIO_DIRECTION_INPUT);
+}
+
+/**
+ * @brief Read chunk of data from RAM to pbuf. Call
+ * "iio_transfer_dev_to_mem()" first.
+ * This function is probably called multiple times by libtinyiiod after a
  * "iio_transfer_dev_to_mem" call, since we can only read "bytes_count" bytes.
  * @param device - String containing device name.
  * @param pbuf - Buffer where value is stored.
@@ -932,6 +1730,8 @@ static int iio_read_buffer(struct iiod_ctx *ctx, const char *device, char *buf,
 	if (!dev || !dev->buffer.initalized)
 		return -EINVAL;
 
+	iio_trigger_drain(dev);
+
 	ret = no_os_cb_size(&dev->buffer.cb, &size);
 	if (NO_OS_IS_ERR_VALUE(ret))
 		return ret;
@@ -948,6 +1748,58 @@ static int iio_read_buffer(struct iiod_ctx *ctx, const char *device, char *buf,
 	return bytes;
 }
 
+/**
+ * @brief Get a reference to data from the device buffer without copying it.
+ * Data that wraps around the end of the circular buffer is returned by the
+ * next call, after iio_read_buffer_done.
+ * @param ctx - IIO instance and conn instance
+ * @param device - String containing device name.
+ * @param buf - Where to store the address of the data.
+ * @param bytes - Maximum number of bytes to be returned.
+ * @return Number of bytes available at buf or negative value in case of error.
+ */
+static int iio_read_buffer_get(struct iiod_ctx *ctx, const char *device,
+			       char **buf, uint32_t bytes)
+{
+	struct iio_dev_priv	*dev;
+	int32_t			ret;
+	uint32_t		size;
+
+	dev = get_iio_device(ctx->instance, device);
+	if (!dev || !dev->buffer.initalized)
+		return -EINVAL;
+
+	iio_trigger_drain(dev);
+
+	ret = no_os_cb_prepare_async_read(&dev->buffer.cb, bytes, (void **)buf,
+					  &size);
+	/* On overrun the read index is moved to the oldest valid data */
+	if (NO_OS_IS_ERR_VALUE(ret) && ret != -NO_OS_EOVERRUN)
+		return ret;
+
+	/* Triggered devices may not have captured anything yet */
+	if (!size)
+		return -EAGAIN;
+
+	return size;
+}
+
+/**
+ * @brief Release data returned by iio_read_buffer_get.
+ * @param ctx - IIO instance and conn instance
+ * @param device - String containing device name.
+ * @return 0 or negative value in case of error.
+ */
+static int iio_read_buffer_done(struct iiod_ctx *ctx, const char *device)
+{
+	struct iio_dev_priv	*dev;
+
+	dev = get_iio_device(ctx->instance, device);
+	if (!dev || !dev->buffer.initalized)
+		return -EINVAL;
+
+	return no_os_cb_end_async_read(&dev->buffer.cb);
+}
 
 /**
  * @brief Write chunk of data into RAM.
@@ -972,6 +1824,10 @@ static int iio_write_buffer(struct iiod_ctx *ctx, const char *device,
 	if (!dev || !dev->buffer.initalized)
 		return -EINVAL;
 
+	/* Data of a cyclic buffer can't be changed once pushed */
+	if (dev->buffer.cyclic_loaded)
+		return -EBUSY;
+
 	ret = no_os_cb_size(&dev->buffer.cb, &size);
 	if (NO_OS_IS_ERR_VALUE(ret))
 		return ret;
@@ -1029,13 +1885,65 @@ int iio_buffer_block_done(struct iio_buffer *buffer)
 	return no_os_cb_end_async_read(buffer->buf);
 }
 
+/* Copy len bytes from src at offset in the reserved region of a ring */
+static void iio_span_write(struct no_os_spsc_span *span, uint32_t offset,
+			   const uint8_t *src, uint32_t len)
+{
+	uint32_t n;
+
+	if (offset < span->len[0]) {
+		n = no_os_min(len, span->len[0] - offset);
+		memcpy(span->data[0] + offset, src, n);
+		src += n;
+		len -= n;
+		offset = 0;
+	} else {
+		offset -= span->len[0];
+	}
+
+	if (len)
+		memcpy(span->data[1] + offset, src, len);
+}
+
 /* Write to buffer iio_buffer.bytes_per_scan bytes from data */
 int iio_buffer_push_scan(struct iio_buffer *buffer, void *data)
 {
+	uint8_t ts[2 * sizeof(int64_t)] = { 0 };
+	struct no_os_spsc_span span;
+	uint32_t data_size;
+	uint32_t pad;
+	int32_t ret;
+
 	if (!buffer)
 		return -EINVAL;
 
-	return no_os_cb_write(buffer->buf, data, buffer->bytes_per_scan);
+	/* Padding followed by the timestamp of the trigger */
+	data_size = buffer->bytes_per_scan - buffer->timestamp_size;
+	if (buffer->timestamp_size) {
+		pad = buffer->timestamp_size - sizeof(int64_t);
+		memcpy(ts + pad, &buffer->timestamp, sizeof(int64_t));
+	}
+
+	/* From interrupt, the main loop moves the scan to buf */
+	if (buffer->trig_ring) {
+		if (no_os_spsc_ring_write_reserve(buffer->trig_ring,
+						  buffer->bytes_per_scan,
+						  &span) < buffer->bytes_per_scan)
+			return -ENOSPC;
+
+		iio_span_write(&span, 0, data, data_size);
+		iio_span_write(&span, data_size, ts, buffer->timestamp_size);
+		no_os_spsc_ring_write_commit(buffer->trig_ring,
+					     buffer->bytes_per_scan);
+
+		return 0;
+	}
+
+	ret = no_os_cb_write(buffer->buf, data, data_size);
+	if (NO_OS_IS_ERR_VALUE(ret) || !buffer->timestamp_size)
+		return ret;
+
+	return no_os_cb_write(buffer->buf, ts, buffer->timestamp_size);
 }
 
 /* Read from buffer iio_buffer.bytes_per_scan bytes into data */
@@ -1047,6 +1955,155 @@ int iio_buffer_pop_scan(struct iio_buffer *buffer, void *data)
 	return no_os_cb_read(buffer->buf, data, buffer->bytes_per_scan);
 }
 
+/**
+ * @brief Insert the timestamp channel in a block read by a device. The block
+ * holds nb_scans scans without timestamp at its start. They are spread to
+ * the scan size and the timestamps are interpolated between start and end,
+ * scan i being acquired at (i + 1) / nb_scans of the interval.
+ * @param buffer - Buffer the block belongs to.
+ * @param block - Address of the block.
+ * @param nb_scans - Number of scans in the block.
+ * @param start - Timestamp in ns of the start of the acquisition.
+ * @param end - Timestamp in ns of the end of the acquisition.
+ * @return 0 in case of success or negative value otherwise.
+ */
+int iio_buffer_add_timestamps(struct iio_buffer *buffer, void *block,
+			      uint32_t nb_scans, int64_t start, int64_t end)
+{
+	uint8_t *buf = block;
+	uint32_t data_size;
+	uint32_t scan_size;
+	int64_t ts;
+	uint32_t i;
+
+	if (!buffer || !block)
+		return -EINVAL;
+
+	if (!buffer->timestamp_size)
+		return 0;
+
+	scan_size = buffer->bytes_per_scan;
+	data_size = scan_size - buffer->timestamp_size;
+	/* Backwards, so that no scan is overwritten before being moved */
+	for (i = nb_scans; i-- > 0;) {
+		memmove(buf + i * scan_size, buf + i * data_size, data_size);
+		memset(buf + i * scan_size + data_size, 0,
+		       buffer->timestamp_size - sizeof(int64_t));
+		ts = start + (end - start) * (int64_t)(i + 1) / nb_scans;
+		memcpy(buf + (i + 1) * scan_size - sizeof(int64_t), &ts,
+		       sizeof(int64_t));
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Call the trigger handler of the devices with an enabled buffer using
+ * the trigger. To be called from the interrupt of the trigger. The scan is
+ * dropped for devices whose trigger ring is full.
+ * @param desc - IIO descriptor.
+ * @param trig_id - Index of the trigger in iio_init_param.trigs, given to the
+ * bind callback of the trigger.
+ * @return 0 in case of success or negative value otherwise.
+ */
+int iio_process_trigger(struct iio_desc *desc, uint32_t trig_id)
+{
+	struct iio_dev_priv *dev;
+	bool ts_read = false;
+	int64_t ts = 0;
+	int32_t idx;
+	uint32_t i;
+	int ret = 0;
+	int err;
+
+	if (!desc || trig_id >= desc->nb_trigs)
+		return -EINVAL;
+
+	idx = desc->nb_devs - desc->nb_trigs + trig_id;
+	for (i = 0; i < desc->nb_devs - desc->nb_trigs; i++) {
+		dev = &desc->devs[i];
+		if (!dev->trig_enabled || dev->trig_idx != idx)
+			continue;
+
+		if (no_os_spsc_ring_free(&dev->buffer.trig_ring) <
+		    dev->buffer.public.bytes_per_scan)
+			continue;
+
+		/* All the scans of a trigger get the same timestamp */
+		if (dev->buffer.public.timestamp_size && !ts_read) {
+			ts = iio_get_timestamp(desc);
+			ts_read = true;
+		}
+		dev->buffer.public.timestamp = ts;
+
+		err = dev->dev_descriptor->trigger_handler(&dev->dev_data);
+		if (NO_OS_IS_ERR_VALUE(err))
+			ret = err;
+	}
+
+	return ret;
+}
+
+/**
+ * @brief Queue an event of a channel, to be sent to the client reading the
+ * events of the device. Can be called from interrupt context. The event is
+ * dropped when no client reads the events.
+ * @param desc - IIO descriptor.
+ * @param dev - Device instance, the one given in iio_device_init.dev.
+ * @param ch_idx - Index of the channel in iio_device.channels.
+ * @param type - Type of the event. Must be in the channel event_specs.
+ * @param dir - Direction of the event. Must be in the channel event_specs.
+ * @param timestamp - Timestamp of the event, 0 if not available.
+ * @return 0 in case of success, -EAGAIN if the event FIFO is full or negative
+ * value otherwise.
+ */
+int iio_push_event(struct iio_desc *desc, void *dev, uint32_t ch_idx,
+		   enum iio_event_type type, enum iio_event_direction dir,
+		   int64_t timestamp)
+{
+	struct iio_event_data event;
+	struct iio_dev_priv *ldev;
+	struct iio_channel *ch;
+	uint32_t i;
+
+	if (!desc)
+		return -EINVAL;
+
+	for (i = 0; i < desc->nb_devs - desc->nb_trigs; i++)
+		if (desc->devs[i].dev_instance == dev)
+			break;
+	if (i == desc->nb_devs - desc->nb_trigs)
+		return -ENODEV;
+
+	ldev = &desc->devs[i];
+	if (ch_idx >= ldev->dev_descriptor->num_ch)
+		return -EINVAL;
+
+	ch = &ldev->dev_descriptor->channels[ch_idx];
+	for (i = 0; i < ch->num_event_specs; i++)
+		if (ch->event_specs[i].type == type &&
+		    ch->event_specs[i].dir == dir)
+			break;
+	if (i == ch->num_event_specs)
+		return -EINVAL;
+
+	if (!ldev->ev_conn)
+		return 0;
+
+	/* Same encoding as IIO_EVENT_CODE from Linux */
+	event.id = (uint64_t)type << 56 | (uint64_t)dir << 48 |
+		   (uint64_t)iio_chan_type_code[ch->ch_type] << 32 |
+		   (uint16_t)ch->channel;
+	if (ch->diferential)
+		event.id |= (uint64_t)1 << 55 |
+			    (uint64_t)(uint16_t)ch->channel2 << 16;
+	else if (ch->modified)
+		event.id |= (uint64_t)iio_modifier_code[ch->channel2] << 40;
+	event.timestamp = timestamp;
+
+	return no_os_spsc_ring_push(&ldev->events, &event, sizeof(event));
+}
+
 #ifdef ENABLE_IIO_NETWORK
 
 static int32_t accept_network_clients(struct iio_desc *desc)
@@ -1063,6 +2120,7 @@ static int32_t accept_network_clients(struct iio_desc *desc)
 		data.conn = sock;
 		data.buf = calloc(1, IIOD_CONN_BUFFER_SIZE);
 		data.len = IIOD_CONN_BUFFER_SIZE;
+		data.partial_recv = true;
 
 		ret = iiod_conn_add(desc->iiod, &data, &id);
 		if (NO_OS_IS_ERR_VALUE(ret))
@@ -1086,6 +2144,7 @@ int iio_step(struct iio_desc *desc)
 {
 	struct iiod_conn_data data;
 	uint32_t conn_id;
+	uint32_t i;
 	int32_t ret;
 
 #ifdef ENABLE_IIO_NETWORK
@@ -1096,6 +2155,13 @@ int iio_step(struct iio_desc *desc)
 	}
 #endif
 
+	iio_prefetch(desc);
+
+	/* Scans pushed from interrupt are ready to be read */
+	for (i = 0; i < desc->nb_devs; i++)
+		if (desc->devs[i].trig_enabled)
+			iio_trigger_drain(&desc->devs[i]);
+
 	ret = _pop_conn(desc, &conn_id);
 	if (NO_OS_IS_ERR_VALUE(ret))
 		return ret;
@@ -1105,6 +2171,7 @@ int iio_step(struct iio_desc *desc)
 #ifdef ENABLE_IIO_NETWORK
 		if (desc->server) {
 			iiod_conn_remove(desc->iiod, conn_id, &data);
+			iio_release_events(desc, data.conn);
 			socket_remove(data.conn);
 			free(data.buf);
 		}
@@ -1116,225 +2183,419 @@ int iio_step(struct iio_desc *desc)
 	return ret;
 }
 
+/* Copy the part of str that falls in the window of the writer */
+static void iio_xml_put(struct iio_xml_writer *w, const char *str,
+			uint32_t len)
+{
+	uint32_t from, to;
+
+	from = no_os_max(w->pos, w->start);
+	to = no_os_min(w->pos + len, w->start + w->len);
+	if (from < to)
+		memcpy(w->buf + from - w->start, str + from - w->pos,
+		       to - from);
+
+	w->pos += len;
+}
+
+static void iio_xml_printf(struct iio_xml_writer *w, const char *fmt, ...)
+{
+	char tmp[IIO_XML_TMP_SIZE];
+	va_list args;
+	char *big;
+	int32_t n;
+
+	va_start(args, fmt);
+	n = vsnprintf(tmp, sizeof(tmp), fmt, args);
+	va_end(args);
+	if (n < 0)
+		return;
+
+	if (n < (int32_t)sizeof(tmp)) {
+		iio_xml_put(w, tmp, n);
+		return;
+	}
+
+	/* Only very long names get here */
+	big = malloc(n + 1);
+	if (!big) {
+		w->pos += n;
+		return;
+	}
+
+	va_start(args, fmt);
+	vsnprintf(big, n + 1, fmt, args);
+	va_end(args);
+	iio_xml_put(w, big, n);
+	free(big);
+}
+
 /*
- * Generate an xml describing a device and write it to buff.
- * Will return the size of the xml.
- * If buff_size is 0, no data will be written to buff, but size will be returned
+ * Generate an xml describing a device and write it with the writer.
+ * Only the part that falls in the window of the writer is written, but
+ * w->pos is always advanced with the full size of the xml.
  */
-static uint32_t iio_generate_device_xml(struct iio_device *device, char *name,
-					char *id, char *buff,
-					uint32_t buff_size)
+static int32_t iio_generate_device_xml(struct iio_xml_writer *w,
+				       struct iio_dev_priv *dev)
 {
+	struct iio_device	*device = dev->dev_descriptor;
 	struct iio_channel	*ch;
 	struct iio_attribute	*attr;
-	char			ch_id[50];
-	int32_t			i;
+	const char		*dir;
+	const char		*type;
 	int32_t			j;
 	int32_t			k;
-	int32_t			n;
-
-	if ((int32_t)buff_size == -1)
-		n = 0;
-	else
-		n = buff_size;
-
-	if (buff == NULL)
-		/* Set dummy value for buff. It is used only for counting */
-		buff = ch_id;
 
-	i = 0;
-	i += snprintf(buff, no_os_max(n - i, 0),
-		      "<device id=\"%s\" name=\"%s\">", id, name);
+	iio_xml_printf(w, "<device id=\"%s\" name=\"%s\">", dev->dev_id,
+		       dev->name);
 
 	/* Write channels */
 	if (device->channels)
 		for (j = 0; j < device->num_ch; j++) {
 			ch = &device->channels[j];
-			_print_ch_id(ch_id, ch);
-			i += snprintf(buff + i, no_os_max(n - i, 0),
-				      "<channel id=\"%s\"",
-				      ch_id);
+			dir = ch->ch_out ? "out" : "in";
+			type = iio_chan_type_string[ch->ch_type];
+			iio_xml_printf(w, "<channel id=\"%s\"", dev->ch_ids[j]);
 			if(ch->name)
-				i += snprintf(buff + i, no_os_max(n - i, 0),
-					      " name=\"%s\"",
-					      ch->name);
-			i += snprintf(buff + i, no_os_max(n - i, 0),
-				      " type=\"%s\" >",
-				      ch->ch_out ? "output" : "input");
+				iio_xml_printf(w, " name=\"%s\"", ch->name);
+			iio_xml_printf(w, " type=\"%s\" >",
+				       ch->ch_out ? "output" : "input");
 
 			if (ch->scan_type)
-				i += snprintf(buff + i, no_os_max(n - i, 0),
-					      "<scan-element index=\"%d\""
-					      " format=\"%s:%c%d/%d>>%d\" />",
-					      ch->scan_index,
-					      ch->scan_type->is_big_endian ? "be" : "le",
-					      ch->scan_type->sign,
-					      ch->scan_type->realbits,
-					      ch->scan_type->storagebits,
-					      ch->scan_type->shift);
+				iio_xml_printf(w, "<scan-element index=\"%d\""
+					       " format=\"%s:%c%d/%d>>%d\" />",
+					       ch->scan_index,
+					       ch->scan_type->is_big_endian ? "be" : "le",
+					       ch->scan_type->sign,
+					       ch->scan_type->realbits,
+					       ch->scan_type->storagebits,
+					       ch->scan_type->shift);
 
 			/* Write channel attributes */
 			if (ch->attributes)
 				for (k = 0; ch->attributes[k].name; k++) {
 					attr = &ch->attributes[k];
-					i += snprintf(buff + i, no_os_max(n - i, 0), "<attribute name=\"%s\" ",
-						      attr->name);
+					iio_xml_printf(w, "<attribute name=\"%s\" ",
+						       attr->name);
 					if (ch->diferential) {
 						switch (attr->shared) {
 						case IIO_SHARED_BY_ALL:
-							i += snprintf(buff + i, no_os_max(n - i, 0),
-								      "filename=\"%s\"",
-								      attr->name);
+							iio_xml_printf(w, "filename=\"%s\"",
+								       attr->name);
 							break;
 						case IIO_SHARED_BY_DIR:
-							i += snprintf(buff + i, no_os_max(n - i, 0),
-								      "filename=\"%s_%s\"",
-								      ch->ch_out ? "out" : "in",
-								      attr->name);
+							iio_xml_printf(w, "filename=\"%s_%s\"",
+								       dir, attr->name);
 							break;
 						case IIO_SHARED_BY_TYPE:
-							i += snprintf(buff + i, no_os_max(n - i, 0),
-								      "filename=\"%s_%s-%s_%s\"",
-								      ch->ch_out ? "out" : "in",
-								      iio_chan_type_string[ch->ch_type],
-								      iio_chan_type_string[ch->ch_type],
-								      attr->name);
+							iio_xml_printf(w, "filename=\"%s_%s-%s_%s\"",
+								       dir, type, type,
+								       attr->name);
 							break;
 						case IIO_SEPARATE:
 							if (!ch->indexed) {
 								// Differential channels must be indexed!
 								return -EINVAL;
 							}
-							i += snprintf(buff + i, no_os_max(n - i, 0),
-								      "filename=\"%s_%s%d-%s%d_%s\"",
-								      ch->ch_out ? "out" : "in",
-								      iio_chan_type_string[ch->ch_type],
-								      ch->channel,
-								      iio_chan_type_string[ch->ch_type],
-								      ch->channel2,
-								      attr->name);
+							iio_xml_printf(w, "filename=\"%s_%s%d-%s%d_%s\"",
+								       dir, type, ch->channel,
+								       type, ch->channel2,
+								       attr->name);
 							break;
 						}
 					} else {
 						switch (attr->shared) {
 						case IIO_SHARED_BY_ALL:
-							i += snprintf(buff + i, no_os_max(n - i, 0),
-								      "filename=\"%s\"",
-								      attr->name);
+							iio_xml_printf(w, "filename=\"%s\"",
+								       attr->name);
 							break;
 						case IIO_SHARED_BY_DIR:
-							i += snprintf(buff + i, no_os_max(n - i, 0),
-								      "filename=\"%s_%s\"",
-								      ch->ch_out ? "out" : "in",
-								      attr->name);
+							iio_xml_printf(w, "filename=\"%s_%s\"",
+								       dir, attr->name);
 							break;
 						case IIO_SHARED_BY_TYPE:
-							i += snprintf(buff + i, no_os_max(n - i, 0),
-								      "filename=\"%s_%s_%s\"",
-								      ch->ch_out ? "out" : "in",
-								      iio_chan_type_string[ch->ch_type],
-								      attr->name);
+							iio_xml_printf(w, "filename=\"%s_%s_%s\"",
+								       dir, type, attr->name);
 							break;
 						case IIO_SEPARATE:
 							if (ch->indexed)
-								i += snprintf(buff + i, no_os_max(n - i, 0),
-									      "filename=\"%s_%s%d_%s\"",
-									      ch->ch_out ? "out" : "in",
-									      iio_chan_type_string[ch->ch_type],
-									      ch->channel,
-									      attr->name);
+								iio_xml_printf(w, "filename=\"%s_%s%d_%s\"",
+									       dir, type,
+									       ch->channel,
+									       attr->name);
 							else
-								i += snprintf(buff + i, no_os_max(n - i, 0),
-									      "filename=\"%s_%s_%s\"",
-									      ch->ch_out ? "out" : "in",
-									      iio_chan_type_string[ch->ch_type],
-									      attr->name);
+								iio_xml_printf(w, "filename=\"%s_%s_%s\"",
+									       dir, type,
+									       attr->name);
 							break;
 						}
 					}
-					i += snprintf(buff + i, no_os_max(n - i, 0), " />");
+					iio_xml_printf(w, " />");
 				}
 
-			i += snprintf(buff + i, no_os_max(n - i, 0), "</channel>");
+			iio_xml_printf(w, "</channel>");
 		}
 
 	/* Write device attributes */
 	if (device->attributes)
 		for (j = 0; device->attributes[j].name; j++)
-			i += snprintf(buff + i, no_os_max(n - i, 0),
-				      "<attribute name=\"%s\" />",
-				      device->attributes[j].name);
+			iio_xml_printf(w, "<attribute name=\"%s\" />",
+				       device->attributes[j].name);
 
 	/* Write debug attributes */
 	if (device->debug_attributes)
 		for (j = 0; device->debug_attributes[j].name; j++)
-			i += snprintf(buff + i, no_os_max(n - i, 0),
-				      "<debug-attribute name=\"%s\" />",
-				      device->debug_attributes[j].name);
+			iio_xml_printf(w, "<debug-attribute name=\"%s\" />",
+				       device->debug_attributes[j].name);
 	if (device->debug_reg_read || device->debug_reg_write)
-		i += snprintf(buff + i, no_os_max(n - i, 0),
-			      "<debug-attribute name=\""REG_ACCESS_ATTRIBUTE"\" />");
+		iio_xml_printf(w, "<debug-attribute name=\""
+			       REG_ACCESS_ATTRIBUTE"\" />");
 
 	/* Write buffer attributes */
 	if (device->buffer_attributes)
 		for (j = 0; device->buffer_attributes[j].name; j++)
-			i += snprintf(buff + i, no_os_max(n - i, 0),
-				      "<buffer-attribute name=\"%s\" />",
-				      device->buffer_attributes[j].name);
+			iio_xml_printf(w, "<buffer-attribute name=\"%s\" />",
+				       device->buffer_attributes[j].name);
+
+	iio_xml_printf(w, "</device>");
+
+	return 0;
+}
+
+/**
+ * @brief Render a part of the context xml.
+ * @param ctx - IIO instance and conn instance
+ * @param offset - Offset in the xml of the first byte to render.
+ * @param buf - Where the xml is written.
+ * @param len - Maximum number of bytes to write.
+ * @return Number of bytes written or negative value in case of error.
+ */
+static int iio_read_xml(struct iiod_ctx *ctx, uint32_t offset, char *buf,
+			uint32_t len)
+{
+	struct iio_desc *desc = ctx->instance;
+	struct iio_xml_writer w;
+	struct iio_dev_priv *dev;
+	uint32_t i;
+	int32_t ret;
+
+	if (offset >= desc->xml_size)
+		return 0;
+
+	len = no_os_min(len, desc->xml_size - offset);
+	w.buf = buf;
+	w.start = offset;
+	w.len = len;
+	w.pos = 0;
+
+	iio_xml_put(&w, header, sizeof(header) - 1);
+	for (i = 0; i < desc->nb_devs && w.pos < offset + len; i++) {
+		dev = desc->devs + i;
+		/* Devices before the window don't need to be rendered */
+		if (w.pos + dev->xml_size <= offset) {
+			w.pos += dev->xml_size;
+			continue;
+		}
 
-	i += snprintf(buff + i, no_os_max(n - i, 0), "</device>");
+		ret = iio_generate_device_xml(&w, dev);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+	}
+	iio_xml_put(&w, header_end, sizeof(header_end) - 1);
 
-	return i;
+	return len;
 }
 
+/* Compute the size of the context xml. It is rendered on demand. */
 static int32_t iio_init_xml(struct iio_desc *desc)
 {
+	struct iio_xml_writer w = { 0 };
 	struct iio_dev_priv *dev;
-	uint32_t i, size, of;
+	uint32_t i, of;
+	int32_t ret;
 
 	/* -2 because of the 0 character */
-	size = sizeof(header) + sizeof(header_end) - 2;
+	desc->xml_size = sizeof(header) + sizeof(header_end) - 2;
 	for (i = 0; i < desc->nb_devs; i++) {
 		dev = desc->devs + i;
-		size += iio_generate_device_xml(dev->dev_descriptor,
-						(char *)dev->name,
-						dev->dev_id, NULL, -1);
+		of = w.pos;
+		ret = iio_generate_device_xml(&w, dev);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+
+		dev->xml_size = w.pos - of;
 	}
+	desc->xml_size += w.pos;
 
-	desc->xml_desc = (char *)calloc(size + 1, sizeof(*desc->xml_desc));
-	if (!desc->xml_desc)
-		return -ENOMEM;
+	return 0;
+}
+
+
+static uint32_t iio_count_attrs(struct iio_attribute *attrs)
+{
+	uint32_t n = 0;
+
+	while (attrs && attrs[n].name)
+		n++;
+
+	return n;
+}
 
-	desc->xml_size = size;
+static void iio_add_attrs(struct iio_desc *desc, uint32_t dev_idx,
+			  enum iio_attr_type type, struct iio_channel *ch,
+			  const char *ch_id, struct iio_attribute *attrs)
+{
+	struct iio_attr_entry *entry;
+	uint32_t hash, i, j;
+
+	for (j = 0; attrs && attrs[j].name; j++) {
+		hash = iio_attr_hash(dev_idx, type, ch_id, attrs[j].name);
+		i = hash & desc->attr_table_mask;
+		while (desc->attr_table[i].attr)
+			i = (i + 1) & desc->attr_table_mask;
+
+		entry = &desc->attr_table[i];
+		entry->hash = hash;
+		entry->attr = &attrs[j];
+		entry->ch = ch;
+		entry->dev_idx = dev_idx;
+		entry->type = type;
+	}
+}
+
+static void iio_free_lookup(struct iio_desc *desc)
+{
+	uint32_t i;
+
+	for (i = 0; i < desc->nb_devs; i++)
+		free(desc->devs[i].ch_ids);
+	free(desc->attr_table);
+}
+
+/**
+ * @brief Render channel ids and build the attribute lookup table so that
+ * attribute accesses don't need to search or format anything.
+ * @param desc - IIO descriptor with initialized devices.
+ * @return 0 in case of success or negative value otherwise.
+ */
+static int32_t iio_init_lookup(struct iio_desc *desc)
+{
+	struct iio_device *iio_dev;
+	struct iio_channel *ch;
+	uint32_t total = 0;
+	uint32_t size = 1;
+	uint32_t i, j;
 
-	strcpy(desc->xml_desc, header);
-	of = sizeof(header) - 1;
 	for (i = 0; i < desc->nb_devs; i++) {
-		dev = desc->devs + i;
-		of += iio_generate_device_xml(dev->dev_descriptor,
-					      (char *)dev->name, dev->dev_id,
-					      desc->xml_desc + of, size - of);
+		iio_dev = desc->devs[i].dev_descriptor;
+		total += iio_count_attrs(iio_dev->attributes) +
+			 iio_count_attrs(iio_dev->debug_attributes) +
+			 iio_count_attrs(iio_dev->buffer_attributes);
+		if (!iio_dev->channels || !iio_dev->num_ch)
+			continue;
+
+		desc->devs[i].ch_ids = calloc(iio_dev->num_ch,
+					      sizeof(*desc->devs[i].ch_ids));
+		if (!desc->devs[i].ch_ids)
+			goto error;
+
+		for (j = 0; j < iio_dev->num_ch; j++) {
+			ch = &iio_dev->channels[j];
+			_print_ch_id(desc->devs[i].ch_ids[j], ch);
+			total += iio_count_attrs(ch->attributes);
+		}
 	}
 
-	strcpy(desc->xml_desc + of, header_end);
+	/* Keep the load factor under 1/2 so probing stays short */
+	while (size < 2 * total)
+		size <<= 1;
+	desc->attr_table = calloc(size, sizeof(*desc->attr_table));
+	if (!desc->attr_table)
+		goto error;
+	desc->attr_table_mask = size - 1;
+
+	for (i = 0; i < desc->nb_devs; i++) {
+		iio_dev = desc->devs[i].dev_descriptor;
+		iio_add_attrs(desc, i, IIO_ATTR_TYPE_DEVICE, NULL, NULL,
+			      iio_dev->attributes);
+		iio_add_attrs(desc, i, IIO_ATTR_TYPE_DEBUG, NULL, NULL,
+			      iio_dev->debug_attributes);
+		iio_add_attrs(desc, i, IIO_ATTR_TYPE_BUFFER, NULL, NULL,
+			      iio_dev->buffer_attributes);
+		for (j = 0; iio_dev->channels && j < iio_dev->num_ch; j++) {
+			ch = &iio_dev->channels[j];
+			iio_add_attrs(desc, i, ch->ch_out ?
+				      IIO_ATTR_TYPE_CH_OUT : IIO_ATTR_TYPE_CH_IN,
+				      ch, desc->devs[i].ch_ids[j],
+				      ch->attributes);
+		}
+	}
 
 	return 0;
+error:
+	iio_free_lookup(desc);
+
+	return -ENOMEM;
+}
+
+static void iio_free_devs(struct iio_desc *desc)
+{
+	uint32_t i;
+
+	for (i = 0; i < desc->nb_devs; i++)
+		free(desc->devs[i].events.buff);
+	free(desc->trig_devs);
+	free(desc->devs);
+}
+
+/* Allocate the event FIFO of devices having channels with event specs */
+static int32_t iio_init_events(struct iio_dev_priv *dev)
+{
+	struct iio_device *iio_dev = dev->dev_descriptor;
+	uint32_t size = IIO_EVENTS_FIFO_SIZE * sizeof(struct iio_event_data);
+	uint8_t *buf;
+	uint32_t i;
+
+	for (i = 0; iio_dev->channels && i < iio_dev->num_ch; i++)
+		if (iio_dev->channels[i].num_event_specs)
+			break;
+	if (!iio_dev->channels || i == iio_dev->num_ch)
+		return 0;
+
+	buf = calloc(1, size);
+	if (!buf)
+		return -ENOMEM;
+
+	return no_os_spsc_ring_cfg(&dev->events, buf, size);
 }
 
 static int32_t iio_init_devs(struct iio_desc *desc,
-			     struct iio_device_init *devs, uint32_t n)
+			     struct iio_init_param *init_param)
 {
 	uint32_t i;
 	int32_t ret;
+	uint32_t n = init_param->nb_devs;
 	struct iio_dev_priv *ldev;
 	struct iio_device_init *ndev;
+	struct iio_device_init *devs = init_param->devs;
+	struct iio_trigger_init *ntrig;
 
-	desc->nb_devs = n;
+	desc->nb_trigs = init_param->trigs ? init_param->nb_trigs : 0;
+	desc->nb_devs = n + desc->nb_trigs;
 	desc->devs = (struct iio_dev_priv *)calloc(desc->nb_devs,
 			sizeof(*desc->devs));
 	if (!desc->devs)
 		return -ENOMEM;
 
+	if (desc->nb_trigs) {
+		desc->trig_devs = calloc(desc->nb_trigs,
+					 sizeof(*desc->trig_devs));
+		if (!desc->trig_devs) {
+			ret = -ENOMEM;
+			goto free_devs;
+		}
+	}
+
 	for (i = 0; i < n; i++) {
 		ndev = devs + i;
 		ldev = desc->devs + i;
@@ -1344,9 +2605,11 @@ static int32_t iio_init_devs(struct iio_desc *desc,
 		ldev->dev_data.dev = ndev->dev;
 		ldev->dev_data.buffer = &ldev->buffer.public;
 		ldev->name = ndev->name;
+		ldev->trig_idx = -1;
 		if (ndev->dev_descriptor->read_dev ||
 		    ndev->dev_descriptor->write_dev ||
-		    ndev->dev_descriptor->submit) {
+		    ndev->dev_descriptor->submit ||
+		    ndev->dev_descriptor->trigger_handler) {
 			ldev->buffer.raw_buf = ndev->raw_buf;
 			ldev->buffer.raw_buf_len = ndev->raw_buf_len;
 			ldev->buffer.public.buf = &ldev->buffer.cb;
@@ -1354,11 +2617,68 @@ static int32_t iio_init_devs(struct iio_desc *desc,
 		} else {
 			ldev->buffer.initalized = 0;
 		}
+
+		ret = iio_init_events(ldev);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			goto free_devs;
+	}
+
+	/* Triggers are devices with attributes only */
+	for (i = 0; i < desc->nb_trigs; i++) {
+		ntrig = init_param->trigs + i;
+		ldev = desc->devs + n + i;
+		if (!ntrig->descriptor) {
+			ret = -EINVAL;
+			goto free_devs;
+		}
+
+		desc->trig_devs[i].attributes = ntrig->descriptor->attributes;
+		ldev->dev_descriptor = &desc->trig_devs[i];
+		ldev->trig_descriptor = ntrig->descriptor;
+		sprintf(ldev->dev_id, "trigger%"PRIu32"", i);
+		ldev->dev_instance = ntrig->trig;
+		ldev->dev_data.dev = ntrig->trig;
+		ldev->name = ntrig->name;
+		ldev->trig_idx = -1;
+
+		/* The trigger gets what iio_process_trigger needs */
+		if (ntrig->descriptor->bind) {
+			ret = ntrig->descriptor->bind(ntrig->trig, desc, i);
+			if (NO_OS_IS_ERR_VALUE(ret))
+				goto free_devs;
+		}
 	}
 
+	for (i = 0; i < n; i++) {
+		if (!devs[i].trigger_id)
+			continue;
+
+		if (!devs[i].dev_descriptor->trigger_handler) {
+			ret = -EINVAL;
+			goto free_devs;
+		}
+
+		ret = iio_find_trigger(desc, devs[i].trigger_id);
+		if (ret < 0)
+			goto free_devs;
+
+		desc->devs[i].trig_idx = ret;
+	}
+
+	ret = iio_init_lookup(desc);
+	if (NO_OS_IS_ERR_VALUE(ret))
+		goto free_devs;
+
 	ret = iio_init_xml(desc);
 	if (NO_OS_IS_ERR_VALUE(ret))
-		free(desc->devs);
+		goto free_lookup;
+
+	return 0;
+
+free_lookup:
+	iio_free_lookup(desc);
+free_devs:
+	iio_free_devs(desc);
 
 	return ret;
 }
@@ -1385,7 +2705,9 @@ int iio_init(struct iio_desc **desc, struct iio_init_param *init_param)
 	if (!ldesc)
 		return -ENOMEM;
 
-	ret = iio_init_devs(ldesc, init_param->devs, init_param->nb_devs);
+	ldesc->get_timestamp = init_param->get_timestamp;
+	ldesc->timestamp_ctx = init_param->timestamp_ctx;
+	ret = iio_init_devs(ldesc, init_param);
 	if (NO_OS_IS_ERR_VALUE(ret))
 		goto free_desc;
 
@@ -1394,17 +2716,28 @@ int iio_init(struct iio_desc **desc, struct iio_init_param *init_param)
 	ops->read_attr = iio_read_attr;
 	ops->write_attr = iio_write_attr;
 	ops->read_buffer = iio_read_buffer;
+	ops->read_buffer_get = iio_read_buffer_get;
+	ops->read_buffer_done = iio_read_buffer_done;
+	ops->get_names = iio_get_names;
+	ops->get_buffer_info = iio_get_buffer_info;
+	ops->read_xml = iio_read_xml;
 	ops->write_buffer = iio_write_buffer;
 	ops->refill_buffer = iio_refill_buffer;
+	ops->set_buffers_count = iio_set_buffers_count;
 	ops->push_buffer = iio_push_buffer;
 	ops->open = iio_open_dev;
 	ops->close = iio_close_dev;
+	ops->get_trigger = iio_get_trigger;
+	ops->set_trigger = iio_set_trigger;
+	ops->open_events = iio_open_events;
+	ops->close_events = iio_close_events;
+	ops->read_event = iio_read_event;
 	ops->send = iio_send;
 	ops->recv = iio_recv;
 
 	iiod_param.instance = ldesc;
 	iiod_param.ops = ops;
-	iiod_param.xml = ldesc->xml_desc;
+	iiod_param.xml = NULL;
 	iiod_param.xml_len = ldesc->xml_size;
 
 	ret = iiod_init(&ldesc->iiod, &iiod_param);
@@ -1465,8 +2798,8 @@ free_conns:
 free_iiod:
 	iiod_remove(ldesc->iiod);
 free_devs:
-	free(ldesc->devs);
-	free(ldesc->xml_desc);
+	iio_free_lookup(ldesc);
+	iio_free_devs(ldesc);
 free_desc:
 	free(ldesc);
 
@@ -1488,8 +2821,8 @@ int iio_remove(struct iio_desc *desc)
 #endif
 	no_os_cb_remove(desc->conns);
 	iiod_remove(desc->iiod);
-	free(desc->devs);
-	free(desc->xml_desc);
+	iio_free_lookup(desc);
+	iio_free_devs(desc);
 	free(desc);
 
 	return 0;
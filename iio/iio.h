@@ -76,6 +76,15 @@ struct iio_device_init {
 	int8_t *raw_buf;
 	/* Length of raw_buf */
 	uint32_t raw_buf_len;
+	/* Id or name of the trigger used by default. May be NULL */
+	char *trigger_id;
+};
+
+struct iio_trigger_init {
+	char *name;
+	/* Trigger instance, passed to the iio_trigger callbacks */
+	void *trig;
+	struct iio_trigger *descriptor;
 };
 
 struct iio_init_param {
@@ -88,6 +97,15 @@ struct iio_init_param {
 	};
 	struct iio_device_init *devs;
 	uint32_t nb_devs;
+	struct iio_trigger_init *trigs;
+	uint32_t nb_trigs;
+	/*
+	 * Clock of the timestamp channels in ns, called with timestamp_ctx.
+	 * E.g. no_os_timer_get_elapsed_time_nsec with a running timer.
+	 * Optional, timestamps are 0 when not set.
+	 */
+	int32_t (*get_timestamp)(void *ctx, uint64_t *ns);
+	void *timestamp_ctx;
 };
 
 /******************************************************************************/
@@ -101,6 +119,12 @@ int iio_init(struct iio_desc **desc, struct iio_init_param *init_param);
 int iio_remove(struct iio_desc *desc);
 /* Execut an iio step. */
 int iio_step(struct iio_desc *desc);
+/* Call the trigger handler of the devices using trig_id. Called from ISR */
+int iio_process_trigger(struct iio_desc *desc, uint32_t trig_id);
+/* Queue an event of a channel of the device dev. Can be called from ISR */
+int iio_push_event(struct iio_desc *desc, void *dev, uint32_t ch_idx,
+		   enum iio_event_type type, enum iio_event_direction dir,
+		   int64_t timestamp);
 
 int32_t iio_parse_value(char *buf, enum iio_val fmt,
 			int32_t *val, int32_t *val2);
@@ -114,9 +138,12 @@ int iio_buffer_get_block(struct iio_buffer *buffer, void **addr);
 int iio_buffer_block_done(struct iio_buffer *buffer);
 
 /* Trigger buffer functions. */
-/* Write to buffer iio_buffer.bytes_per_scan bytes from data */
+/* Write a scan from data. The timestamp is added from iio_buffer.timestamp */
 int iio_buffer_push_scan(struct iio_buffer *buffer, void *data);
 /* Read from buffer iio_buffer.bytes_per_scan bytes into data */
 int iio_buffer_pop_scan(struct iio_buffer *buffer, void *data);
+/* Insert timestamps, interpolated between start and end, in a read block */
+int iio_buffer_add_timestamps(struct iio_buffer *buffer, void *block,
+			      uint32_t nb_scans, int64_t start, int64_t end);
 
 #endif /* IIO_H_ */
@@ -278,17 +278,35 @@ static int32_t irq_setup(struct no_os_irq_ctrl_desc **irq_desc)
 #endif
 
 int32_t iio_app_run(struct iio_app_device *devices, uint32_t len)
+{
+	struct iio_app_init_param param = {
+		.devices = devices,
+		.nb_devices = len,
+	};
+
+	return iio_app_run_with_param(&param);
+}
+
+int32_t iio_app_run_with_param(struct iio_app_init_param *param)
 {
 	int32_t			status;
 	struct iio_desc		*iio_desc;
-	struct iio_init_param	iio_init_param;
+	struct iio_init_param	iio_init_param = { 0 };
 	struct no_os_uart_desc	*uart_desc;
 	struct no_os_uart_init_param	*uart_init_par;
 	void			*irq_desc = NULL;
 	struct iio_device_init	*iio_init_devs;
+	struct iio_app_device	*devices;
+	uint32_t		len;
 	uint32_t		i;
 	struct iio_data_buffer *buff;
 
+	if (!param || !param->devices)
+		return -EINVAL;
+
+	devices = param->devices;
+	len = param->nb_devices;
+
 #if defined(ADUCM_PLATFORM) || (defined(XILINX_PLATFORM) && !defined(PLATFORM_MB))
 	/* Only one irq controller can exist and be initialized in
 	 * any of the iio_devices. */
@@ -341,6 +359,7 @@ int32_t iio_app_run(struct iio_app_device *devices, uint32_t len)
 		iio_init_devs[i].name = devices[i].name;
 		iio_init_devs[i].dev = devices[i].dev;
 		iio_init_devs[i].dev_descriptor = devices[i].dev_descriptor;
+		iio_init_devs[i].trigger_id = devices[i].trigger_id;
 		buff = devices[i].read_buff ? devices[i].read_buff :
 		       devices[i].write_buff;
 		if (buff) {
@@ -354,12 +373,17 @@ int32_t iio_app_run(struct iio_app_device *devices, uint32_t len)
 
 	iio_init_param.devs = iio_init_devs;
 	iio_init_param.nb_devs = len;
+	iio_init_param.trigs = param->trigs;
+	iio_init_param.nb_trigs = param->nb_trigs;
 	status = iio_init(&iio_desc, &iio_init_param);
 	if(status < 0)
 		goto error;
 
 	free(iio_init_devs);
 
+	if (param->desc)
+		*param->desc = iio_desc;
+
 	do {
 		status = iio_step(iio_desc);
 	} while (true);
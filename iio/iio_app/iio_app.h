@@ -61,6 +61,22 @@ struct iio_app_device {
 	struct iio_device *dev_descriptor;
 	struct iio_data_buffer *read_buff;
 	struct iio_data_buffer *write_buff;
+	/* Id or name of the trigger used by default. May be NULL */
+	char *trigger_id;
+};
+
+struct iio_app_init_param {
+	/* Devices to register to iiod */
+	struct iio_app_device *devices;
+	uint32_t nb_devices;
+	/* Triggers the devices may use. May be NULL */
+	struct iio_trigger_init *trigs;
+	uint32_t nb_trigs;
+	/*
+	 * Set to the iio descriptor once it is initialized, e.g. for pushing
+	 * events from interrupts. May be NULL
+	 */
+	struct iio_desc **desc;
 };
 
 /**
@@ -73,4 +89,13 @@ struct iio_app_device {
  */
 int32_t iio_app_run(struct iio_app_device *devices, uint32_t len);
 
+/**
+ * @brief Register devices and triggers and start an iio application
+ *
+ * Configuration for communication is done in parameters.h
+ * @param param - devices and triggers to register to iiod
+ * @return 0 on success, negative value otherwise
+ */
+int32_t iio_app_run_with_param(struct iio_app_init_param *param);
+
 #endif
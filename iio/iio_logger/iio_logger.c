@@ -0,0 +1,555 @@
+/***************************************************************************//**
+ *   @file   iio_logger.c
+ *   @brief  Log IIO device buffers to FatFs files
+********************************************************************************
+ * Copyright 2022(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "iio_logger.h"
+#include "iio.h"
+#include "diskio.h"
+#include "no_os_error.h"
+#include "no_os_util.h"
+
+#if !FF_USE_EXPAND
+#error "iio_logger needs f_expand(), add -DFF_USE_EXPAND=1 to the CFLAGS"
+#endif
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+#if FF_MAX_SS == FF_MIN_SS
+#define IIO_LOGGER_SECTOR_SIZE(fs)	FF_MAX_SS
+#else
+#define IIO_LOGGER_SECTOR_SIZE(fs)	((fs)->ssize)
+#endif
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Convert a FatFs result to a negative error code.
+ * @param res - FatFs result.
+ * @return 0 for FR_OK, negative error code otherwise.
+ */
+static int iio_logger_fresult(FRESULT res)
+{
+	switch (res) {
+	case FR_OK:
+		return 0;
+	case FR_DENIED:
+		/* f_expand() couldn't find enough contiguous space */
+		return -ENOSPC;
+	case FR_NOT_READY:
+		return -ENODEV;
+	case FR_INVALID_PARAMETER:
+		return -EINVAL;
+	default:
+		return -EIO;
+	}
+}
+
+/**
+ * @brief Count the logged channels.
+ * @param desc - Logger descriptor.
+ * @return Number of channels set in the mask.
+ */
+static uint32_t iio_logger_nb_channels(struct iio_logger *desc)
+{
+	uint32_t mask = desc->mask;
+	uint32_t cnt = 0;
+
+	for (; mask; mask >>= 1)
+		cnt += mask & 1;
+
+	return cnt;
+}
+
+/**
+ * @brief Compute the size of a scan for the active channels.
+ * @param desc - Logger descriptor.
+ * @return Number of bytes per scan.
+ */
+static uint32_t iio_logger_bytes_per_scan(struct iio_logger *desc)
+{
+	struct iio_channel *ch = desc->dev_descriptor->channels;
+	uint32_t mask = desc->mask;
+	uint32_t cnt = 0;
+
+	for (; mask; mask >>= 1, ch++)
+		if (mask & 1)
+			cnt += ch->scan_type->storagebits / 8;
+
+	return cnt;
+}
+
+/**
+ * @brief Write the file header. It holds the scan format of every logged
+ * channel and is padded to header_size, so data starts cluster aligned.
+ * @param desc - Logger descriptor.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int iio_logger_write_header(struct iio_logger *desc)
+{
+	uint8_t buf[no_os_max(IIO_LOGGER_HEADER_LEN, IIO_LOGGER_CHANNEL_LEN)];
+	struct iio_channel *ch;
+	uint32_t i;
+	FRESULT res;
+	UINT bw;
+
+	memset(buf, 0, sizeof(buf));
+	no_os_put_unaligned_le32(IIO_LOGGER_MAGIC, &buf[0]);
+	no_os_put_unaligned_le16(IIO_LOGGER_VERSION, &buf[4]);
+	no_os_put_unaligned_le16(iio_logger_nb_channels(desc), &buf[6]);
+	no_os_put_unaligned_le32(desc->header_size, &buf[8]);
+	no_os_put_unaligned_le32(desc->buffer.bytes_per_scan, &buf[12]);
+	no_os_put_unaligned_le32(desc->file_index, &buf[16]);
+	res = f_write(&desc->file, buf, IIO_LOGGER_HEADER_LEN, &bw);
+	if (res != FR_OK || bw != IIO_LOGGER_HEADER_LEN)
+		return res != FR_OK ? iio_logger_fresult(res) : -ENOSPC;
+
+	for (i = 0; i < desc->dev_descriptor->num_ch; i++) {
+		if (!(desc->mask & NO_OS_BIT(i)))
+			continue;
+
+		ch = &desc->dev_descriptor->channels[i];
+		memset(buf, 0, sizeof(buf));
+		no_os_put_unaligned_le16(ch->scan_index, &buf[0]);
+		no_os_put_unaligned_le16(ch->ch_type, &buf[2]);
+		no_os_put_unaligned_le16(ch->channel, &buf[4]);
+		buf[6] = ch->scan_type->sign;
+		buf[7] = ch->scan_type->realbits;
+		buf[8] = ch->scan_type->storagebits;
+		buf[9] = ch->scan_type->shift;
+		buf[10] = ch->scan_type->is_big_endian;
+		res = f_write(&desc->file, buf, IIO_LOGGER_CHANNEL_LEN, &bw);
+		if (res != FR_OK || bw != IIO_LOGGER_CHANNEL_LEN)
+			return res != FR_OK ? iio_logger_fresult(res) : -ENOSPC;
+	}
+
+	return iio_logger_fresult(f_lseek(&desc->file, desc->header_size));
+}
+
+/**
+ * @brief Tell the disk that the next len bytes of the current file are going
+ * to be written sequentially, so the SD card can pre-erase them when the
+ * write session is opened. A len of 0 clears the declared area.
+ * @param desc - Logger descriptor.
+ * @param len - Bytes that will be written, multiple of the sector size.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int iio_logger_declare_prealloc(struct iio_logger *desc, uint32_t len)
+{
+	uint32_t ssize = IIO_LOGGER_SECTOR_SIZE(desc->fs);
+	FATFS *fs = desc->fs;
+	LBA_t range[2];
+
+	/* The file is contiguous, expanded by f_expand() */
+	range[0] = fs->database +
+		   (LBA_t)(desc->file.obj.sclust - 2) * fs->csize +
+		   (desc->header_size + desc->file_written) / ssize;
+	range[1] = len / ssize;
+	if (disk_ioctl(fs->pdrv, MMC_SET_PREALLOC, range) != RES_OK)
+		return -EIO;
+
+	return 0;
+}
+
+/**
+ * @brief Create the next file and preallocate it as a contiguous area.
+ * @param desc - Logger descriptor.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int iio_logger_open_file(struct iio_logger *desc)
+{
+	char name[IIO_LOGGER_MAX_PATH];
+	FRESULT res;
+	int ret;
+
+	snprintf(name, sizeof(name), desc->file_name_fmt,
+		 (unsigned int)desc->file_index);
+
+	res = f_open(&desc->file, name, FA_CREATE_ALWAYS | FA_WRITE);
+	if (res != FR_OK)
+		return iio_logger_fresult(res);
+	desc->file_open = true;
+	desc->file_written = 0;
+
+	res = f_expand(&desc->file, desc->header_size + desc->file_size, 1);
+	if (res != FR_OK) {
+		ret = iio_logger_fresult(res);
+		goto error;
+	}
+
+	ret = iio_logger_write_header(desc);
+	if (ret)
+		goto error;
+
+	return 0;
+error:
+	f_close(&desc->file);
+	desc->file_open = false;
+
+	return ret;
+}
+
+/**
+ * @brief Close the current file. A file closed before being full is
+ * truncated to the data written.
+ * @param desc - Logger descriptor.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int iio_logger_close_file(struct iio_logger *desc)
+{
+	FRESULT res;
+	int ret;
+
+	if (!desc->file_open)
+		return 0;
+
+	desc->file_open = false;
+	/* Clusters freed by the truncate may later belong to another file */
+	ret = iio_logger_declare_prealloc(desc, 0);
+	if (ret) {
+		f_close(&desc->file);
+		return ret;
+	}
+
+	res = f_truncate(&desc->file);
+	if (res != FR_OK) {
+		f_close(&desc->file);
+		return iio_logger_fresult(res);
+	}
+
+	return iio_logger_fresult(f_close(&desc->file));
+}
+
+/**
+ * @brief Write one buffered block to the current file. A file is closed when
+ * full and the next one is created by the next write, so no empty file is
+ * left when logging stops.
+ * @param desc - Logger descriptor.
+ * @param buffered - Bytes in the circular buffer, all of them to be written.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int iio_logger_write_block(struct iio_logger *desc, uint32_t buffered)
+{
+	uint32_t size;
+	FRESULT res;
+	void *buff;
+	UINT bw;
+	int ret;
+
+	if (!desc->file_open) {
+		ret = iio_logger_open_file(desc);
+		if (ret)
+			return ret;
+	}
+
+	/* Only the whole blocks already buffered are sure to be written */
+	size = buffered - buffered % desc->block_size;
+	ret = iio_logger_declare_prealloc(desc,
+					  no_os_min(size, desc->file_size -
+						    desc->file_written));
+	if (ret)
+		return ret;
+
+	ret = no_os_cb_prepare_async_read(&desc->cb, desc->block_size, &buff,
+					  &size);
+	if (ret)
+		return ret;
+
+	res = f_write(&desc->file, buff, desc->block_size, &bw);
+	no_os_cb_end_async_read(&desc->cb);
+	if (res != FR_OK)
+		return iio_logger_fresult(res);
+	if (bw != desc->block_size)
+		return -ENOSPC;
+
+	desc->file_written += desc->block_size;
+	if (desc->file_written < desc->file_size)
+		return 0;
+
+	ret = iio_logger_close_file(desc);
+	if (ret)
+		return ret;
+
+	desc->file_index++;
+
+	return 0;
+}
+
+/**
+ * @brief Acquire one block from the device into the circular buffer.
+ * @param desc - Logger descriptor.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int iio_logger_read_block(struct iio_logger *desc)
+{
+	struct iio_device *dev = desc->dev_descriptor;
+	uint32_t nb_scans;
+	void *buff;
+	int ret;
+
+	if (dev->submit)
+		return dev->submit(&desc->dev_data);
+
+	ret = iio_buffer_get_block(&desc->buffer, &buff);
+	if (ret)
+		return ret;
+
+	nb_scans = desc->block_size / desc->buffer.bytes_per_scan;
+	ret = dev->read_dev(desc->dev, buff, nb_scans);
+	if (NO_OS_IS_ERR_VALUE(ret))
+		return ret;
+
+	return iio_buffer_block_done(&desc->buffer);
+}
+
+/**
+ * @brief Allocate and configure a logger. Files are written to the FatFs
+ * volume in blocks of whole clusters and whole scans, into files
+ * preallocated with f_expand(), so FatFs doesn't need to update the FAT while
+ * logging. The volume must be mounted and FF_USE_EXPAND enabled.
+ * @param desc - Where the logger descriptor is stored.
+ * @param param - Logger parameters.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int iio_logger_init(struct iio_logger **desc,
+		    struct iio_logger_init_param *param)
+{
+	struct iio_logger *ldesc;
+	uint32_t num_ch;
+
+	if (!desc || !param || !param->dev_descriptor || !param->fs ||
+	    !param->file_name_fmt || !param->buff || !param->file_size)
+		return -EINVAL;
+
+	if (!param->dev_descriptor->submit && !param->dev_descriptor->read_dev)
+		return -ENOTSUP;
+
+	num_ch = param->dev_descriptor->num_ch;
+	if (!param->mask || !num_ch || num_ch > 32 ||
+	    (num_ch < 32 && (param->mask >> num_ch)))
+		return -EINVAL;
+
+	ldesc = calloc(1, sizeof(*ldesc));
+	if (!ldesc)
+		return -ENOMEM;
+
+	ldesc->dev = param->dev;
+	ldesc->dev_descriptor = param->dev_descriptor;
+	ldesc->fs = param->fs;
+	ldesc->file_name_fmt = param->file_name_fmt;
+	ldesc->buff = param->buff;
+	ldesc->buff_size = param->buff_size;
+	ldesc->mask = param->mask;
+	ldesc->req_file_size = param->file_size;
+	ldesc->dev_data.dev = param->dev;
+	ldesc->dev_data.buffer = &ldesc->buffer;
+
+	*desc = ldesc;
+
+	return 0;
+}
+
+/**
+ * @brief Free the resources allocated by iio_logger_init().
+ * @param desc - Logger descriptor.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int iio_logger_remove(struct iio_logger *desc)
+{
+	if (!desc)
+		return -EINVAL;
+
+	if (desc->started)
+		iio_logger_stop(desc);
+
+	free(desc);
+
+	return 0;
+}
+
+/**
+ * @brief Enable the device buffer and open the first file.
+ * @param desc - Logger descriptor.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int iio_logger_start(struct iio_logger *desc)
+{
+	uint32_t bytes_per_scan;
+	uint32_t nb_blocks;
+	int ret;
+
+	if (!desc)
+		return -EINVAL;
+
+	if (desc->started)
+		return -EBUSY;
+
+	/* Smallest block made of whole clusters and whole scans */
+	bytes_per_scan = iio_logger_bytes_per_scan(desc);
+	if (!bytes_per_scan)
+		return -EINVAL;
+	desc->cluster_size = (uint32_t)desc->fs->csize *
+			     IIO_LOGGER_SECTOR_SIZE(desc->fs);
+	desc->block_size = desc->cluster_size /
+			   no_os_greatest_common_divisor(desc->cluster_size,
+					   bytes_per_scan) * bytes_per_scan;
+	desc->header_size = no_os_round_up(IIO_LOGGER_HEADER_LEN +
+					   IIO_LOGGER_CHANNEL_LEN *
+					   iio_logger_nb_channels(desc),
+					   desc->cluster_size) *
+			    desc->cluster_size;
+	desc->file_size = no_os_round_up(desc->req_file_size,
+					 desc->block_size) * desc->block_size;
+
+	/* At least two blocks, one written to file while the other is filled */
+	nb_blocks = desc->buff_size / desc->block_size;
+	if (nb_blocks < 2)
+		return -ENOMEM;
+
+	ret = no_os_cb_cfg(&desc->cb, (int8_t *)desc->buff,
+			   nb_blocks * desc->block_size);
+	if (ret)
+		return ret;
+
+	desc->buffer.active_mask = desc->mask;
+	desc->buffer.size = desc->block_size;
+	desc->buffer.bytes_per_scan = bytes_per_scan;
+	desc->buffer.dir = IIO_DIRECTION_INPUT;
+	desc->buffer.buf = &desc->cb;
+
+	if (desc->dev_descriptor->pre_enable) {
+		ret = desc->dev_descriptor->pre_enable(desc->dev, desc->mask);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+	}
+
+	desc->file_index = 0;
+	desc->acquiring = false;
+	ret = iio_logger_open_file(desc);
+	if (ret)
+		goto disable;
+
+	desc->started = true;
+
+	return 0;
+disable:
+	if (desc->dev_descriptor->post_disable)
+		desc->dev_descriptor->post_disable(desc->dev);
+
+	return ret;
+}
+
+/**
+ * @brief Acquire one block and write one block to the current file. The
+ * capture of the next block is started before the previous block is written,
+ * so a device capturing in the background fills it during the write. A
+ * device submit returning -EAGAIN has started a capture that isn't finished
+ * yet; it is called again by the next steps until it completes. Should be
+ * called in a loop at least as fast as the device fills blocks.
+ * @param desc - Logger descriptor.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int iio_logger_step(struct iio_logger *desc)
+{
+	uint32_t size;
+	int ret;
+
+	if (!desc || !desc->started)
+		return -EINVAL;
+
+	ret = no_os_cb_size(&desc->cb, &size);
+	if (ret)
+		return ret;
+
+	if (desc->acquiring || desc->cb.size - size >= desc->block_size) {
+		ret = iio_logger_read_block(desc);
+		desc->acquiring = (ret == -EAGAIN);
+		if (NO_OS_IS_ERR_VALUE(ret) && !desc->acquiring)
+			return ret;
+	}
+
+	if (size >= desc->block_size)
+		return iio_logger_write_block(desc, size);
+
+	return 0;
+}
+
+/**
+ * @brief Write the buffered data, disable the device buffer and close the
+ * current file.
+ * @param desc - Logger descriptor.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int iio_logger_stop(struct iio_logger *desc)
+{
+	uint32_t size;
+	int ret = 0;
+	int ret2;
+
+	if (!desc || !desc->started)
+		return -EINVAL;
+
+	desc->started = false;
+	/* A capture not finished yet is dropped */
+	desc->acquiring = false;
+
+	if (desc->dev_descriptor->post_disable)
+		ret = desc->dev_descriptor->post_disable(desc->dev);
+
+	while (!no_os_cb_size(&desc->cb, &size) && size >= desc->block_size) {
+		ret2 = iio_logger_write_block(desc, size);
+		if (ret2) {
+			ret = ret2;
+			break;
+		}
+	}
+
+	ret2 = iio_logger_close_file(desc);
+
+	return ret ? ret : ret2;
+}
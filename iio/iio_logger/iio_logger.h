@@ -0,0 +1,164 @@
+/***************************************************************************//**
+ *   @file   iio_logger.h
+ *   @brief  Header file of iio_logger
+********************************************************************************
+ * Copyright 2022(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifndef IIO_LOGGER_H_
+#define IIO_LOGGER_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "iio_types.h"
+#include "no_os_circular_buffer.h"
+#include "ff.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/** Magic number at the beginning of every log file: "IIOL" */
+#define IIO_LOGGER_MAGIC		0x4C4F4949u
+#define IIO_LOGGER_VERSION		1u
+/** Size of the fixed part of the file header */
+#define IIO_LOGGER_HEADER_LEN		24u
+/** Size of the header entry describing one channel */
+#define IIO_LOGGER_CHANNEL_LEN		16u
+#define IIO_LOGGER_MAX_PATH		32u
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct iio_logger_init_param
+ * @brief Parameters for iio_logger_init()
+ */
+struct iio_logger_init_param {
+	/** Device instance, passed to the device callbacks */
+	void			*dev;
+	/**
+	 * Device descriptor, must implement submit or read_dev. submit may
+	 * return -EAGAIN when it started capturing the block in the background,
+	 * in which case it is called again until it returns 0.
+	 */
+	struct iio_device	*dev_descriptor;
+	/** Mask of the channels to be logged */
+	uint32_t		mask;
+	/** Mounted FatFs volume where the files are written */
+	FATFS			*fs;
+	/**
+	 * snprintf() format of the file names, with one unsigned conversion
+	 * for the file index. E.g. "LOG%05u.BIN"
+	 */
+	const char		*file_name_fmt;
+	/** Data bytes per file, rounded up to a multiple of the block size */
+	uint32_t		file_size;
+	/** Memory used to buffer the data, must hold at least two blocks */
+	uint8_t			*buff;
+	/** Size of buff in bytes */
+	uint32_t		buff_size;
+};
+
+/**
+ * @struct iio_logger
+ * @brief IIO logger descriptor
+ */
+struct iio_logger {
+	/** Device instance */
+	void			*dev;
+	/** Device descriptor */
+	struct iio_device	*dev_descriptor;
+	/** Buffer passed to the device submit callback */
+	struct iio_buffer	buffer;
+	/** Device data passed to the device submit callback */
+	struct iio_device_data	dev_data;
+	/** Circular buffer holding the blocks not yet written to file */
+	struct no_os_circular_buffer	cb;
+	/** Mounted FatFs volume */
+	FATFS			*fs;
+	/** File being written */
+	FIL			file;
+	/** File names format */
+	const char		*file_name_fmt;
+	/** Memory used to buffer the data */
+	uint8_t			*buff;
+	/** Size of buff in bytes */
+	uint32_t		buff_size;
+	/** Mask of the logged channels */
+	uint32_t		mask;
+	/** Requested data bytes per file */
+	uint32_t		req_file_size;
+	/** Data bytes per file */
+	uint32_t		file_size;
+	/** Data bytes written to the current file */
+	uint32_t		file_written;
+	/** Index of the current file */
+	uint32_t		file_index;
+	/** Size of the header, data starts at this offset in each file */
+	uint32_t		header_size;
+	/** Bytes per cluster of the volume */
+	uint32_t		cluster_size;
+	/** Bytes acquired with one submit and written with one f_write */
+	uint32_t		block_size;
+	/** Set while the capture of a block started by submit is not done */
+	bool			acquiring;
+	/** Set while a file is open */
+	bool			file_open;
+	/** Set between iio_logger_start() and iio_logger_stop() */
+	bool			started;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+/* Allocate and configure a logger. */
+int iio_logger_init(struct iio_logger **desc,
+		    struct iio_logger_init_param *param);
+/* Free the resources allocated by iio_logger_init(). */
+int iio_logger_remove(struct iio_logger *desc);
+/* Enable the device buffer and open the first file. */
+int iio_logger_start(struct iio_logger *desc);
+/* Acquire one block and write one block to the current file. */
+int iio_logger_step(struct iio_logger *desc);
+/* Write the buffered data, disable the device buffer and close the file. */
+int iio_logger_stop(struct iio_logger *desc);
+
+#endif /* IIO_LOGGER_H_ */
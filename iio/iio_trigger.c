@@ -0,0 +1,210 @@
+/***************************************************************************//**
+ *   @file   iio_trigger.c
+ *   @brief  Implementation of iio_trigger
+********************************************************************************
+ * Copyright 2022(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <errno.h>
+#include <stdlib.h>
+#include "iio_trigger.h"
+
+/******************************************************************************/
+/************************ Variable Declarations *******************************/
+/******************************************************************************/
+
+struct iio_trigger iio_hw_trig_desc = {
+	.enable = iio_hw_trig_enable,
+	.disable = iio_hw_trig_disable,
+	.bind = iio_hw_trig_bind,
+};
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/* Called in interrupt context. Reads a scan from each device using trig */
+static void iio_hw_trig_handler(void *ctx, uint32_t event, void *extra)
+{
+	struct iio_hw_trig *trig = ctx;
+
+	if (trig->iio_desc)
+		iio_process_trigger(trig->iio_desc, trig->trig_id);
+}
+
+/**
+ * @brief Initialize a trigger driven by an interrupt. The interrupt stays
+ * disabled until a buffer using the trigger is enabled.
+ * @param trig - Where the trigger is stored.
+ * @param init_param - Trigger parameters.
+ * @return 0 in case of success or negative value otherwise.
+ */
+int iio_hw_trig_init(struct iio_hw_trig **trig,
+		     struct iio_hw_trig_init_param *init_param)
+{
+	struct iio_hw_trig *ltrig;
+	int ret;
+
+	if (!trig || !init_param || !init_param->irq_ctrl)
+		return -EINVAL;
+
+	ltrig = (struct iio_hw_trig *)calloc(1, sizeof(*ltrig));
+	if (!ltrig)
+		return -ENOMEM;
+
+	ltrig->irq_ctrl = init_param->irq_ctrl;
+	ltrig->irq_id = init_param->irq_id;
+	ltrig->timer = init_param->timer;
+	ltrig->cb.callback = iio_hw_trig_handler;
+	ltrig->cb.ctx = ltrig;
+
+	ret = no_os_irq_disable(ltrig->irq_ctrl, ltrig->irq_id);
+	if (ret)
+		goto free_trig;
+
+	ret = no_os_irq_trigger_level_set(ltrig->irq_ctrl, ltrig->irq_id,
+					  init_param->irq_trig_lvl);
+	if (ret)
+		goto free_trig;
+
+	ret = no_os_irq_register_callback(ltrig->irq_ctrl, ltrig->irq_id,
+					  &ltrig->cb);
+	if (ret)
+		goto free_trig;
+
+	*trig = ltrig;
+
+	return 0;
+
+free_trig:
+	free(ltrig);
+
+	return ret;
+}
+
+/**
+ * @brief Free the resources allocated by iio_hw_trig_init().
+ * @param trig - Trigger descriptor.
+ * @return 0 in case of success or negative value otherwise.
+ */
+int iio_hw_trig_remove(struct iio_hw_trig *trig)
+{
+	int ret;
+
+	if (!trig)
+		return -EINVAL;
+
+	ret = iio_hw_trig_disable(trig);
+	if (ret)
+		return ret;
+
+	ret = no_os_irq_unregister(trig->irq_ctrl, trig->irq_id);
+	if (ret)
+		return ret;
+
+	free(trig);
+
+	return 0;
+}
+
+/**
+ * @brief Enable the interrupt of the trigger and start the timer, if any.
+ * @param trig - Trigger descriptor.
+ * @return 0 in case of success or negative value otherwise.
+ */
+int iio_hw_trig_enable(void *trig)
+{
+	struct iio_hw_trig *ltrig = trig;
+	int ret;
+
+	if (!ltrig)
+		return -EINVAL;
+
+	ret = no_os_irq_enable(ltrig->irq_ctrl, ltrig->irq_id);
+	if (ret || !ltrig->timer)
+		return ret;
+
+	ret = no_os_timer_start(ltrig->timer);
+	if (ret)
+		no_os_irq_disable(ltrig->irq_ctrl, ltrig->irq_id);
+
+	return ret;
+}
+
+/**
+ * @brief Stop the timer of the trigger, if any, and disable the interrupt.
+ * @param trig - Trigger descriptor.
+ * @return 0 in case of success or negative value otherwise.
+ */
+int iio_hw_trig_disable(void *trig)
+{
+	struct iio_hw_trig *ltrig = trig;
+	int ret;
+
+	if (!ltrig)
+		return -EINVAL;
+
+	if (ltrig->timer) {
+		ret = no_os_timer_stop(ltrig->timer);
+		if (ret)
+			return ret;
+	}
+
+	return no_os_irq_disable(ltrig->irq_ctrl, ltrig->irq_id);
+}
+
+/**
+ * @brief Store what the interrupt handler passes to iio_process_trigger().
+ * Called by iio_init().
+ * @param trig - Trigger descriptor.
+ * @param desc - IIO descriptor.
+ * @param trig_id - Index of the trigger in iio_init_param.trigs.
+ * @return 0 in case of success or negative value otherwise.
+ */
+int iio_hw_trig_bind(void *trig, struct iio_desc *desc, uint32_t trig_id)
+{
+	struct iio_hw_trig *ltrig = trig;
+
+	if (!ltrig || !desc)
+		return -EINVAL;
+
+	ltrig->trig_id = trig_id;
+	ltrig->iio_desc = desc;
+
+	return 0;
+}
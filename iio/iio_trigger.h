@@ -0,0 +1,109 @@
+/***************************************************************************//**
+ *   @file   iio_trigger.h
+ *   @brief  Header file of iio_trigger
+********************************************************************************
+ * Copyright 2022(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifndef IIO_TRIGGER_H_
+#define IIO_TRIGGER_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include "iio.h"
+#include "no_os_irq.h"
+#include "no_os_timer.h"
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct iio_hw_trig_init_param
+ * @brief Parameters of a trigger driven by an interrupt. It can be a GPIO
+ * interrupt (e.g. the data ready signal of a sensor) or the periodic interrupt
+ * of a timer.
+ */
+struct iio_hw_trig_init_param {
+	/** Interrupt controller */
+	struct no_os_irq_ctrl_desc *irq_ctrl;
+	/** Interrupt generating the trigger */
+	uint32_t irq_id;
+	/** Trigger level of the interrupt */
+	enum no_os_irq_trig_level irq_trig_lvl;
+	/** Timer generating irq_id. NULL for GPIO triggers */
+	struct no_os_timer_desc *timer;
+};
+
+/**
+ * @struct iio_hw_trig
+ * @brief Trigger driven by an interrupt
+ */
+struct iio_hw_trig {
+	/** IIO descriptor. Set by iio_init() */
+	struct iio_desc *iio_desc;
+	/** Index of the trigger in iio_init_param.trigs */
+	uint32_t trig_id;
+	/** Interrupt controller */
+	struct no_os_irq_ctrl_desc *irq_ctrl;
+	/** Interrupt generating the trigger */
+	uint32_t irq_id;
+	/** Timer generating irq_id. NULL for GPIO triggers */
+	struct no_os_timer_desc *timer;
+	/** Callback registered for irq_id */
+	struct no_os_callback_desc cb;
+};
+
+/* Trigger callbacks to be used in iio_trigger_init with an iio_hw_trig */
+extern struct iio_trigger iio_hw_trig_desc;
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+/* Initialize a trigger driven by an interrupt */
+int iio_hw_trig_init(struct iio_hw_trig **trig,
+		     struct iio_hw_trig_init_param *init_param);
+/* Free the resources allocated by iio_hw_trig_init() */
+int iio_hw_trig_remove(struct iio_hw_trig *trig);
+/* Enable the interrupt and start the timer, if any */
+int iio_hw_trig_enable(void *trig);
+/* Stop the timer, if any, and disable the interrupt */
+int iio_hw_trig_disable(void *trig);
+/* Store the IIO descriptor and the index of the trigger */
+int iio_hw_trig_bind(void *trig, struct iio_desc *desc, uint32_t trig_id);
+
+#endif /* IIO_TRIGGER_H_ */
@@ -46,6 +46,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include "no_os_circular_buffer.h"
+#include "no_os_spsc_ring.h"
 
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
@@ -74,7 +75,8 @@ enum iio_chan_type {
 	IIO_ANGL_VEL,
 	IIO_TEMP,
 	IIO_CAPACITANCE,
-	IIO_ACCEL
+	IIO_ACCEL,
+	IIO_TIMESTAMP
 };
 
 /**
@@ -88,6 +90,53 @@ enum iio_modifier {
 	IIO_MOD_Z,
 };
 
+/**
+ * @enum iio_event_type
+ * @brief Type of an event. Same values as in Linux, they are part of the
+ * event code sent to clients.
+ */
+enum iio_event_type {
+	IIO_EV_TYPE_THRESH,
+	IIO_EV_TYPE_MAG,
+	IIO_EV_TYPE_ROC,
+	IIO_EV_TYPE_THRESH_ADAPTIVE,
+	IIO_EV_TYPE_MAG_ADAPTIVE,
+	IIO_EV_TYPE_CHANGE,
+};
+
+/**
+ * @enum iio_event_direction
+ * @brief Direction of an event. Same values as in Linux.
+ */
+enum iio_event_direction {
+	IIO_EV_DIR_EITHER,
+	IIO_EV_DIR_RISING,
+	IIO_EV_DIR_FALLING,
+	IIO_EV_DIR_NONE,
+};
+
+/**
+ * @struct iio_event_spec
+ * @brief Event that can be generated by a channel
+ */
+struct iio_event_spec {
+	/** Type of the event */
+	enum iio_event_type type;
+	/** Direction of the event */
+	enum iio_event_direction dir;
+};
+
+/**
+ * @struct iio_event_data
+ * @brief Event as sent to clients. Same layout as the Linux IIO events.
+ */
+struct iio_event_data {
+	/** Event code, encoding channel, type and direction */
+	uint64_t id;
+	/** Timestamp of the event, 0 if not available */
+	int64_t timestamp;
+};
+
 /**
  * @struct iio_ch_info
  * @brief Structure holding channel attributess.
@@ -176,6 +225,10 @@ struct iio_channel {
 	struct scan_type	*scan_type;
 	/** Array of attributes. Last one should have its name set to NULL */
 	struct iio_attribute	*attributes;
+	/** Events the channel can generate with iio_push_event() */
+	struct iio_event_spec	*event_specs;
+	/** Number of event_specs */
+	uint32_t		num_event_specs;
 	/** if true, the channel is an output channel */
 	bool			ch_out;
 	/** Set if channel has a modifier. Use channel2 property to
@@ -188,6 +241,23 @@ struct iio_channel {
 	bool			diferential;
 };
 
+/*
+ * Timestamp channel. Has to be the last channel of the device. The timestamp
+ * is added to each scan by the IIO core, devices don't see its bit in the
+ * masks and read/push scans without it. Only available to devices using a
+ * trigger or read_dev, it can't be enabled for devices using submit.
+ */
+#define IIO_CHAN_SOFT_TIMESTAMP(_si) {\
+	.ch_type = IIO_TIMESTAMP,\
+	.channel = -1,\
+	.scan_index = _si,\
+	.scan_type = &(struct scan_type) {\
+		.sign = 's',\
+		.realbits = 64,\
+		.storagebits = 64,\
+	},\
+}
+
 enum iio_buffer_direction {
 	IIO_DIRECTION_INPUT,
 	IIO_DIRECTION_OUTPUT
@@ -202,8 +272,26 @@ struct iio_buffer {
 	uint32_t bytes_per_scan;
 	/* Buffer direction */
 	enum iio_buffer_direction dir;
+	/*
+	 * Output buffer played in a loop. Only the first block is pushed, the
+	 * device has to repeat it until post_disable is called.
+	 */
+	bool cyclic;
+	/*
+	 * Bytes added by the IIO core at the end of each scan for the
+	 * timestamp channel, padding included. 0 if the channel is disabled.
+	 * Included in bytes_per_scan.
+	 */
+	uint32_t timestamp_size;
+	/* Timestamp in ns of the trigger being handled, for push_scan */
+	int64_t timestamp;
 	/* Buffer where data is stored */
 	struct no_os_circular_buffer *buf;
+	/*
+	 * Set while the trigger handler is called from interrupt. Scans are
+	 * pushed here and moved to buf by the main loop.
+	 */
+	struct no_os_spsc_ring *trig_ring;
 };
 
 struct iio_device_data {
@@ -247,6 +335,11 @@ struct iio_device {
 	int32_t (*post_disable)(void *dev);
 	/** Called when buffer ready to transfer. Write/read to/from dev */
 	int32_t	(*submit)(struct iio_device_data *dev);
+	/**
+	 * Called from the interrupt of the trigger attached to the device.
+	 * Should read one scan and add it with iio_buffer_push_scan.
+	 */
+	int32_t	(*trigger_handler)(struct iio_device_data *dev);
 
 	/* Read device register */
 	int32_t (*debug_reg_read)(void *dev, uint32_t reg, uint32_t *readval);
@@ -255,4 +348,26 @@ struct iio_device {
 
 };
 
+struct iio_desc;
+
+/**
+ * @struct iio_trigger
+ * @brief Structure holding pointers to trigger functions. Triggers are shown
+ * to clients as devices with the id trigger<n>.
+ */
+struct iio_trigger {
+	/** Array of attributes. Last one should have its name set to NULL */
+	struct iio_attribute *attributes;
+	/** Called when the first buffer using the trigger is enabled */
+	int (*enable)(void *trig);
+	/** Called when the last buffer using the trigger is disabled */
+	int (*disable)(void *trig);
+	/**
+	 * Called by iio_init with the IIO descriptor and the index of the
+	 * trigger in iio_init_param.trigs, to be given to
+	 * iio_process_trigger. May be NULL.
+	 */
+	int (*bind)(void *trig, struct iio_desc *desc, uint32_t trig_id);
+};
+
 #endif /* IIO_TYPES_H_ */
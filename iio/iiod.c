@@ -76,7 +76,8 @@ static struct iiod_str cmds[] = {
 	[IIOD_CMD_WRITEBUF]	= IIOD_STR("WRITEBUF"),
 	[IIOD_CMD_GETTRIG]	= IIOD_STR("GETTRIG"),
 	[IIOD_CMD_SETTRIG]	= IIOD_STR("SETTRIG"),
-	[IIOD_CMD_SET]		= IIOD_STR("SET")
+	[IIOD_CMD_SET]		= IIOD_STR("SET"),
+	[IIOD_CMD_BINARY]	= IIOD_STR("BINARY")
 };
 static const uint32_t priority_array[] = {
 	/* Order not tested, just personal expectation. Function can
@@ -94,7 +95,8 @@ static const uint32_t priority_array[] = {
 	IIOD_CMD_GETTRIG,
 	IIOD_CMD_SETTRIG,
 	IIOD_CMD_HELP,
-	IIOD_CMD_SET
+	IIOD_CMD_SET,
+	IIOD_CMD_BINARY
 };
 
 static_assert(NO_OS_ARRAY_SIZE(cmds) == NO_OS_ARRAY_SIZE(priority_array),
@@ -247,6 +249,7 @@ int32_t iiod_parse_line(char *buf, struct comand_desc *res, char **ctx)
 	case IIOD_CMD_EXIT:
 	case IIOD_CMD_PRINT:
 	case IIOD_CMD_VERSION:
+	case IIOD_CMD_BINARY:
 		return 0;
 	case IIOD_CMD_TIMEOUT:
 		return parse_num(token, &res->timeout, 10);
@@ -276,7 +279,7 @@ int32_t iiod_parse_line(char *buf, struct comand_desc *res, char **ctx)
 
 		return 0;
 	case IIOD_CMD_SET:
-		return iiod_parse_set(buf, res, ctx);
+		return iiod_parse_set(token, res, ctx);
 	default:
 		break;
 	}
@@ -343,6 +346,17 @@ int32_t iiod_copy_ops(struct iiod_ops *ops, struct iiod_ops *new_ops)
 	ops->set_timeout = SET_DUMMY_IF_NULL(new_ops->set_timeout, dummy_set_timeout);
 	ops->set_buffers_count = SET_DUMMY_IF_NULL(new_ops->set_buffers_count,
 				 dummy_set_buffers_count);
+	/* Optional. read_buffer is used when not set */
+	ops->read_buffer_get = new_ops->read_buffer_get;
+	ops->read_buffer_done = new_ops->read_buffer_done;
+	/* Optional. BINARY command fails when not set */
+	ops->get_names = new_ops->get_names;
+	ops->get_buffer_info = new_ops->get_buffer_info;
+	ops->read_xml = new_ops->read_xml;
+	/* Optional. Event stream commands fail when not set */
+	ops->open_events = new_ops->open_events;
+	ops->close_events = new_ops->close_events;
+	ops->read_event = new_ops->read_event;
 	ops->refill_buffer = SET_DUMMY_IF_NULL(new_ops->refill_buffer,
 					       dummy_close);
 	ops->push_buffer = SET_DUMMY_IF_NULL(new_ops->push_buffer,
@@ -392,8 +406,9 @@ static void conn_clean_state(struct iiod_conn_priv *conn)
 
 	conn->res.buf.buf = NULL;
 	conn->res.buf.idx = 0;
-	conn->parser_idx = 0;
-	conn->state = IIOD_READING_LINE;
+	conn->xml_stream = 0;
+	conn->xml_offset = 0;
+	conn->state = conn->binary ? IIOD_BIN_READING_CMD : IIOD_READING_LINE;
 }
 
 int32_t iiod_conn_add(struct iiod_desc *desc, struct iiod_conn_data *data,
@@ -411,13 +426,9 @@ int32_t iiod_conn_add(struct iiod_desc *desc, struct iiod_conn_data *data,
 			memset(conn, 0, sizeof(*conn));
 			conn->used = 1;
 			conn->conn = data->conn;
-			/*
-			 * TODO in future:
-			 * think of using other buffer (e.g. ciruclar_buffer)
-			 * to somehow implement zero copy
-			 */
 			conn->payload_buf = data->buf;
 			conn->payload_buf_len = data->len;
+			conn->partial_recv = data->partial_recv;
 			*new_conn_id = i;
 
 			return 0;
@@ -426,6 +437,20 @@ int32_t iiod_conn_add(struct iiod_desc *desc, struct iiod_conn_data *data,
 	return -EBUSY;
 }
 
+/* Release data obtained with read_buffer_get, if any */
+static int32_t release_read_buff(struct iiod_desc *desc,
+				 struct iiod_conn_priv *conn)
+{
+	struct iiod_ctx ctx = IIOD_CTX(desc, conn);
+
+	if (!conn->zc_pending)
+		return 0;
+
+	conn->zc_pending = 0;
+
+	return desc->ops.read_buffer_done(&ctx, conn->cmd_data.device);
+}
+
 int32_t iiod_conn_remove(struct iiod_desc *desc, uint32_t conn_id,
 			 struct iiod_conn_data *data)
 {
@@ -434,6 +459,8 @@ int32_t iiod_conn_remove(struct iiod_desc *desc, uint32_t conn_id,
 		return -EINVAL;
 	struct iiod_conn_priv *conn;
 	conn = &desc->conns[conn_id];
+	/* End a read left unfinished by the client */
+	release_read_buff(desc, conn);
 	data->conn = conn->conn;
 	data->len = conn->payload_buf_len;
 	data->buf = conn->payload_buf;
@@ -459,7 +486,7 @@ static int32_t call_op(struct iiod_ops *ops, struct comand_desc *data,
 		return ops->set_trigger(ctx, data->device, data->trigger,
 					strlen(data->trigger));
 	case IIOD_CMD_SET:
-		break;
+		return ops->set_buffers_count(ctx, data->device, data->count);
 	default:
 		break;
 	}
@@ -467,6 +494,37 @@ static int32_t call_op(struct iiod_ops *ops, struct comand_desc *data,
 	return -EINVAL;
 }
 
+/* Receive data, consuming what was already received with the command first */
+static int32_t iiod_recv(struct iiod_desc *desc, struct iiod_conn_priv *conn,
+			 uint8_t *buf, uint32_t len)
+{
+	struct iiod_ctx ctx = IIOD_CTX(desc, conn);
+	uint32_t available;
+	int32_t ret;
+
+	available = conn->rx_len - conn->rx_idx;
+	if (!available) {
+		if (!conn->partial_recv || len >= IIOD_CONN_RX_BUF_SIZE)
+			return desc->ops.recv(&ctx, buf, len);
+
+		/* Small reads (e.g. binary headers) are batched in rx_buf */
+		ret = desc->ops.recv(&ctx, (uint8_t *)conn->rx_buf,
+				     IIOD_CONN_RX_BUF_SIZE);
+		if (ret <= 0)
+			return ret;
+
+		conn->rx_idx = 0;
+		conn->rx_len = ret;
+		available = ret;
+	}
+
+	len = no_os_min(len, available);
+	memcpy(buf, conn->rx_buf + conn->rx_idx, len);
+	conn->rx_idx += len;
+
+	return len;
+}
+
 /*
  * Unload data from buf without blocking.
  * When done will return 0, if there is still data to be sent it will return
@@ -486,7 +544,7 @@ static int32_t rw_iiod_buff(struct iiod_desc *desc, struct iiod_conn_priv *conn,
 		if (flags & IIOD_WR)
 			ret = desc->ops.send(&ctx, tmp_buf, len);
 		else
-			ret = desc->ops.recv(&ctx, tmp_buf, len);
+			ret = iiod_recv(desc, conn, tmp_buf, len);
 		if (NO_OS_IS_ERR_VALUE(ret))
 			return ret;
 
@@ -513,14 +571,25 @@ static int32_t do_read_buff(struct iiod_desc *desc, struct iiod_conn_priv *conn)
 	int32_t ret, len;
 
 	if (conn->nb_buf.len == 0) {
-		conn->nb_buf.buf = conn->payload_buf;
-		len = no_os_min(conn->payload_buf_len,
-				conn->cmd_data.bytes_count);
-		/* Read from dev */
-		ret = desc->ops.read_buffer(&ctx, conn->cmd_data.device,
-					    conn->nb_buf.buf, len);
-		if (NO_OS_IS_ERR_VALUE(ret))
-			return ret;
+		if (desc->ops.read_buffer_get && desc->ops.read_buffer_done) {
+			/* Send directly from the device buffer */
+			ret = desc->ops.read_buffer_get(&ctx,
+							conn->cmd_data.device,
+							&conn->nb_buf.buf,
+							conn->cmd_data.bytes_count);
+			if (NO_OS_IS_ERR_VALUE(ret))
+				return ret;
+			conn->zc_pending = 1;
+		} else {
+			conn->nb_buf.buf = conn->payload_buf;
+			len = no_os_min(conn->payload_buf_len,
+					conn->cmd_data.bytes_count);
+			/* Read from dev */
+			ret = desc->ops.read_buffer(&ctx, conn->cmd_data.device,
+						    conn->nb_buf.buf, len);
+			if (NO_OS_IS_ERR_VALUE(ret))
+				return ret;
+		}
 		len = ret;
 		conn->nb_buf.len = len;
 		conn->nb_buf.idx = 0;
@@ -528,6 +597,14 @@ static int32_t do_read_buff(struct iiod_desc *desc, struct iiod_conn_priv *conn)
 	if (conn->nb_buf.idx < conn->nb_buf.len) {
 		/* Write on conn */
 		ret = rw_iiod_buff(desc, conn, &conn->nb_buf, IIOD_WR);
+		if (ret == -EAGAIN)
+			return ret;
+		if (NO_OS_IS_ERR_VALUE(ret)) {
+			release_read_buff(desc, conn);
+			return ret;
+		}
+
+		ret = release_read_buff(desc, conn);
 		if (NO_OS_IS_ERR_VALUE(ret))
 			return ret;
 
@@ -540,6 +617,46 @@ static int32_t do_read_buff(struct iiod_desc *desc, struct iiod_conn_priv *conn)
 	return 0;
 }
 
+/* Generate the context xml in chunks of payload_buf and send it */
+static int32_t do_read_xml(struct iiod_desc *desc, struct iiod_conn_priv *conn)
+{
+	struct iiod_ctx ctx = IIOD_CTX(desc, conn);
+	uint8_t flags = IIOD_WR;
+	uint32_t len;
+	int32_t ret;
+
+	if (conn->nb_buf.len == 0) {
+		len = no_os_min(conn->payload_buf_len,
+				desc->xml_len - conn->xml_offset);
+		ret = desc->ops.read_xml(&ctx, conn->xml_offset,
+					 conn->payload_buf, len);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+		if (!ret)
+			return -EIO;
+
+		conn->nb_buf.buf = conn->payload_buf;
+		conn->nb_buf.len = ret;
+		conn->nb_buf.idx = 0;
+	}
+
+	/* In text mode the xml ends with a new line */
+	if (!conn->binary &&
+	    conn->xml_offset + conn->nb_buf.len == desc->xml_len)
+		flags |= IIOD_ENDL;
+
+	ret = rw_iiod_buff(desc, conn, &conn->nb_buf, flags);
+	if (NO_OS_IS_ERR_VALUE(ret))
+		return ret;
+
+	conn->xml_offset += conn->nb_buf.len;
+	conn->nb_buf.len = 0;
+	if (conn->xml_offset < desc->xml_len)
+		return -EAGAIN;
+
+	return 0;
+}
+
 static int32_t do_write_buff(struct iiod_desc *desc,
 			     struct iiod_conn_priv *conn)
 {
@@ -605,8 +722,12 @@ static int32_t iiod_run_cmd(struct iiod_desc *desc,
 	case IIOD_CMD_PRINT:
 		conn->res.val = desc->xml_len;
 		conn->res.write_val = 1;
-		conn->res.buf.buf = desc->xml;
-		conn->res.buf.len = desc->xml_len;
+		if (desc->ops.read_xml) {
+			conn->xml_stream = 1;
+		} else {
+			conn->res.buf.buf = desc->xml;
+			conn->res.buf.len = desc->xml_len;
+		}
 		break;
 	case IIOD_CMD_VERSION:
 		conn->res.buf.buf = IIOD_VERSION;
@@ -641,6 +762,9 @@ static int32_t iiod_run_cmd(struct iiod_desc *desc,
 	case IIOD_CMD_READBUF:
 		conn->res.write_val = 1;
 		ret = desc->ops.refill_buffer(&ctx, data->device);
+		/* The data is still being acquired. Run the command again */
+		if (ret == -EAGAIN)
+			return ret;
 		if (NO_OS_IS_ERR_VALUE(ret)) {
 			conn->res.val = ret;
 			break;
@@ -654,6 +778,16 @@ static int32_t iiod_run_cmd(struct iiod_desc *desc,
 		conn->res.val = data->bytes_count;
 		conn->res.write_val = 1;
 		break;
+	case IIOD_CMD_BINARY:
+		conn->res.write_val = 1;
+		if (desc->ops.get_names && desc->ops.get_buffer_info) {
+			/* Following commands are binary. This answer is not */
+			conn->binary = 1;
+			conn->res.val = 0;
+		} else {
+			conn->res.val = -EINVAL;
+		}
+		break;
 	default:
 		return -EINVAL;
 	}
@@ -661,6 +795,486 @@ static int32_t iiod_run_cmd(struct iiod_desc *desc,
 	return 0;
 }
 
+/* Size of the fixed argument following the header of a binary command */
+static uint32_t iiod_bin_arg_size(uint8_t op)
+{
+	switch (op) {
+	case IIOD_OP_WRITE_ATTR:
+	case IIOD_OP_WRITE_DBG_ATTR:
+	case IIOD_OP_WRITE_BUF_ATTR:
+	case IIOD_OP_WRITE_CHN_ATTR:
+	case IIOD_OP_CREATE_BLOCK:
+	case IIOD_OP_TRANSFER_BLOCK:
+	case IIOD_OP_ENQUEUE_BLOCK_CYCLIC:
+		return sizeof(uint64_t);
+	default:
+		return 0;
+	}
+}
+
+/* Size of the channel mask following a CREATE_BUFFER command */
+static uint32_t iiod_bin_mask_size(struct iiod_desc *desc,
+				   struct iiod_conn_priv *conn)
+{
+	struct iiod_ctx ctx = IIOD_CTX(desc, conn);
+	uint32_t nb_words = 1;
+	int32_t ret;
+
+	ret = desc->ops.get_names(&ctx, conn->bin_cmd.dev, -1, -1,
+				  IIO_ATTR_TYPE_DEVICE, &conn->bin_names);
+	if (!NO_OS_IS_ERR_VALUE(ret) && conn->bin_names.nb_channels)
+		nb_words = NO_OS_DIV_ROUND_UP(conn->bin_names.nb_channels, 32);
+
+	return nb_words * sizeof(uint32_t);
+}
+
+/* Attribute type of a binary command. -1 if it is not an attribute command */
+static int32_t iiod_bin_attr_type(uint8_t op)
+{
+	switch (op) {
+	case IIOD_OP_READ_ATTR:
+	case IIOD_OP_WRITE_ATTR:
+		return IIO_ATTR_TYPE_DEVICE;
+	case IIOD_OP_READ_DBG_ATTR:
+	case IIOD_OP_WRITE_DBG_ATTR:
+		return IIO_ATTR_TYPE_DEBUG;
+	case IIOD_OP_READ_BUF_ATTR:
+	case IIOD_OP_WRITE_BUF_ATTR:
+		return IIO_ATTR_TYPE_BUFFER;
+	case IIOD_OP_READ_CHN_ATTR:
+	case IIOD_OP_WRITE_CHN_ATTR:
+		return IIO_ATTR_TYPE_CH_IN;
+	default:
+		return -1;
+	}
+}
+
+static int32_t iiod_bin_trigger(struct iiod_desc *desc,
+				struct iiod_conn_priv *conn)
+{
+	struct iiod_ctx ctx = IIOD_CTX(desc, conn);
+	struct iiod_names trig;
+	uint32_t idx;
+	int32_t ret;
+
+	if (conn->bin_cmd.op == IIOD_OP_SETTRIG) {
+		/* Negative code removes the trigger */
+		if (conn->bin_cmd.code < 0)
+			return desc->ops.set_trigger(&ctx,
+						     conn->bin_names.device,
+						     "", 0);
+
+		ret = desc->ops.get_names(&ctx, conn->bin_cmd.code, -1, -1,
+					  IIO_ATTR_TYPE_DEVICE, &trig);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+
+		return desc->ops.set_trigger(&ctx, conn->bin_names.device,
+					     trig.device, strlen(trig.device));
+	}
+
+	ret = desc->ops.get_trigger(&ctx, conn->bin_names.device,
+				    conn->payload_buf,
+				    conn->payload_buf_len - 1);
+	if (NO_OS_IS_ERR_VALUE(ret))
+		return ret;
+
+	/* Triggers are answered with their device index */
+	conn->payload_buf[ret] = '\0';
+	for (idx = 0; ; idx++) {
+		ret = desc->ops.get_names(&ctx, idx, -1, -1,
+					  IIO_ATTR_TYPE_DEVICE, &trig);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return -ENOENT;
+		if (!strcmp(trig.device, conn->payload_buf))
+			return idx;
+	}
+}
+
+/*
+ * Answer the pending READ_EVENT of the connection if an event came. No I/O.
+ * Returns true if the response is ready to be sent.
+ */
+static bool iiod_bin_event_ready(struct iiod_desc *desc,
+				 struct iiod_conn_priv *conn)
+{
+	struct iiod_ctx ctx = IIOD_CTX(desc, conn);
+	int32_t ret;
+
+	ret = desc->ops.get_names(&ctx, conn->ev_cmd.dev, -1, -1,
+				  IIO_ATTR_TYPE_DEVICE, &conn->bin_names);
+	if (!NO_OS_IS_ERR_VALUE(ret))
+		ret = desc->ops.read_event(&ctx, conn->bin_names.device,
+					   conn->payload_buf,
+					   conn->payload_buf_len);
+	if (ret == -EAGAIN)
+		return false;
+
+	conn->ev_pending = 0;
+	conn->bin_res.client_id = conn->ev_cmd.client_id;
+	conn->bin_res.op = IIOD_OP_RESPONSE;
+	conn->bin_res.dev = conn->ev_cmd.dev;
+	conn->bin_res.code = ret;
+	memset(&conn->nb_buf, 0, sizeof(conn->nb_buf));
+	if (ret > 0) {
+		conn->res.buf.buf = conn->payload_buf;
+		conn->res.buf.len = ret;
+	}
+	conn->state = IIOD_WRITING_CMD_RESULT;
+
+	return true;
+}
+
+/*
+ * Start answering the oldest queued input block with its data. No I/O.
+ * Returns true if the response is ready to be sent.
+ */
+static bool iiod_bin_block_ready(struct iiod_desc *desc,
+				 struct iiod_conn_priv *conn)
+{
+	struct iiod_ctx ctx = IIOD_CTX(desc, conn);
+	struct iiod_bin_block *block;
+	int32_t ret;
+
+	block = &conn->bin_blocks[conn->bin_blocks_first];
+	ret = -ECANCELED;
+	if (!block->canceled)
+		ret = desc->ops.get_names(&ctx, block->cmd.dev, -1, -1,
+					  IIO_ATTR_TYPE_DEVICE,
+					  &conn->bin_names);
+	if (!NO_OS_IS_ERR_VALUE(ret))
+		ret = desc->ops.refill_buffer(&ctx, conn->bin_names.device);
+	/* Not filled yet, commands received meanwhile are served first */
+	if (ret == -EAGAIN)
+		return false;
+
+	conn->bin_blocks_first = (conn->bin_blocks_first + 1) %
+				 IIOD_BIN_MAX_BLOCKS;
+	conn->bin_blocks_count--;
+	conn->bin_res.client_id = block->cmd.client_id;
+	conn->bin_res.op = IIOD_OP_RESPONSE;
+	conn->bin_res.dev = block->cmd.dev;
+	memset(&conn->nb_buf, 0, sizeof(conn->nb_buf));
+	if (!NO_OS_IS_ERR_VALUE(ret)) {
+		/* Block data is sent after the response */
+		conn->cmd_data.cmd = IIOD_CMD_READBUF;
+		conn->cmd_data.device = conn->bin_names.device;
+		conn->cmd_data.bytes_count = block->size;
+		ret = block->size;
+	}
+	conn->bin_res.code = ret;
+	conn->state = IIOD_WRITING_CMD_RESULT;
+
+	return true;
+}
+
+/*
+ * Execute a binary command. No I/O.
+ * Sets bin_res and the next state depending on the command.
+ */
+static int32_t iiod_bin_run_cmd(struct iiod_desc *desc,
+				struct iiod_conn_priv *conn)
+{
+	struct iiod_ctx ctx = IIOD_CTX(desc, conn);
+	struct iiod_bin_cmd *cmd = &conn->bin_cmd;
+	struct iiod_names *names = &conn->bin_names;
+	struct iiod_bin_block *block;
+	struct iiod_attr attr;
+	int32_t chn_idx = -1;
+	int32_t attr_idx = -1;
+	uint32_t scan_size;
+	int32_t type;
+	int32_t ret;
+	uint32_t i;
+
+	conn->bin_res.client_id = cmd->client_id;
+	conn->bin_res.op = IIOD_OP_RESPONSE;
+	conn->bin_res.dev = cmd->dev;
+	memset(&conn->nb_buf, 0, sizeof(conn->nb_buf));
+	conn->state = IIOD_WRITING_CMD_RESULT;
+
+	switch (cmd->op) {
+	case IIOD_OP_PRINT:
+		conn->bin_res.code = desc->xml_len;
+		if (desc->ops.read_xml) {
+			conn->xml_stream = 1;
+		} else {
+			conn->res.buf.buf = desc->xml;
+			conn->res.buf.len = desc->xml_len;
+		}
+
+		return 0;
+	case IIOD_OP_TIMEOUT:
+		conn->bin_res.code = desc->ops.set_timeout(&ctx, cmd->code);
+
+		return 0;
+	default:
+		break;
+	}
+
+	type = iiod_bin_attr_type(cmd->op);
+	if (type == IIO_ATTR_TYPE_CH_IN)
+		chn_idx = (uint32_t)cmd->code >> 16;
+	if (type >= 0)
+		attr_idx = cmd->code & 0xFFFF;
+	else
+		type = IIO_ATTR_TYPE_DEVICE;
+
+	ret = desc->ops.get_names(&ctx, cmd->dev, chn_idx, attr_idx, type,
+				  names);
+	if (NO_OS_IS_ERR_VALUE(ret)) {
+		conn->bin_res.code = ret;
+
+		return 0;
+	}
+
+	if (chn_idx >= 0 && names->ch_out)
+		type = IIO_ATTR_TYPE_CH_OUT;
+	attr.type = type;
+	attr.name = names->attr;
+	attr.channel = chn_idx >= 0 ? names->channel : NULL;
+
+	switch (cmd->op) {
+	case IIOD_OP_READ_ATTR:
+	case IIOD_OP_READ_DBG_ATTR:
+	case IIOD_OP_READ_BUF_ATTR:
+	case IIOD_OP_READ_CHN_ATTR:
+		ret = desc->ops.read_attr(&ctx, names->device, &attr,
+					  conn->payload_buf,
+					  conn->payload_buf_len);
+		if (ret > 0) {
+			conn->res.buf.buf = conn->payload_buf;
+			conn->res.buf.len = ret;
+		}
+		break;
+	case IIOD_OP_WRITE_ATTR:
+	case IIOD_OP_WRITE_DBG_ATTR:
+	case IIOD_OP_WRITE_BUF_ATTR:
+	case IIOD_OP_WRITE_CHN_ATTR:
+		ret = desc->ops.write_attr(&ctx, names->device, &attr,
+					   conn->payload_buf, conn->bin_arg);
+		break;
+	case IIOD_OP_GETTRIG:
+	case IIOD_OP_SETTRIG:
+		ret = iiod_bin_trigger(desc, conn);
+		break;
+	case IIOD_OP_CREATE_BUFFER:
+		memcpy(&conn->mask, conn->payload_buf, sizeof(conn->mask));
+		ret = desc->ops.get_buffer_info(&ctx, names->device,
+						conn->mask, &scan_size,
+						&conn->bin_buf_out);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			break;
+
+		/*
+		 * Answer with the mask of the channels that can be used. Only
+		 * the first 32 channels can be enabled.
+		 */
+		memset(conn->payload_buf + sizeof(conn->mask), 0,
+		       conn->bin_arg - sizeof(conn->mask));
+		conn->res.buf.buf = conn->payload_buf;
+		conn->res.buf.len = conn->bin_arg;
+		conn->bin_nb_blocks = 0;
+		ret = conn->bin_arg;
+		break;
+	case IIOD_OP_CREATE_BLOCK:
+		conn->bin_block_size = conn->bin_arg;
+		conn->bin_nb_blocks++;
+		ret = 0;
+		break;
+	case IIOD_OP_FREE_BUFFER:
+		conn->bin_nb_blocks = 0;
+		ret = 0;
+		break;
+	case IIOD_OP_FREE_BLOCK:
+		if (conn->bin_nb_blocks)
+			conn->bin_nb_blocks--;
+		ret = 0;
+		break;
+	case IIOD_OP_ENABLE_BUFFER:
+		ret = desc->ops.get_buffer_info(&ctx, names->device,
+						conn->mask, &scan_size,
+						&conn->bin_buf_out);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			break;
+		if (!scan_size || conn->bin_block_size < scan_size) {
+			ret = -EINVAL;
+			break;
+		}
+
+		/* Same as SET BUFFERS_COUNT, with the blocks the client made */
+		ret = desc->ops.set_buffers_count(&ctx, names->device,
+						  no_os_max(conn->bin_nb_blocks, 1u));
+		if (NO_OS_IS_ERR_VALUE(ret))
+			break;
+
+		ret = desc->ops.open(&ctx, names->device,
+				     conn->bin_block_size / scan_size,
+				     conn->mask, false);
+		break;
+	case IIOD_OP_DISABLE_BUFFER:
+		/* Queued blocks are answered with an error */
+		for (i = 0; i < conn->bin_blocks_count; i++)
+			conn->bin_blocks[(conn->bin_blocks_first + i) %
+					 IIOD_BIN_MAX_BLOCKS].canceled = 1;
+		ret = desc->ops.close(&ctx, names->device);
+		break;
+	case IIOD_OP_TRANSFER_BLOCK:
+	case IIOD_OP_ENQUEUE_BLOCK_CYCLIC:
+		if (conn->bin_buf_out) {
+			/* Block data follows. Answer after it is pushed */
+			conn->cmd_data.device = names->device;
+			conn->cmd_data.bytes_count = conn->bin_arg;
+			conn->cmd_data.cmd = IIOD_CMD_WRITEBUF;
+			conn->state = IIOD_RW_BUF;
+
+			return 0;
+		}
+
+		if (conn->bin_blocks_count == IIOD_BIN_MAX_BLOCKS) {
+			ret = -EBUSY;
+			break;
+		}
+
+		/* Answered with the data once the device provides it */
+		block = &conn->bin_blocks[(conn->bin_blocks_first +
+					   conn->bin_blocks_count) %
+					  IIOD_BIN_MAX_BLOCKS];
+		block->cmd = *cmd;
+		block->size = conn->bin_arg;
+		block->canceled = 0;
+		conn->bin_blocks_count++;
+		conn->state = IIOD_LINE_DONE;
+
+		return 0;
+	case IIOD_OP_CREATE_EVSTREAM:
+		ret = -EOPNOTSUPP;
+		if (desc->ops.open_events)
+			ret = desc->ops.open_events(&ctx, names->device);
+		break;
+	case IIOD_OP_FREE_EVSTREAM:
+		ret = -EOPNOTSUPP;
+		if (!desc->ops.close_events)
+			break;
+
+		/* A READ_EVENT still waiting is dropped with the stream */
+		if (conn->ev_pending && conn->ev_cmd.dev == cmd->dev)
+			conn->ev_pending = 0;
+		ret = desc->ops.close_events(&ctx, names->device);
+		break;
+	case IIOD_OP_READ_EVENT:
+		ret = -EOPNOTSUPP;
+		if (!desc->ops.read_event)
+			break;
+		if (conn->ev_pending) {
+			ret = -EBUSY;
+			break;
+		}
+
+		ret = desc->ops.read_event(&ctx, names->device,
+					   conn->payload_buf,
+					   conn->payload_buf_len);
+		if (ret == -EAGAIN) {
+			/*
+			 * Don't block the connection until an event comes.
+			 * Other commands are served meanwhile.
+			 */
+			conn->ev_pending = 1;
+			conn->ev_cmd = *cmd;
+			conn->state = IIOD_LINE_DONE;
+
+			return 0;
+		}
+		if (ret > 0) {
+			conn->res.buf.buf = conn->payload_buf;
+			conn->res.buf.len = ret;
+		}
+		break;
+	default:
+		ret = -EOPNOTSUPP;
+		break;
+	}
+
+	conn->bin_res.code = ret;
+
+	return 0;
+}
+
+/* Write the result of a text command and its buffer. Non blocking */
+static int32_t iiod_write_response(struct iiod_desc *desc,
+				   struct iiod_conn_priv *conn)
+{
+	int32_t ret;
+
+	/* Write result or the length of data to be sent*/
+	if (conn->res.write_val) {
+		if (conn->nb_buf.len == 0) {
+			conn->nb_buf.buf = conn->parser_buf;
+			ret = sprintf(conn->nb_buf.buf, "%"PRIi32,
+				      conn->res.val);
+			conn->nb_buf.len = ret;
+			conn->nb_buf.idx = 0;
+		}
+		/* Non-blocking. Will enter here until val is sent */
+		if (conn->nb_buf.idx < conn->nb_buf.len) {
+			ret = rw_iiod_buff(desc, conn, &conn->nb_buf,
+					   IIOD_WR | IIOD_ENDL);
+			if (NO_OS_IS_ERR_VALUE(ret))
+				return ret;
+		}
+	}
+	/* Send buf from result. Non blocking */
+	if (conn->res.buf.buf &&
+	    conn->res.buf.idx < conn->res.buf.len) {
+		ret = rw_iiod_buff(desc, conn, &conn->res.buf,
+				   IIOD_WR | IIOD_ENDL);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+	}
+
+	return 0;
+}
+
+/* Write the response of a binary command and its payload. Non blocking */
+static int32_t iiod_bin_write_response(struct iiod_desc *desc,
+				       struct iiod_conn_priv *conn)
+{
+	int32_t ret;
+
+	if (conn->nb_buf.len == 0) {
+		conn->nb_buf.buf = (char *)&conn->bin_res;
+		conn->nb_buf.len = sizeof(conn->bin_res);
+		conn->nb_buf.idx = 0;
+	}
+	if (conn->nb_buf.idx < conn->nb_buf.len) {
+		ret = rw_iiod_buff(desc, conn, &conn->nb_buf, IIOD_WR);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+	}
+	if (conn->res.buf.buf && conn->res.buf.idx < conn->res.buf.len) {
+		ret = rw_iiod_buff(desc, conn, &conn->res.buf, IIOD_WR);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+	}
+
+	return 0;
+}
+
+/* Check if rx_buf holds a command that was not processed yet */
+static bool iiod_cmd_pending(struct iiod_conn_priv *conn)
+{
+	if (conn->binary)
+		return conn->rx_len != conn->rx_idx;
+
+	return memchr(conn->rx_buf + conn->rx_idx, '\n',
+		      conn->rx_len - conn->rx_idx) != NULL;
+}
+
+/*
+ * Copy the next line from rx_buf into parser_buf. As many bytes as the
+ * connection has available are received at once, so several pipelined
+ * commands may be stored in rx_buf and processed without further I/O.
+ */
 static int32_t iiod_read_line(struct iiod_desc *desc,
 			      struct iiod_conn_priv *conn)
 {
@@ -668,33 +1282,55 @@ static int32_t iiod_read_line(struct iiod_desc *desc,
 		.instance = desc->app_instance,
 		.conn = conn->conn
 	};
+	uint32_t len;
 	int32_t ret;
-	char *ch;
+	char *line;
+	char *end;
+
+	while (true) {
+		/* Skip empty lines */
+		while (conn->rx_idx < conn->rx_len &&
+		       (conn->rx_buf[conn->rx_idx] == '\n' ||
+			conn->rx_buf[conn->rx_idx] == '\r'))
+			conn->rx_idx++;
+
+		line = conn->rx_buf + conn->rx_idx;
+		len = conn->rx_len - conn->rx_idx;
+		end = memchr(line, '\n', len);
+		if (end || len >= IIOD_PARSER_MAX_BUF_SIZE - 1)
+			break;
+
+		/* Move the incomplete line at the beginning of rx_buf */
+		memmove(conn->rx_buf, line, len);
+		conn->rx_idx = 0;
+		conn->rx_len = len;
 
-	while (conn->parser_idx < IIOD_PARSER_MAX_BUF_SIZE - 1) {
-		ch = conn->parser_buf + conn->parser_idx;
-		ret = desc->ops.recv(&ctx,(uint8_t *)ch, 1);
+		ret = desc->ops.recv(&ctx, (uint8_t *)conn->rx_buf + len,
+				     conn->partial_recv ?
+				     IIOD_CONN_RX_BUF_SIZE - len : 1);
 		if (ret == -EAGAIN || ret == 0)
 			return -EAGAIN;
 
 		if (NO_OS_IS_ERR_VALUE(ret))
-			goto end;
+			return ret;
 
-		if (conn->parser_idx == 0 && (*ch == '\n' || *ch == '\r'))
-			continue ;
+		conn->rx_len += ret;
+	}
 
-		++conn->parser_idx;
-		if (*ch == '\n') {
-			conn->parser_buf[conn->parser_idx] = '\0';
-			ret = 0;
-			goto end;
-		}
+	if (!end || end - line + 1 > IIOD_PARSER_MAX_BUF_SIZE - 1) {
+		/* Line too long. Drop received data */
+		conn->rx_idx = 0;
+		conn->rx_len = 0;
+
+		return -EIO;
 	}
 
-	ret = -EIO;
-end:
-	conn->parser_idx = 0;
-	return ret;
+	len = end - line + 1;
+	memcpy(conn->parser_buf, line, len);
+	conn->parser_buf[len] = '\0';
+	conn->rx_idx += len;
+
+	return 0;
 }
 
 /*
@@ -739,6 +1375,10 @@ static int32_t iiod_run_state(struct iiod_desc *desc,
 
 		return 0;
 	case IIOD_RUNNING_CMD:
+		/* Binary commands set the next state themselves */
+		if (conn->binary)
+			return iiod_bin_run_cmd(desc, conn);
+
 		/* Execute or call necessary ops depending on cmd. No I/O */
 		ret = iiod_run_cmd(desc, conn);
 		if (NO_OS_IS_ERR_VALUE(ret))
@@ -748,34 +1388,17 @@ static int32_t iiod_run_state(struct iiod_desc *desc,
 
 		return 0;
 	case IIOD_WRITING_CMD_RESULT:
-		/* Write result or the length of data to be sent*/
-		if (conn->res.write_val) {
-			if (conn->nb_buf.len == 0) {
-				conn->nb_buf.buf = conn->parser_buf;
-				ret = sprintf(conn->nb_buf.buf, "%"PRIi32,
-					      conn->res.val);
-				conn->nb_buf.len = ret;
-				conn->nb_buf.idx = 0;
-			}
-			/* Non-blocking. Will enter here until val is sent */
-			if (conn->nb_buf.idx < conn->nb_buf.len) {
-				ret = rw_iiod_buff(desc, conn, &conn->nb_buf,
-						   IIOD_WR | IIOD_ENDL);
-				if (NO_OS_IS_ERR_VALUE(ret))
-					return ret;
-			}
-		}
-		/* Send buf from result. Non blocking */
-		if (conn->res.buf.buf &&
-		    conn->res.buf.idx < conn->res.buf.len) {
-			ret = rw_iiod_buff(desc, conn, &conn->res.buf,
-					   IIOD_WR | IIOD_ENDL);
-			if (NO_OS_IS_ERR_VALUE(ret))
-				return ret;
-		}
+		/* The answer to the BINARY command itself is still text */
+		if (conn->binary && conn->cmd_data.cmd != IIOD_CMD_BINARY)
+			ret = iiod_bin_write_response(desc, conn);
+		else
+			ret = iiod_write_response(desc, conn);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
 
 		if (conn->cmd_data.cmd != IIOD_CMD_READBUF &&
-		    conn->cmd_data.cmd != IIOD_CMD_WRITEBUF) {
+		    conn->cmd_data.cmd != IIOD_CMD_WRITEBUF &&
+		    !conn->xml_stream) {
 			conn->state = IIOD_LINE_DONE;
 		} else {
 			/* Preapre for IIOD_RW_BUF state */
@@ -787,7 +1410,9 @@ static int32_t iiod_run_state(struct iiod_desc *desc,
 	case IIOD_RW_BUF:
 		/* IIOD_CMD_READBUF and IIOD_CMD_WRITEBUF special case */
 		/* Non blocking read/write until all data is processed */
-		if (conn->cmd_data.cmd == IIOD_CMD_READBUF)
+		if (conn->xml_stream)
+			ret = do_read_xml(desc, conn);
+		else if (conn->cmd_data.cmd == IIOD_CMD_READBUF)
 			ret = do_read_buff(desc, conn);
 		else {
 			ret = do_write_buff(desc, conn);
@@ -795,6 +1420,20 @@ static int32_t iiod_run_state(struct iiod_desc *desc,
 				conn->res.write_val = 1;
 				ret = desc->ops.push_buffer(&ctx,
 							    conn->cmd_data.device);
+				if (conn->binary) {
+					/* Answer with the pushed size or error */
+					if (!NO_OS_IS_ERR_VALUE(ret))
+						ret = conn->cmd_data.bytes_count;
+					conn->bin_res.code = ret;
+					memset(&conn->res.buf, 0,
+					       sizeof(conn->res.buf));
+					memset(&conn->nb_buf, 0,
+					       sizeof(conn->nb_buf));
+					conn->cmd_data.cmd = IIOD_CMD_PRINT;
+					conn->state = IIOD_WRITING_CMD_RESULT;
+
+					return 0;
+				}
 				if (NO_OS_IS_ERR_VALUE(ret)) {
 					conn->res.val = ret;
 					conn->state = IIOD_LINE_DONE;
@@ -814,6 +1453,65 @@ static int32_t iiod_run_state(struct iiod_desc *desc,
 
 		conn->state = IIOD_LINE_DONE;
 
+		return 0;
+	case IIOD_BIN_READING_CMD:
+		/* A pending event is answered while no command is received */
+		if (conn->ev_pending && conn->nb_buf.idx == 0 &&
+		    iiod_bin_event_ready(desc, conn))
+			return 0;
+		/* Same for queued blocks, once received commands are served */
+		if (conn->bin_blocks_count && conn->nb_buf.idx == 0 &&
+		    !iiod_cmd_pending(conn) && iiod_bin_block_ready(desc, conn))
+			return 0;
+
+		/* Read the fixed size header of a binary command */
+		if (conn->nb_buf.len == 0) {
+			conn->nb_buf.buf = (char *)&conn->bin_cmd;
+			conn->nb_buf.len = sizeof(conn->bin_cmd);
+			conn->nb_buf.idx = 0;
+		}
+		ret = rw_iiod_buff(desc, conn, &conn->nb_buf, IIOD_RD);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+
+		conn->bin_arg = 0;
+		conn->nb_buf.buf = (char *)&conn->bin_arg;
+		conn->nb_buf.len = iiod_bin_arg_size(conn->bin_cmd.op);
+		conn->nb_buf.idx = 0;
+		conn->state = IIOD_BIN_READING_ARG;
+		if (conn->bin_cmd.op == IIOD_OP_CREATE_BUFFER) {
+			/* The mask has one 32 bit word per 32 channels */
+			conn->bin_arg = iiod_bin_mask_size(desc, conn);
+			if (conn->bin_arg > conn->payload_buf_len)
+				return -ENOTCONN;
+
+			conn->nb_buf.buf = conn->payload_buf;
+			conn->nb_buf.len = conn->bin_arg;
+		}
+
+		return 0;
+	case IIOD_BIN_READING_ARG:
+		ret = rw_iiod_buff(desc, conn, &conn->nb_buf, IIOD_RD);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+
+		if (conn->bin_cmd.op < IIOD_OP_WRITE_ATTR ||
+		    conn->bin_cmd.op > IIOD_OP_WRITE_CHN_ATTR) {
+			conn->state = IIOD_RUNNING_CMD;
+
+			return 0;
+		}
+
+		/* The stream can't be resynchronized if the value is dropped */
+		if (conn->bin_arg >= conn->payload_buf_len)
+			return -ENOTCONN;
+
+		conn->payload_buf[conn->bin_arg] = '\0';
+		conn->nb_buf.buf = conn->payload_buf;
+		conn->nb_buf.len = conn->bin_arg;
+		conn->nb_buf.idx = 0;
+		conn->state = IIOD_READING_WRITE_DATA;
+
 		return 0;
 	case IIOD_READING_WRITE_DATA:
 		/* Read attribute */
@@ -844,8 +1542,14 @@ int32_t iiod_conn_step(struct iiod_desc *desc, uint32_t conn_id)
 		ret = iiod_run_state(desc, conn);
 		if (ret == -EAGAIN)
 			return ret;
-		if (NO_OS_IS_ERR_VALUE(ret) || conn->state == IIOD_LINE_DONE)
+		if (NO_OS_IS_ERR_VALUE(ret))
 			break;
+		if (conn->state == IIOD_LINE_DONE) {
+			conn_clean_state(conn);
+			/* Process pipelined commands already received */
+			if (!iiod_cmd_pending(conn))
+				return ret;
+		}
 		//The loop will continue because the state was changed.
 	} while (true);
 
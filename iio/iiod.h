@@ -67,6 +67,23 @@ struct iiod_attr {
 	const char *channel;
 };
 
+/* Maximum length of device and channel names used by the binary protocol */
+#define IIOD_NAME_MAX		64
+
+/* Names of the objects referenced by index in binary protocol commands */
+struct iiod_names {
+	/* Device id, as found in the context xml */
+	char device[IIOD_NAME_MAX];
+	/* Channel id, for channel attributes */
+	char channel[IIOD_NAME_MAX];
+	/* Set if channel is an output channel */
+	bool ch_out;
+	/* Number of channels of the device */
+	uint32_t nb_channels;
+	/* Attribute name */
+	const char *attr;
+};
+
 struct iiod_ctx {
 	/* Value specified in iiod_init_param.instance in iiod_init */
 	void *instance;
@@ -81,6 +98,12 @@ struct iiod_conn_data {
 	char *buf;
 	/* Size of the provided buffer. It must fit the max attribute size */
 	uint32_t len;
+	/*
+	 * Set if recv returns the bytes already available instead of blocking
+	 * until len bytes are received (e.g. sockets). Commands are then
+	 * received in batches instead of byte by byte.
+	 */
+	bool partial_recv;
 };
 
 /* Functions should return a negative error code on failure */
@@ -113,7 +136,20 @@ struct iiod_ops {
 	/* Read data from opened buffer */
 	int (*read_buffer)(struct iiod_ctx *ctx, const char *device, char *buf,
 			   uint32_t bytes);
-	/* Called to notify that buffer must be refiiled */
+	/*
+	 * Optional zero copy alternative to read_buffer.
+	 * Set buf to the address of at maximum bytes of contiguous data from
+	 * the opened buffer and return the number of bytes available there.
+	 * Data must remain valid until read_buffer_done is called.
+	 */
+	int (*read_buffer_get)(struct iiod_ctx *ctx, const char *device,
+			       char **buf, uint32_t bytes);
+	/* Release data returned by read_buffer_get after it was sent */
+	int (*read_buffer_done)(struct iiod_ctx *ctx, const char *device);
+	/*
+	 * Called to notify that buffer must be refiiled. Can return -EAGAIN
+	 * while the data is acquired in the background, it is called again.
+	 */
 	int (*refill_buffer)(struct iiod_ctx *ctx, const char *device);
 
 	/* Write data to opened buffer */
@@ -144,7 +180,44 @@ struct iiod_ops {
 	/* I don't know what this should be used for :) */
 	int (*set_timeout)(struct iiod_ctx *ctx, uint32_t timeout);
 
-	/* I don't know what this should be used for :) */
+	/*
+	 * Binary protocol. Both must be set for the BINARY command to succeed.
+	 * get_names resolves indexes, in the order of the context xml, to
+	 * names. chn_idx is only used when type is IIO_ATTR_TYPE_CH_IN and
+	 * attr is not resolved when attr_idx is negative.
+	 */
+	int (*get_names)(struct iiod_ctx *ctx, uint32_t dev_idx,
+			 int32_t chn_idx, int32_t attr_idx,
+			 enum iio_attr_type type, struct iiod_names *names);
+	/* Get scan size and direction of a buffer with the channels in mask */
+	int (*get_buffer_info)(struct iiod_ctx *ctx, const char *device,
+			       uint32_t mask, uint32_t *scan_size,
+			       bool *is_output);
+
+	/*
+	 * Render len bytes of the context xml starting at offset into buf.
+	 * Optional. When set, the context is generated on each PRINT instead
+	 * of being sent from iiod_init_param.xml, which can be NULL.
+	 */
+	int (*read_xml)(struct iiod_ctx *ctx, uint32_t offset, char *buf,
+			uint32_t len);
+
+	/*
+	 * Event streams of the binary protocol. Optional, the commands fail
+	 * when not set. Events of device are queued for the connection
+	 * between open_events and close_events. read_event copies one event
+	 * in buf and returns its size, or -EAGAIN if there is none yet.
+	 */
+	int (*open_events)(struct iiod_ctx *ctx, const char *device);
+	int (*close_events)(struct iiod_ctx *ctx, const char *device);
+	int (*read_event)(struct iiod_ctx *ctx, const char *device, char *buf,
+			  uint32_t len);
+
+	/*
+	 * Number of blocks of the device buffer, applied by the next open.
+	 * Called for SET BUFFERS_COUNT and, in the binary protocol, with the
+	 * number of blocks created when the buffer is enabled.
+	 */
 	int (*set_buffers_count)(struct iiod_ctx *ctx, const char *device,
 				 uint32_t buffers_count);
 };
@@ -162,7 +235,7 @@ struct iiod_init_param {
 	void *instance;
 	/*
 	 * Xml description of the context and devices. It should exist until
-	 * iiod_remove is called
+	 * iiod_remove is called. Not used if ops->read_xml is set.
 	 */
 	char *xml;
 	/* Size of xml in bytes */
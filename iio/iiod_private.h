@@ -44,6 +44,9 @@
 #define IIOD_ENDL			0x2
 #define IIOD_RD				0x4
 #define IIOD_PARSER_MAX_BUF_SIZE	128
+#define IIOD_CONN_RX_BUF_SIZE		256
+/* Input blocks of the binary protocol waiting to be sent, per connection */
+#define IIOD_BIN_MAX_BLOCKS		8
 
 #define IIOD_STR(cmd) {(cmd), sizeof(cmd) - 1}
 
@@ -75,7 +78,59 @@ enum iiod_cmd {
 	IIOD_CMD_WRITEBUF,
 	IIOD_CMD_GETTRIG,
 	IIOD_CMD_SETTRIG,
-	IIOD_CMD_SET
+	IIOD_CMD_SET,
+	IIOD_CMD_BINARY
+};
+
+/* Operations of the binary protocol, with the libiio v1 numbering */
+enum iiod_bin_op {
+	IIOD_OP_RESPONSE,
+	IIOD_OP_PRINT,
+	IIOD_OP_TIMEOUT,
+	IIOD_OP_READ_ATTR,
+	IIOD_OP_READ_DBG_ATTR,
+	IIOD_OP_READ_BUF_ATTR,
+	IIOD_OP_READ_CHN_ATTR,
+	IIOD_OP_WRITE_ATTR,
+	IIOD_OP_WRITE_DBG_ATTR,
+	IIOD_OP_WRITE_BUF_ATTR,
+	IIOD_OP_WRITE_CHN_ATTR,
+	IIOD_OP_GETTRIG,
+	IIOD_OP_SETTRIG,
+	IIOD_OP_CREATE_BUFFER,
+	IIOD_OP_FREE_BUFFER,
+	IIOD_OP_ENABLE_BUFFER,
+	IIOD_OP_DISABLE_BUFFER,
+	IIOD_OP_CREATE_BLOCK,
+	IIOD_OP_FREE_BLOCK,
+	IIOD_OP_TRANSFER_BLOCK,
+	IIOD_OP_ENQUEUE_BLOCK_CYCLIC,
+	IIOD_OP_RETRY_DEQUEUE_BLOCK,
+	IIOD_OP_CREATE_EVSTREAM,
+	IIOD_OP_FREE_EVSTREAM,
+	IIOD_OP_READ_EVENT,
+	IIOD_NB_OPCODES
+};
+
+/*
+ * Header of binary commands and responses. Responses have op set to
+ * IIOD_OP_RESPONSE, the client_id of the command and the result in code.
+ */
+struct iiod_bin_cmd {
+	uint16_t client_id;
+	uint8_t op;
+	uint8_t dev;
+	int32_t code;
+};
+
+/* TRANSFER_BLOCK command of an input buffer, answered with the block data */
+struct iiod_bin_block {
+	/* Header of the command */
+	struct iiod_bin_cmd cmd;
+	/* Number of bytes requested */
+	uint64_t size;
+	/* Set when the buffer was disabled before the block was sent */
+	bool canceled;
 };
 
 /*
@@ -137,19 +192,65 @@ struct iiod_conn_priv {
 		/* I/O operations for WRITE cmd */
 		IIOD_READING_WRITE_DATA,
 		/* Set when a operation is finalized */
-		IIOD_LINE_DONE
+		IIOD_LINE_DONE,
+		/* Reading the header of a binary command */
+		IIOD_BIN_READING_CMD,
+		/* Reading the fixed size argument of a binary command */
+		IIOD_BIN_READING_ARG
 	} state;
 
 	/* Buffer to store received line */
 	char parser_buf[IIOD_PARSER_MAX_BUF_SIZE];
-	/* Index in parser_buf. For nonblocking operation */
-	uint32_t parser_idx;
+	/* Received data not processed yet. May hold several commands */
+	char rx_buf[IIOD_CONN_RX_BUF_SIZE];
+	/* Index of the first unprocessed byte in rx_buf */
+	uint32_t rx_idx;
+	/* Number of valid bytes in rx_buf */
+	uint32_t rx_len;
+	/* Set if recv can be called with more bytes than needed */
+	bool partial_recv;
 	/* Buffer to store raw data (attributes or buffer data).*/
 	char *payload_buf;
 	/* Length of payload_buf_len */
 	uint32_t payload_buf_len;
 	/* Used in nonbloking transfers to save indexes */
 	struct iiod_buff nb_buf;
+	/* Set while nb_buf points to data from read_buffer_get */
+	bool zc_pending;
+	/* Set while the context xml is generated and sent with read_xml */
+	bool xml_stream;
+	/* Offset in the context xml of the next chunk to be sent */
+	uint32_t xml_offset;
+
+	/* Set after the BINARY command. All further I/O is binary */
+	bool binary;
+	/* Binary command being processed */
+	struct iiod_bin_cmd bin_cmd;
+	/* Response of the binary command */
+	struct iiod_bin_cmd bin_res;
+	/* Length, size or mask following the binary command header */
+	uint64_t bin_arg;
+	/* Names of the objects referenced by the binary command */
+	struct iiod_names bin_names;
+	/* Block size of the binary protocol buffer */
+	uint64_t bin_block_size;
+	/* Number of blocks created for the binary protocol buffer */
+	uint32_t bin_nb_blocks;
+	/* Set if the binary protocol buffer is an output buffer */
+	bool bin_buf_out;
+	/*
+	 * Input blocks requested with TRANSFER_BLOCK and not sent yet. They are
+	 * sent as the device fills them, while other commands are served.
+	 */
+	struct iiod_bin_block bin_blocks[IIOD_BIN_MAX_BLOCKS];
+	/* Index in bin_blocks of the oldest queued block */
+	uint32_t bin_blocks_first;
+	/* Number of queued blocks */
+	uint32_t bin_blocks_count;
+	/* Set while a READ_EVENT waits for an event. Answered between cmds */
+	bool ev_pending;
+	/* Header of the pending READ_EVENT */
+	struct iiod_bin_cmd ev_cmd;
 
 	/* Mask of current opened buffer */
 	uint32_t mask;
@@ -56,4 +56,15 @@ int32_t no_os_axi_io_read(uint32_t base, uint32_t offset, uint32_t *data);
 /* AXI IO Write data */
 int32_t no_os_axi_io_write(uint32_t base, uint32_t offset, uint32_t data);
 
+/* AXI IO Read consecutive registers */
+int32_t no_os_axi_io_read_bulk(uint32_t base, uint32_t offset, uint32_t *data,
+			       uint32_t count);
+
+/* AXI IO Write consecutive registers */
+int32_t no_os_axi_io_write_bulk(uint32_t base, uint32_t offset,
+				const uint32_t *data, uint32_t count);
+
+/* AXI IO Release the resources used to access a base */
+int32_t no_os_axi_io_release(uint32_t base);
+
 #endif // _NO_OS_AXI_IO_H_
@@ -47,6 +47,12 @@
 #define NO_OS_DECLARE_CRC8_TABLE(_table) \
 	static uint8_t _table[NO_OS_CRC8_TABLE_SIZE]
 
+/* x^8 + x^2 + x + 1, msb-first. Used by most ADC register interfaces */
+#define NO_OS_CRC8_POLY_07	0x07
+
+/* Pre-generated table for NO_OS_CRC8_POLY_07, no populate call needed */
+extern const uint8_t no_os_crc8_poly07_table[NO_OS_CRC8_TABLE_SIZE];
+
 void no_os_crc8_populate_msb(uint8_t * table, const uint8_t polynomial);
 uint8_t no_os_crc8(const uint8_t * table, const uint8_t *pdata, size_t nbytes,
 		   uint8_t crc);
@@ -45,10 +45,22 @@
 
 #include <stdint.h>
 
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/**
+ * Minimum object size of a pool used with \ref no_os_fifo_insert_pool for
+ * elements holding up to len bytes
+ */
+#define NO_OS_FIFO_ELEM_SIZE(len)	(sizeof(struct no_os_fifo_element) + (len))
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
 
+struct no_os_pool;
+
 /**
  * @struct no_os_fifo_element
  * @brief Structure holding the fifo element parameters.
@@ -60,6 +72,10 @@ struct no_os_fifo_element {
 	char *data;
 	/** FIFO length */
 	uint32_t len;
+	/** Last FIFO element, only valid on the head */
+	struct no_os_fifo_element *last;
+	/** Pool the element was taken from, NULL for the heap */
+	struct no_os_pool *pool;
 };
 
 /******************************************************************************/
@@ -70,6 +86,11 @@ struct no_os_fifo_element {
 int32_t no_os_fifo_insert(struct no_os_fifo_element **p_fifo, char *buff,
 			  uint32_t len);
 
+/* Insert element to fifo tail, taking it from a pool. */
+int32_t no_os_fifo_insert_pool(struct no_os_fifo_element **p_fifo,
+			       struct no_os_pool *pool, char *buff,
+			       uint32_t len);
+
 /* Remove fifo head. */
 struct no_os_fifo_element *no_os_fifo_remove(struct no_os_fifo_element *p_fifo);
 
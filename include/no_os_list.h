@@ -97,6 +97,13 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/** Minimum object size of a pool used with \ref no_os_list_set_pool */
+#define NO_OS_LIST_ELEM_SIZE	(3 * sizeof(void *))
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
@@ -121,6 +128,8 @@ struct no_os_list_desc;
  */
 struct no_os_iterator;
 
+struct no_os_pool;
+
 /**
  * @brief Prototype of the compare function.
  *
@@ -254,6 +263,8 @@ int32_t no_os_list_init(struct no_os_list_desc **list_desc,
 			enum no_os_adapter_type type,
 			f_cmp comparator);
 int32_t no_os_list_remove(struct no_os_list_desc *list_desc);
+int32_t no_os_list_set_pool(struct no_os_list_desc *list_desc,
+			    struct no_os_pool *pool);
 int32_t no_os_list_get_size(struct no_os_list_desc *list_desc,
 			    uint32_t *out_size);
 
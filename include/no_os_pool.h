@@ -0,0 +1,94 @@
+/***************************************************************************//**
+ *   @file   no_os_pool.h
+ *   @brief  Fixed size object pool
+********************************************************************************
+ * Copyright 2022(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifndef _NO_OS_POOL_H_
+#define _NO_OS_POOL_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/**
+ * @brief Declare memory for a pool of nb objects of obj_size bytes, aligned
+ * for any object type.
+ */
+#define NO_OS_POOL_MEM(name, obj_size, nb) \
+	static void *name[((obj_size) + sizeof(void *) - 1) / sizeof(void *) * (nb)]
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct no_os_pool
+ * @brief Pool of fixed size objects, allocated and freed in constant time
+ * from caller provided memory. Free objects are linked through their first
+ * word.
+ */
+struct no_os_pool {
+	/** Memory holding the objects */
+	uint8_t		*mem;
+	/** Object size in bytes, rounded up to a multiple of a pointer size */
+	uint32_t	obj_size;
+	/** Number of objects in the pool */
+	uint32_t	nb_objs;
+	/** Number of free objects */
+	uint32_t	nb_free;
+	/** First free object */
+	void		*free_list;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+/* Configure a pool using the given memory. */
+int32_t no_os_pool_cfg(struct no_os_pool *pool, void *mem, uint32_t mem_size,
+		       uint32_t obj_size);
+/* Get a free object from the pool. */
+void *no_os_pool_alloc(struct no_os_pool *pool);
+/* Give an object back to the pool. */
+int32_t no_os_pool_free(struct no_os_pool *pool, void *obj);
+
+#endif // _NO_OS_POOL_H_
@@ -98,6 +98,31 @@ struct no_os_spi_msg {
 	uint8_t			cs_change;
 };
 
+/**
+ * @struct no_os_spi_async_req
+ * @brief Asynchronous SPI transfer request. The request and its messages are
+ * owned by the platform driver from submission until the callback is called.
+ */
+struct no_os_spi_async_req {
+	/** Messages to be sent */
+	struct no_os_spi_msg		*msgs;
+	/** Number of messages */
+	uint32_t			len;
+	/**
+	 * Called when the transfer is done. Depending on the platform, it may
+	 * be called from interrupt or worker thread context.
+	 *  @param ctx - Same as \ref no_os_spi_async_req.ctx
+	 *  @param ret - 0 in case of success, negative error code otherwise
+	 */
+	void				(*callback)(void *ctx, int32_t ret);
+	/** Parameter to be passed to the callback */
+	void				*ctx;
+	/** Set by no_os_spi_transfer_async() */
+	struct no_os_spi_desc		*desc;
+	/** Used by the platform driver to queue the request */
+	struct no_os_spi_async_req	*next;
+};
+
 /**
  * @struct no_os_spi_platform_ops
  * @brief Structure holding SPI function pointers that point to the platform
@@ -157,6 +182,9 @@ struct no_os_spi_platform_ops {
 	int32_t (*write_and_read)(struct no_os_spi_desc *, uint8_t *, uint16_t);
 	/** Iterate over the spi_msg array and send all messages at once */
 	int32_t (*transfer)(struct no_os_spi_desc *, struct no_os_spi_msg *, uint32_t);
+	/** Queue a request and return without waiting for it to be sent */
+	int32_t (*transfer_async)(struct no_os_spi_desc *,
+				  struct no_os_spi_async_req *);
 	/** SPI remove function pointer */
 	int32_t (*remove)(struct no_os_spi_desc *);
 };
@@ -182,5 +210,8 @@ int32_t no_os_spi_transfer(struct no_os_spi_desc *desc,
 			   struct no_os_spi_msg *msgs,
 			   uint32_t len);
 
+/* Queue a transfer and call its callback when the transfer is done. */
+int32_t no_os_spi_transfer_async(struct no_os_spi_desc *desc,
+				 struct no_os_spi_async_req *req);
 
 #endif // _NO_OS_SPI_H_
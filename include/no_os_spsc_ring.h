@@ -0,0 +1,117 @@
+/***************************************************************************//**
+ *   @file   no_os_spsc_ring.h
+ *   @brief  Lock-free single producer, single consumer ring buffer
+********************************************************************************
+ * Copyright 2022(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifndef _NO_OS_SPSC_RING_H_
+#define _NO_OS_SPSC_RING_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct no_os_spsc_ring
+ * @brief Ring buffer with one producer and one consumer, which may run in
+ * different contexts (e.g. interrupt and main loop) without locking.
+ * The indexes are free running and wrap naturally, the position in the buffer
+ * is obtained by masking them with size - 1.
+ */
+struct no_os_spsc_ring {
+	/** Buffer memory */
+	uint8_t			*buff;
+	/** Size of buff in bytes, power of two */
+	uint32_t		size;
+	/** size - 1 */
+	uint32_t		mask;
+	/** Total bytes committed by the producer */
+	_Atomic uint32_t	write_idx;
+	/** Total bytes committed by the consumer */
+	_Atomic uint32_t	read_idx;
+};
+
+/**
+ * @struct no_os_spsc_span
+ * @brief Contiguous parts of a reserved region. The second part is used only
+ * when the region wraps around the end of the buffer.
+ */
+struct no_os_spsc_span {
+	/** Start of each part */
+	uint8_t		*data[2];
+	/** Length of each part in bytes */
+	uint32_t	len[2];
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+/* Configure the ring to use the given memory. */
+int32_t no_os_spsc_ring_cfg(struct no_os_spsc_ring *ring, uint8_t *buff,
+			    uint32_t size);
+/* Number of bytes available to the consumer. */
+uint32_t no_os_spsc_ring_used(struct no_os_spsc_ring *ring);
+/* Number of bytes available to the producer. */
+uint32_t no_os_spsc_ring_free(struct no_os_spsc_ring *ring);
+
+/* Producer: get up to len free bytes to be written in place. */
+uint32_t no_os_spsc_ring_write_reserve(struct no_os_spsc_ring *ring,
+				       uint32_t len,
+				       struct no_os_spsc_span *span);
+/* Producer: make len reserved bytes available to the consumer. */
+void no_os_spsc_ring_write_commit(struct no_os_spsc_ring *ring, uint32_t len);
+/* Consumer: get up to len used bytes to be read in place. */
+uint32_t no_os_spsc_ring_read_reserve(struct no_os_spsc_ring *ring,
+				      uint32_t len,
+				      struct no_os_spsc_span *span);
+/* Consumer: release len reserved bytes to the producer. */
+void no_os_spsc_ring_read_commit(struct no_os_spsc_ring *ring, uint32_t len);
+
+/* Producer: copy len bytes into the ring, all or nothing. */
+int32_t no_os_spsc_ring_push(struct no_os_spsc_ring *ring, const void *data,
+			     uint32_t len);
+/* Consumer: copy len bytes out of the ring, all or nothing. */
+int32_t no_os_spsc_ring_pop(struct no_os_spsc_ring *ring, void *data,
+			    uint32_t len);
+
+#endif //_NO_OS_SPSC_RING_H_
@@ -168,7 +168,10 @@ DRESULT disk_ioctl (
 	switch(pdrv) {
 	case DEV_SD:
 		switch (cmd){
-		case CTRL_SYNC: return RES_OK;
+		case CTRL_SYNC:
+			if (0 != sd_sync(sd_desc))
+				return RES_ERROR;
+			return RES_OK;
 		case GET_SECTOR_COUNT:
 			*(LBA_t *)buff = sd_desc->memory_size / DATA_BLOCK_LEN;
 			return RES_OK;
@@ -182,6 +185,14 @@ DRESULT disk_ioctl (
 			 * sector size in the SD card specification */
 			*(DWORD *)buff = ERASE_SECTOR_SIZE;
 			return RES_OK;
+		case MMC_SET_PREALLOC:
+			/* Sectors the caller is going to write one after the
+			 * other, so the card can pre-erase them */
+			if (0 != sd_set_prealloc(sd_desc,
+						 (uint64_t)((LBA_t *)buff)[0] * 512,
+						 (uint64_t)((LBA_t *)buff)[1] * 512))
+				return RES_PARERR;
+			return RES_OK;
 		default: return RES_OK;
 		}
 		return RES_PARERR;
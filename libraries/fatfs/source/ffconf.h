@@ -46,8 +46,11 @@
 /* This option switches fast seek function. (0:Disable or 1:Enable) */
 
 
+#ifndef FF_USE_EXPAND
 #define FF_USE_EXPAND	0
-/* This option switches f_expand function. (0:Disable or 1:Enable) */
+#endif
+/* This option switches f_expand function. (0:Disable or 1:Enable)
+/  Projects using f_expand() enable it with -DFF_USE_EXPAND=1 in their CFLAGS. */
 
 
 #define FF_USE_CHMOD	0
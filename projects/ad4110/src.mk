@@ -20,7 +20,8 @@ SRCS += $(PLATFORM_DRIVERS)/xilinx_spi.c \
 	$(PLATFORM_DRIVERS)/xilinx_gpio.c \
 	$(PLATFORM_DRIVERS)/xilinx_gpio_irq.c \
 	$(PLATFORM_DRIVERS)/delay.c \
-	$(NO-OS)/util/no_os_list.c
+	$(NO-OS)/util/no_os_list.c \
+	$(NO-OS)/util/no_os_pool.c
 
 INCS += $(DRIVERS)/afe/ad4110/ad4110.h
 
@@ -36,4 +37,5 @@ INCS += $(INCLUDE)/no_os_spi.h \
 	$(INCLUDE)/no_os_irq.h \
 	$(INCLUDE)/no_os_util.h \
 	$(INCLUDE)/no_os_print_log.h \
-	$(INCLUDE)/no_os_list.h
+	$(INCLUDE)/no_os_list.h \
+	$(INCLUDE)/no_os_pool.h
@@ -31,7 +31,8 @@ SRCS += $(PLATFORM_DRIVERS)/no_os_uart.c \
 	$(DRIVERS)/api/no_os_irq.c \
 	$(DRIVERS)/adc/ad463x/iio_ad463x.c \
 	$(NO-OS)/util/no_os_fifo.c \
-	$(NO-OS)/util/no_os_list.c
+	$(NO-OS)/util/no_os_list.c \
+	$(NO-OS)/util/no_os_pool.c
 endif
 INCS += $(PROJECT)/src/parameters.h
 INCS += $(DRIVERS)/adc/ad463x/ad463x.h \
@@ -57,5 +58,6 @@ INCS +=	$(INCLUDE)/no_os_axi_io.h \
 ifeq (y,$(strip $(TINYIIOD)))
 INCS += $(DRIVERS)/adc/ad463x/iio_ad463x.h \
 	$(INCLUDE)/no_os_fifo.h \
-	$(INCLUDE)/no_os_list.h
+	$(INCLUDE)/no_os_list.h \
+	$(INCLUDE)/no_os_pool.h
 endif
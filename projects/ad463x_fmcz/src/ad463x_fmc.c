@@ -62,6 +62,14 @@
 /********************** Macros and Constants Definitions **********************/
 /******************************************************************************/
 #define AD463x_EVB_SAMPLE_NO		1000
+/* Continuous capture ring: 8 blocks of 2ms at 2MSPS */
+#define AD463x_STREAM_BLOCK_SAMPLES	4096
+#define AD463x_STREAM_NB_BLOCKS		8
+
+#ifdef IIO_SUPPORT
+static uint32_t stream_buf[AD463x_STREAM_BLOCK_SAMPLES *
+			   AD463x_STREAM_NB_BLOCKS] __attribute__ ((aligned));
+#endif
 
 /* Main function */
 int main()
@@ -206,6 +214,11 @@ int main()
 	if(ret < 0)
 		return ret;
 
+	/* Capture continuously while the IIO buffer is enabled */
+	iio_ad463x->stream_buf = stream_buf;
+	iio_ad463x->stream_block_samples = AD463x_STREAM_BLOCK_SAMPLES;
+	iio_ad463x->stream_nb_blocks = AD463x_STREAM_NB_BLOCKS;
+
 	struct iio_app_device devices[] = {
 		IIO_APP_DEVICE("ad463x", iio_ad463x, &iio_ad463x->iio_dev_desc,
 			       &rd_buff, NULL),
@@ -30,7 +30,8 @@ SRCS += $(PLATFORM_DRIVERS)/no_os_uart.c \
 	$(PLATFORM_DRIVERS)/$(PLATFORM)_irq.c \
 	$(DRIVERS)/api/no_os_irq.c \
 	$(NO-OS)/util/no_os_fifo.c \
-	$(NO-OS)/util/no_os_list.c	
+	$(NO-OS)/util/no_os_list.c \
+	$(NO-OS)/util/no_os_pool.c
 endif
 INCS += $(DRIVERS)/axi_core/axi_dmac/axi_dmac.h \
 	$(DRIVERS)/axi_core/axi_pwmgen/axi_pwm_extra.h \
@@ -52,5 +53,6 @@ INCS +=	$(INCLUDE)/no_os_axi_io.h \
 	$(INCLUDE)/no_os_util.h
 ifeq (y,$(strip $(TINYIIOD)))
 INCS += $(INCLUDE)/no_os_fifo.h \
-	$(INCLUDE)/no_os_list.h
+	$(INCLUDE)/no_os_list.h \
+	$(INCLUDE)/no_os_pool.h
 endif
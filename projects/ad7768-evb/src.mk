@@ -14,6 +14,7 @@ SRCS += $(PROJECT)/src/ad7768_evb.c
 SRCS += $(NO-OS)/util/no_os_fifo.c
 SRCS += $(NO-OS)/util/no_os_util.c
 SRCS += $(NO-OS)/util/no_os_list.c
+SRCS += $(NO-OS)/util/no_os_pool.c
 
 # Add to INCS inlcude files to be build in the project
 INCS += $(INCLUDE)/no_os_error.h
@@ -27,6 +28,7 @@ INCS += $(INCLUDE)/no_os_i2c.h
 INCS += $(INCLUDE)/no_os_uart.h
 INCS +=	$(INCLUDE)/no_os_irq.h
 INCS += $(INCLUDE)/no_os_list.h
+INCS += $(INCLUDE)/no_os_pool.h
 INCS += $(INCLUDE)/no_os_fifo.h
 INCS += $(PROJECT)/src/parameters.h
 
@@ -51,12 +53,14 @@ SRC_DIRS += $(NO-OS)/iio/iio_app
 INCS +=	$(INCLUDE)/no_os_fifo.h \
 	$(INCLUDE)/no_os_uart.h \
 	$(INCLUDE)/no_os_list.h \
+	$(INCLUDE)/no_os_pool.h \
 	$(PLATFORM_DRIVERS)/irq_extra.h \
 	$(PLATFORM_DRIVERS)/uart_extra.h \
 	$(DRIVERS)/axi_core/iio_axi_adc/iio_axi_adc.h
 SRCS += $(NO-OS)/util/no_os_fifo.c \
 	$(DRIVERS)/axi_core/iio_axi_adc/iio_axi_adc.c \
 	$(NO-OS)/util/no_os_list.c \
+	$(NO-OS)/util/no_os_pool.c \
 	$(PLATFORM_DRIVERS)/no_os_uart.c \
 	$(PLATFORM_DRIVERS)/$(PLATFORM)_irq.c
 endif
@@ -22,9 +22,11 @@ SRC_DIRS += $(DRIVERS)/axi_core/iio_axi_adc \
 
 SRCS	+= $(PLATFORM_DRIVERS)/no_os_uart.c \
 		$(PLATFORM_DRIVERS)/$(PLATFORM)_irq.c \
-		$(NO-OS)/util/no_os_list.c 
+		$(NO-OS)/util/no_os_list.c \
+		$(NO-OS)/util/no_os_pool.c
 INCS	+= $(INCLUDE)/no_os_uart.h \
 		$(INCLUDE)/no_os_list.h \
+		$(INCLUDE)/no_os_pool.h \
 		$(INCLUDE)/no_os_irq.h \
 		$(PLATFORM_DRIVERS)/irq_extra.h \
 		$(PLATFORM_DRIVERS)/uart_extra.h
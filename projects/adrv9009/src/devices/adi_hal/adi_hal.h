@@ -26,6 +26,10 @@ struct adi_hal {
 	uint8_t			spi_adrv_csn;
 	void 			*extra_gpio;
 	uint8_t			gpio_adrv_resetb_num;
+	/* SPI streaming enabled in the device, tracked from config writes */
+	uint8_t			spi_streaming;
+	/* Streaming address direction, 1 = addr + 1, 0 = addr - 1 */
+	uint8_t			spi_addr_ascend;
 };
 
 /**
@@ -41,6 +41,7 @@
 /***************************** Include Files **********************************/
 /******************************************************************************/
 #include <stdio.h>
+#include <stdbool.h>
 #include "adi_hal.h"
 #include "parameters.h"
 #include "no_os_spi.h"
@@ -50,6 +51,19 @@
 #include "no_os_error.h"
 #include "no_os_delay.h"
 
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define ADIHAL_SPI_READ			0x80
+#define ADIHAL_SPI_CONFIG_A		0x000
+#define ADIHAL_SPI_CONFIG_B		0x001
+#define ADIHAL_SPI_SOFT_RESET		0x81
+#define ADIHAL_SPI_ADDR_ASCENSION	0x24
+#define ADIHAL_SPI_SINGLE_INSTRUCTION	0x80
+/* Frames and bytes sent with a single no_os_spi_transfer() call */
+#define ADIHAL_SPI_BATCH_MSGS		32
+#define ADIHAL_SPI_BATCH_BYTES		128
+
 /******************************************************************************/
 /************************** Functions Implementation **************************/
 /******************************************************************************/
@@ -101,6 +115,8 @@ adiHalErr_t ADIHAL_openHw(void *devHalInfo, uint32_t halTimeout_ms)
 		spi_param.extra = dev_hal_data->extra_spi;
 
 	status |= no_os_spi_init(&dev_hal_data->spi_adrv_desc, &spi_param);
+	dev_hal_data->spi_streaming = 0;
+	dev_hal_data->spi_addr_ascend = 0;
 
 	status |= no_os_gpio_get(&dev_hal_data->gpio_adrv_sysref_req,
 				 &gpio_adrv_sysref_req_param);
@@ -139,6 +155,9 @@ adiHalErr_t ADIHAL_resetHw(void *devHalInfo)
 	no_os_gpio_direction_output(devHalData->gpio_adrv_resetb, 1);
 	no_os_mdelay(10);
 
+	devHalData->spi_streaming = 0;
+	devHalData->spi_addr_ascend = 0;
+
 	return ADIHAL_OK;
 }
 
@@ -161,6 +180,107 @@ adiHalErr_t ADIHAL_sysrefReq(void *devHalInfo, sysrefReqMode_t mode)
 
 }
 
+/**
+ * @brief Keep track of the device SPI mode, so that consecutive registers
+ * are only streamed when the device is configured for it.
+ * @param hal - The HAL descriptor.
+ * @param addr - Written register address.
+ * @param data - Written register value.
+ */
+static void adihal_spi_track_config(struct adi_hal *hal, uint16_t addr,
+				    uint8_t data)
+{
+	if (addr == ADIHAL_SPI_CONFIG_A) {
+		if (data & ADIHAL_SPI_SOFT_RESET) {
+			hal->spi_streaming = 0;
+			hal->spi_addr_ascend = 0;
+			return;
+		}
+		hal->spi_addr_ascend = (data & ADIHAL_SPI_ADDR_ASCENSION) ==
+				       ADIHAL_SPI_ADDR_ASCENSION;
+	} else if (addr == ADIHAL_SPI_CONFIG_B) {
+		hal->spi_streaming = !(data & ADIHAL_SPI_SINGLE_INSTRUCTION);
+	}
+}
+
+/**
+ * @brief Access a list of registers using as few SPI transfers as possible.
+ *
+ * Every register access becomes a frame in a no_os_spi_transfer() message
+ * array, so up to ADIHAL_SPI_BATCH_MSGS accesses are handed to the SPI driver
+ * at once. When streaming is enabled in the device, runs of consecutive
+ * addresses (in the configured direction) share a single instruction.
+ * @param hal - The HAL descriptor.
+ * @param addr - Register addresses.
+ * @param data - Values to write or buffer for the read values.
+ * @param count - Number of registers.
+ * @param is_read - true for reads, false for writes.
+ * @return ADIHAL_OK in case of success, ADIHAL_SPI_FAIL otherwise.
+ */
+static adiHalErr_t adihal_spi_batch(struct adi_hal *hal, uint16_t *addr,
+				    uint8_t *data, uint32_t count, bool is_read)
+{
+	struct no_os_spi_msg msgs[ADIHAL_SPI_BATCH_MSGS];
+	uint8_t buf[ADIHAL_SPI_BATCH_BYTES];
+	uint32_t nb_msgs = 0;
+	uint32_t first = 0;
+	uint32_t pos = 0;
+	uint32_t i = 0;
+	uint32_t j, k;
+	uint16_t next;
+	int32_t status;
+
+	while (i < count) {
+		/* Frame start: instruction and the first data byte */
+		msgs[nb_msgs].tx_buff = &buf[pos];
+		msgs[nb_msgs].rx_buff = &buf[pos];
+		msgs[nb_msgs].cs_change = 1;
+		buf[pos++] = (is_read ? ADIHAL_SPI_READ : 0) |
+			     ((addr[i] >> 8) & 0x7F);
+		buf[pos++] = addr[i] & 0xFF;
+		buf[pos++] = is_read ? 0 : data[i];
+		if (!is_read)
+			adihal_spi_track_config(hal, addr[i], data[i]);
+		i++;
+
+		/* Stream the following registers if they are consecutive */
+		while (hal->spi_streaming && i < count &&
+		       pos < ADIHAL_SPI_BATCH_BYTES &&
+		       addr[i] > ADIHAL_SPI_CONFIG_B) {
+			next = hal->spi_addr_ascend ? addr[i - 1] + 1 :
+			       addr[i - 1] - 1;
+			if (addr[i] != next)
+				break;
+			buf[pos++] = is_read ? 0 : data[i];
+			i++;
+		}
+
+		msgs[nb_msgs].bytes_number = &buf[pos] - msgs[nb_msgs].tx_buff;
+		nb_msgs++;
+
+		if (i < count && nb_msgs < ADIHAL_SPI_BATCH_MSGS &&
+		    pos + 3 <= ADIHAL_SPI_BATCH_BYTES)
+			continue;
+
+		status = no_os_spi_transfer(hal->spi_adrv_desc, msgs, nb_msgs);
+		if (status != 0)
+			return ADIHAL_SPI_FAIL;
+
+		if (is_read) {
+			/* Data bytes follow the 2 byte instruction of each frame */
+			for (j = 0; j < nb_msgs; j++)
+				for (k = 2; k < msgs[j].bytes_number; k++)
+					data[first++] = msgs[j].rx_buff[k];
+		}
+
+		first = i;
+		nb_msgs = 0;
+		pos = 0;
+	}
+
+	return ADIHAL_OK;
+}
+
 adiHalErr_t ADIHAL_spiWriteByte(void *devHalInfo,
 				uint16_t addr, uint8_t data)
 {
@@ -175,23 +295,17 @@ adiHalErr_t ADIHAL_spiWriteByte(void *devHalInfo,
 
 	if (status != 0)
 		return ADIHAL_SPI_FAIL;
-	else
-		return ADIHAL_OK;
+
+	adihal_spi_track_config(devHalData, addr, data);
+
+	return ADIHAL_OK;
 }
 
 adiHalErr_t ADIHAL_spiWriteBytes(void *devHalInfo,
 				 uint16_t *addr, uint8_t *data, uint32_t count)
 {
-	adiHalErr_t errVal;
-	uint32_t i;
-
-	for (i = 0; i < count; i++) {
-		errVal = ADIHAL_spiWriteByte(devHalInfo, addr[i], data[i]);
-		if (errVal)
-			return errVal;
-	}
-
-	return ADIHAL_OK;
+	return adihal_spi_batch((struct adi_hal *)devHalInfo, addr, data, count,
+				false);
 }
 
 adiHalErr_t ADIHAL_spiReadByte(void *devHalInfo,
@@ -218,16 +332,8 @@ adiHalErr_t ADIHAL_spiReadByte(void *devHalInfo,
 adiHalErr_t ADIHAL_spiReadBytes(void *devHalInfo,
 				uint16_t *addr, uint8_t *readdata, uint32_t count)
 {
-	adiHalErr_t errVal;
-	uint32_t i;
-
-	for (i = 0; i < count; i++) {
-		errVal = ADIHAL_spiReadByte(devHalInfo, addr[i], &readdata[i]);
-		if (errVal)
-			return errVal;
-	}
-
-	return ADIHAL_OK;
+	return adihal_spi_batch((struct adi_hal *)devHalInfo, addr, readdata,
+				count, true);
 }
 
 adiHalErr_t ADIHAL_spiWriteField(void *devHalInfo,
@@ -22,7 +22,8 @@ SRCS += $(DRIVERS)/axi_core/axi_dmac/axi_dmac.c \
 	$(DRIVERS)/api/no_os_gpio.c \
 	$(DRIVERS)/api/no_os_spi.c \
 	$(NO-OS)/util/no_os_util.c \
-	$(NO-OS)/util/no_os_list.c
+	$(NO-OS)/util/no_os_list.c \
+	$(NO-OS)/util/no_os_pool.c
 SRCS +=	$(PLATFORM_DRIVERS)/axi_io.c \
 	$(PLATFORM_DRIVERS)/xilinx_spi.c \
 	$(PLATFORM_DRIVERS)/xilinx_gpio.c \
@@ -58,6 +59,7 @@ INCS +=	$(INCLUDE)/no_os_axi_io.h \
 	$(INCLUDE)/no_os_delay.h \
 	$(INCLUDE)/no_os_util.h \
 	$(INCLUDE)/no_os_list.h \
+	$(INCLUDE)/no_os_pool.h \
 	$(INCLUDE)/no_os_i2c.h \
 	$(INCLUDE)/no_os_irq.h \
 	$(INCLUDE)/no_os_timer.h
@@ -1,5 +1,6 @@
 SRCS += $(NO-OS)/util/no_os_util.c \
 	$(NO-OS)/util/no_os_list.c \
+	$(NO-OS)/util/no_os_pool.c \
 	$(PLATFORM_DRIVERS)/delay.c \
 	$(PLATFORM_DRIVERS)/no_os_timer.c \
 	$(PLATFORM_DRIVERS)/$(PLATFORM)_i2c.c \
@@ -16,6 +17,7 @@ SRCS += $(NO-OS)/util/no_os_util.c \
 INCS +=	$(INCLUDE)/no_os_uart.h \
 	$(INCLUDE)/no_os_util.h \
 	$(INCLUDE)/no_os_list.h \
+	$(INCLUDE)/no_os_pool.h \
 	$(INCLUDE)/no_os_delay.h \
 	$(INCLUDE)/no_os_timer.h \
 	$(INCLUDE)/no_os_error.h \
@@ -2,6 +2,16 @@ SRC_DIRS += $(PROJECT)/src
 
 ifeq (y,$(strip $(TINYIIOD)))
 SRC_DIRS += $(NO-OS)/iio/iio_app
+
+# Capture a scan on each DRDY pulse, see parameters.h
+ifeq (y,$(strip $(IIO_TRIGGER)))
+CFLAGS += -DIIO_TRIGGER_SUPPORT
+endif
+
+# Push an activity event on each INT1 pulse, see parameters.h
+ifeq (y,$(strip $(IIO_EVENTS)))
+CFLAGS += -DIIO_EVENT_SUPPORT
+endif
 endif
 
 INCS +=	$(INCLUDE)/no_os_uart.h \
@@ -31,6 +41,7 @@ INCS += $(DRIVERS)/accel/adxl355/iio_adxl355.h
 
 INCS += $(INCLUDE)/no-os/fifo.h \
 	$(INCLUDE)/no_os_list.h \
+	$(INCLUDE)/no_os_pool.h \
 	$(PLATFORM_DRIVERS)/uart_extra.h
 
 INCS += $(PROJECT)/src/app_config.h \
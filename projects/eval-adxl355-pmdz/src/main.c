@@ -30,6 +30,68 @@ extern UART_HandleTypeDef huart5;
 
 // For output data you will need DATA_BUFFER_SIZE*4*sizeof(int32_t)
 uint8_t iio_data_buffer[DATA_BUFFER_SIZE*4*sizeof(int)];
+
+#ifdef IIO_TRIGGER_SUPPORT
+// Trigger reading a scan on each DRDY pulse, from the EXTI interrupt
+struct drdy_trig {
+	struct iio_desc *iio_desc;
+	uint32_t trig_id;
+};
+
+static struct drdy_trig adxl355_drdy_trig;
+
+static int drdy_trig_enable(void *trig)
+{
+	HAL_NVIC_EnableIRQ(DRDY_EXTI_IRQn);
+
+	return 0;
+}
+
+static int drdy_trig_disable(void *trig)
+{
+	HAL_NVIC_DisableIRQ(DRDY_EXTI_IRQn);
+
+	return 0;
+}
+
+static int drdy_trig_bind(void *trig, struct iio_desc *desc, uint32_t trig_id)
+{
+	struct drdy_trig *ltrig = trig;
+
+	ltrig->trig_id = trig_id;
+	ltrig->iio_desc = desc;
+
+	return 0;
+}
+
+static struct iio_trigger drdy_trig_desc = {
+	.enable = drdy_trig_enable,
+	.disable = drdy_trig_disable,
+	.bind = drdy_trig_bind,
+};
+#endif
+
+#ifdef IIO_EVENT_SUPPORT
+// Activity events are pushed from the INT1 EXTI interrupt
+static struct iio_desc *adxl355_iio_app_desc;
+static struct adxl355_iio_dev *adxl355_act_dev;
+#endif
+
+#if defined(IIO_TRIGGER_SUPPORT) || defined(IIO_EVENT_SUPPORT)
+void HAL_GPIO_EXTI_Callback(uint16_t pin)
+{
+#ifdef IIO_TRIGGER_SUPPORT
+	if (pin == DRDY_PIN && adxl355_drdy_trig.iio_desc)
+		iio_process_trigger(adxl355_drdy_trig.iio_desc,
+				    adxl355_drdy_trig.trig_id);
+#endif
+#ifdef IIO_EVENT_SUPPORT
+	if (pin == ACT_PIN && adxl355_iio_app_desc)
+		adxl355_iio_push_activity(adxl355_iio_app_desc,
+					  adxl355_act_dev, 0);
+#endif
+}
+#endif
 #endif
 
 int main ()
@@ -90,16 +152,65 @@ int main ()
 	if (ret != SUCCESS)
 		return ret;
 
+#ifdef IIO_EVENT_SUPPORT
+	union adxl355_act_en_flags act_en = {
+		.fields = { .ACT_X = 1, .ACT_Y = 1 }
+	};
+	union adxl355_int_mask int_map = {
+		.fields = { .ACT_EN1 = 1 }
+	};
+
+	adxl355_act_dev = adxl355_iio_desc;
+
+	ret = adxl355_conf_act_thr(adxl355_iio_desc->adxl355_dev, ACT_THRESH);
+	if (ret)
+		return ret;
+	ret = adxl355_conf_act_en(adxl355_iio_desc->adxl355_dev, act_en);
+	if (ret)
+		return ret;
+	ret = adxl355_config_int_pins(adxl355_iio_desc->adxl355_dev, int_map);
+	if (ret)
+		return ret;
+#endif
+
+#ifdef IIO_TRIGGER_SUPPORT
+	// No scans until a buffer using the trigger is enabled
+	HAL_NVIC_DisableIRQ(DRDY_EXTI_IRQn);
+
+	struct iio_trigger_init iio_trigs[] = {
+		{
+			.name = "adxl355-drdy",
+			.trig = &adxl355_drdy_trig,
+			.descriptor = &drdy_trig_desc,
+		}
+	};
+#endif
+
 	struct iio_app_device iio_devices[] = {
 		{
 			.name = "adxl355",
 			.dev = adxl355_iio_desc,
 			.dev_descriptor = adxl355_iio_desc->iio_dev,
 			.read_buff = &accel_buff,
+#ifdef IIO_TRIGGER_SUPPORT
+			.trigger_id = "trigger0",
+#endif
 		}
 	};
 
-	return iio_app_run(iio_devices, NO_OS_ARRAY_SIZE(iio_devices));
+	struct iio_app_init_param app_init_param = {
+		.devices = iio_devices,
+		.nb_devices = NO_OS_ARRAY_SIZE(iio_devices),
+#ifdef IIO_TRIGGER_SUPPORT
+		.trigs = iio_trigs,
+		.nb_trigs = NO_OS_ARRAY_SIZE(iio_trigs),
+#endif
+#ifdef IIO_EVENT_SUPPORT
+		.desc = &adxl355_iio_app_desc,
+#endif
+	};
+
+	return iio_app_run_with_param(&app_init_param);
 #else
 	ret = no_os_uart_init(&uart, &uip);
 	if (ret < 0)
@@ -111,6 +111,30 @@ extern UART_HandleTypeDef huart5;
 #define IIO_APP_HUART	(&huart5)
 #define UART_BAUDRATE	115200
 
+#ifdef IIO_TRIGGER_SUPPORT
+/*
+ * The DRDY pin of the PMOD has to be set as GPIO_EXTI in sdp-ck1z.ioc, with
+ * its NVIC interrupt enabled. DRDY_PIN and DRDY_EXTI_IRQn are the GPIO_PIN_x
+ * and EXTIx_IRQn of that pin, e.g. given in CFLAGS.
+ */
+#if !defined(DRDY_PIN) || !defined(DRDY_EXTI_IRQn)
+#error "Define DRDY_PIN and DRDY_EXTI_IRQn for the DRDY trigger"
+#endif
+#endif
+
+#ifdef IIO_EVENT_SUPPORT
+/*
+ * Activity is mapped to the INT1 pin of the PMOD, which has to be set as
+ * GPIO_EXTI in sdp-ck1z.ioc like DRDY. ACT_PIN and ACT_EXTI_IRQn are the
+ * GPIO_PIN_x and EXTIx_IRQn of that pin.
+ */
+#if !defined(ACT_PIN) || !defined(ACT_EXTI_IRQn)
+#error "Define ACT_PIN and ACT_EXTI_IRQn for the activity events"
+#endif
+/* Activity threshold on X and Y, in units of 8 LSB of the acceleration data */
+#define ACT_THRESH	0x1000
+#endif
+
 #endif // STM32_PLATFORM
 
 #ifdef USE_TCP_SOCKET
@@ -3,6 +3,7 @@ SRC_DIRS += $(PROJECT)/src/app
 SRC_DIRS += $(NO-OS)/iio/iio_app
 
 SRCS +=	$(NO-OS)/util/no_os_list.c \
+	$(NO-OS)/util/no_os_pool.c \
 	$(NO-OS)/util/no_os_fifo.c \
 	$(NO-OS)/util/no_os_util.c
 
@@ -15,6 +16,7 @@ SRCS += $(DRIVERS)/adc/adc_demo/adc_demo.c \
 INCS += $(INCLUDE)/no_os_fifo.h \
 	$(INCLUDE)/no_os_uart.h \
 	$(INCLUDE)/no_os_list.h \
+	$(INCLUDE)/no_os_pool.h \
 	$(INCLUDE)/no_os_util.h \
 	$(INCLUDE)/no_os_error.h
 
@@ -44,6 +44,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include "no_os_fifo.h"
+#include "no_os_pool.h"
 #include "no_os_error.h"
 
 /******************************************************************************/
@@ -51,70 +52,83 @@
 /******************************************************************************/
 
 /**
- * @brief Create new fifo element
+ * @brief Create new fifo element. The data is stored right after the element,
+ * so a single allocation is needed.
+ * @param pool - Pool the element is taken from, NULL to use the heap.
  * @param buff - Data to be saved in fifo.
  * @param len - Length of the data.
  * @return fifo element in case of success, NULL otherwise
  */
-static struct no_os_fifo_element * fifo_new_element(char *buff, uint32_t len)
+static struct no_os_fifo_element * fifo_new_element(struct no_os_pool *pool,
+		char *buff, uint32_t len)
 {
-	struct no_os_fifo_element *q = calloc(1, sizeof(struct no_os_fifo_element));
-	if (!q)
-		return NULL;
+	struct no_os_fifo_element *q;
+
+	if (pool) {
+		if (NO_OS_FIFO_ELEM_SIZE(len) > pool->obj_size)
+			return NULL;
+		q = no_os_pool_alloc(pool);
+		if (!q)
+			return NULL;
+		memset(q, 0, sizeof(*q));
+	} else {
+		q = calloc(1, NO_OS_FIFO_ELEM_SIZE(len));
+		if (!q)
+			return NULL;
+	}
 
+	q->pool = pool;
 	q->len = len;
-	q->data = calloc(1, len);
-	if (!(q->data)) {
-		free(q);
-		return NULL;
-	}
+	q->data = (char *)(q + 1);
 	memcpy(q->data, buff, len);
 
 	return q;
 }
 
 /**
- * @brief Get last element in fifo
- * @param p_fifo - pointer to fifo
- * @return fifo last element if exists, NULL otherwise
+ * @brief Insert element to fifo, in the last position.
+ * @param p_fifo - Pointer to fifo.
+ * @param buff - Data to be saved in fifo.
+ * @param len - Length of the data.
+ * @return 0 in case of success, -1 otherwise
  */
-static struct no_os_fifo_element *no_os_fifo_get_last(struct no_os_fifo_element
-		*p_fifo)
+int32_t no_os_fifo_insert(struct no_os_fifo_element **p_fifo, char *buff,
+			  uint32_t len)
 {
-	if(p_fifo == NULL)
-		return NULL;
-	while (p_fifo->next) {
-		p_fifo = p_fifo->next;
-	}
-
-	return p_fifo;
+	return no_os_fifo_insert_pool(p_fifo, NULL, buff, len);
 }
 
 /**
- * @brief Insert element to fifo, in the last position.
+ * @brief Insert element to fifo, in the last position. The element is taken
+ * from a pool whose objects are at least NO_OS_FIFO_ELEM_SIZE(len) bytes, so
+ * no heap allocation is done. Elements of the same fifo may come from
+ * different pools.
  * @param p_fifo - Pointer to fifo.
+ * @param pool - Pool the element is taken from, NULL to use the heap.
  * @param buff - Data to be saved in fifo.
  * @param len - Length of the data.
- * @return 0 in case of success, -1 otherwise
+ * @return 0 in case of success, -1 otherwise (e.g. the pool is exhausted)
  */
-int32_t no_os_fifo_insert(struct no_os_fifo_element **p_fifo, char *buff,
-			  uint32_t len)
+int32_t no_os_fifo_insert_pool(struct no_os_fifo_element **p_fifo,
+			       struct no_os_pool *pool, char *buff,
+			       uint32_t len)
 {
 	struct no_os_fifo_element *p, *q;
 
 	if (len <= 0)
 		return -1;
 
-	q = fifo_new_element(buff, len);
+	q = fifo_new_element(pool, buff, len);
 	if (!q)
 		return -1;
 
 	if (!(*p_fifo)) {
 		*p_fifo = q;
 	} else {
-		p = no_os_fifo_get_last(*p_fifo);
+		p = (*p_fifo)->last;
 		p->next = q;
 	}
+	(*p_fifo)->last = q;
 
 	return 0;
 }
@@ -130,8 +144,12 @@ struct no_os_fifo_element * no_os_fifo_remove(struct no_os_fifo_element *p_fifo)
 
 	if (p_fifo != NULL) {
 		p_fifo = p_fifo->next;
-		free(p->data);
-		free(p);
+		if (p_fifo)
+			p_fifo->last = p->last;
+		if (p->pool)
+			no_os_pool_free(p->pool, p);
+		else
+			free(p);
 	}
 
 	return p_fifo;
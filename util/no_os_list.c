@@ -42,6 +42,7 @@
 /******************************************************************************/
 
 #include "no_os_list.h"
+#include "no_os_pool.h"
 #include "no_os_error.h"
 #include <stdlib.h>
 
@@ -90,6 +91,8 @@ struct _list_desc {
 	uint32_t		nb_iterators;
 	/** Internal list iterator */
 	struct no_os_iterator		l_it;
+	/** Pool the elements are taken from, NULL to use the heap */
+	struct no_os_pool	*pool;
 };
 
 /** @brief Default function used to compare element in the list ( \ref f_cmp) */
@@ -100,18 +103,23 @@ static int32_t no_os_default_comparator(void *data1, void *data2)
 
 /**
  * @brief Creates a new list elements an configure its value
+ * @param list - List the element is created for
  * @param data - To set list_elem.data
  * @param prev - To set list_elem.prev
  * @param next - To set list_elem.next
  * @return Address of the new element or NULL if allocation fails.
  */
-static inline struct no_os_list_elem *create_element(void *data,
+static inline struct no_os_list_elem *create_element(struct _list_desc *list,
+		void *data,
 		struct no_os_list_elem *prev,
 		struct no_os_list_elem *next)
 {
 	struct no_os_list_elem *elem;
 
-	elem = (struct no_os_list_elem *)calloc(1, sizeof(*elem));
+	if (list->pool)
+		elem = (struct no_os_list_elem *)no_os_pool_alloc(list->pool);
+	else
+		elem = (struct no_os_list_elem *)calloc(1, sizeof(*elem));
 	if (!elem)
 		return NULL;
 	elem->data = data;
@@ -121,6 +129,20 @@ static inline struct no_os_list_elem *create_element(void *data,
 	return (elem);
 }
 
+/**
+ * @brief Release an element created with create_element()
+ * @param list - List the element was created for
+ * @param elem - Element to release
+ */
+static inline void destroy_element(struct _list_desc *list,
+				   struct no_os_list_elem *elem)
+{
+	if (list->pool)
+		no_os_pool_free(list->pool, elem);
+	else
+		free(elem);
+}
+
 /**
  * @brief Updates the necesary link on the list elements to add or remove one
  * @param prev - Low element
@@ -237,6 +259,36 @@ int32_t no_os_list_init(struct no_os_list_desc **list_desc,
 	return 0;
 }
 
+/**
+ * @brief Take the list elements from a pool instead of the heap.
+ *
+ * The pool objects must be at least \ref NO_OS_LIST_ELEM_SIZE bytes. A pool
+ * can be shared by several lists, and adding to a list fails once the pool is
+ * exhausted.
+ * @param list_desc - Reference to the list, must be empty
+ * @param pool - Pool to use, NULL to go back to the heap
+ * @return
+ *  - 0 : On success
+ *  - -1 : Otherwise
+ */
+int32_t no_os_list_set_pool(struct no_os_list_desc *list_desc,
+			    struct no_os_pool *pool)
+{
+	struct _list_desc	*list;
+
+	if (!list_desc)
+		return -1;
+
+	list = list_desc->priv_desc;
+	if (list->nb_elements ||
+	    (pool && pool->obj_size < NO_OS_LIST_ELEM_SIZE))
+		return -1;
+
+	list->pool = pool;
+
+	return 0;
+}
+
 /**
  * @brief Remove the created list.
  *
@@ -305,7 +357,7 @@ int32_t no_os_list_add_first(struct no_os_list_desc *list_desc, void *data)
 
 	prev = NULL;
 	next = list->first;
-	elem = create_element(data, prev, next);
+	elem = create_element(list, data, prev, next);
 	if (!elem)
 		return -1;
 
@@ -332,7 +384,7 @@ int32_t no_os_list_add_last(struct no_os_list_desc *list_desc, void *data)
 
 	prev = list->last;
 	next = NULL;
-	elem = create_element(data, prev, next);
+	elem = create_element(list, data, prev, next);
 	if (!elem)
 		return -1;
 
@@ -565,7 +617,7 @@ int32_t no_os_list_get_first(struct no_os_list_desc *list_desc, void **data)
 	list->nb_elements--;
 
 	*data = elem->data;
-	free(elem);
+	destroy_element(list, elem);
 
 	return 0;
 }
@@ -595,7 +647,7 @@ int32_t no_os_list_get_last(struct no_os_list_desc *list_desc, void **data)
 	list->nb_elements--;
 
 	*data = elem->data;
-	free(elem);
+	destroy_element(list, elem);
 
 	return 0;
 }
@@ -825,7 +877,7 @@ int32_t no_os_iterator_get(struct no_os_iterator *iter, void **data)
 		next = it->elem->prev;
 	else
 		next = it->elem->next;
-	free(it->elem);
+	destroy_element(it->list, it->elem);
 	it->elem = next;
 
 	return 0;
@@ -870,9 +922,9 @@ int32_t no_os_iterator_insert(struct no_os_iterator *iter, void *data,
 		return no_os_list_add_first(&list_desc, data);
 
 	if (after)
-		elem = create_element(data, it->elem, it->elem->next);
+		elem = create_element(it->list, data, it->elem, it->elem->next);
 	else
-		elem = create_element(data, it->elem->prev, it->elem);
+		elem = create_element(it->list, data, it->elem->prev, it->elem);
 	if (!elem)
 		return -1;
 
@@ -0,0 +1,133 @@
+/***************************************************************************//**
+ *   @file   no_os_pool.c
+ *   @brief  Fixed size object pool
+********************************************************************************
+ * Copyright 2022(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stddef.h>
+#include "no_os_pool.h"
+#include "no_os_error.h"
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Configure a pool using the given memory. The memory can be static
+ * (see NO_OS_POOL_MEM) or carved out of an arena, it must stay valid for as
+ * long as the pool is used.
+ * @param pool - Pool descriptor.
+ * @param mem - Memory for the objects, aligned to a pointer size.
+ * @param mem_size - Size of mem in bytes.
+ * @param obj_size - Size of an object in bytes.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t no_os_pool_cfg(struct no_os_pool *pool, void *mem, uint32_t mem_size,
+		       uint32_t obj_size)
+{
+	uint8_t *obj;
+	uint32_t i;
+
+	if (!pool || !mem || !obj_size ||
+	    ((uintptr_t)mem & (sizeof(void *) - 1)))
+		return -EINVAL;
+
+	/* Each object must be able to hold the free list link */
+	obj_size = (obj_size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+
+	pool->mem = mem;
+	pool->obj_size = obj_size;
+	pool->nb_objs = mem_size / obj_size;
+	pool->nb_free = pool->nb_objs;
+	pool->free_list = NULL;
+	if (!pool->nb_objs)
+		return -EINVAL;
+
+	/* Link the objects so the first one is allocated first */
+	for (i = pool->nb_objs; i > 0; i--) {
+		obj = pool->mem + (i - 1) * obj_size;
+		*(void **)obj = pool->free_list;
+		pool->free_list = obj;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Get a free object from the pool.
+ * @param pool - Pool descriptor.
+ * @return The object, NULL if the pool is exhausted.
+ */
+void *no_os_pool_alloc(struct no_os_pool *pool)
+{
+	void *obj;
+
+	if (!pool || !pool->free_list)
+		return NULL;
+
+	obj = pool->free_list;
+	pool->free_list = *(void **)obj;
+	pool->nb_free--;
+
+	return obj;
+}
+
+/**
+ * @brief Give an object back to the pool.
+ * @param pool - Pool descriptor.
+ * @param obj - Object returned by no_os_pool_alloc().
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t no_os_pool_free(struct no_os_pool *pool, void *obj)
+{
+	uint32_t offset;
+
+	if (!pool || !obj || (uint8_t *)obj < pool->mem)
+		return -EINVAL;
+
+	offset = (uint8_t *)obj - pool->mem;
+	if (offset % pool->obj_size || offset / pool->obj_size >= pool->nb_objs)
+		return -EINVAL;
+
+	*(void **)obj = pool->free_list;
+	pool->free_list = obj;
+	pool->nb_free++;
+
+	return 0;
+}
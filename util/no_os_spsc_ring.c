@@ -0,0 +1,236 @@
+/***************************************************************************//**
+ *   @file   no_os_spsc_ring.c
+ *   @brief  Lock-free single producer, single consumer ring buffer
+********************************************************************************
+ * Copyright 2022(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <string.h>
+#include "no_os_spsc_ring.h"
+#include "no_os_error.h"
+#include "no_os_util.h"
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Configure the ring to use the given memory. Must be called before
+ * the producer and the consumer start using the ring.
+ * @param ring - Ring descriptor.
+ * @param buff - Buffer memory.
+ * @param size - Size of buff in bytes, must be a power of two.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t no_os_spsc_ring_cfg(struct no_os_spsc_ring *ring, uint8_t *buff,
+			    uint32_t size)
+{
+	if (!ring || !buff || !size || (size & (size - 1)) ||
+	    size > 0x80000000u)
+		return -EINVAL;
+
+	ring->buff = buff;
+	ring->size = size;
+	ring->mask = size - 1;
+	atomic_init(&ring->write_idx, 0);
+	atomic_init(&ring->read_idx, 0);
+
+	return 0;
+}
+
+/**
+ * @brief Number of bytes available to the consumer. Exact when called by the
+ * consumer, a lower bound of the free space when called by the producer.
+ * @param ring - Ring descriptor.
+ * @return Number of bytes.
+ */
+uint32_t no_os_spsc_ring_used(struct no_os_spsc_ring *ring)
+{
+	return atomic_load_explicit(&ring->write_idx, memory_order_acquire) -
+	       atomic_load_explicit(&ring->read_idx, memory_order_acquire);
+}
+
+/**
+ * @brief Number of bytes available to the producer.
+ * @param ring - Ring descriptor.
+ * @return Number of bytes.
+ */
+uint32_t no_os_spsc_ring_free(struct no_os_spsc_ring *ring)
+{
+	return ring->size - no_os_spsc_ring_used(ring);
+}
+
+/**
+ * @brief Describe len bytes starting at index idx as up to two contiguous
+ * parts of the buffer.
+ * @param ring - Ring descriptor.
+ * @param idx - Free running index of the first byte.
+ * @param len - Number of bytes.
+ * @param span - Where the parts are stored.
+ */
+static void no_os_spsc_ring_span(struct no_os_spsc_ring *ring, uint32_t idx,
+				 uint32_t len, struct no_os_spsc_span *span)
+{
+	uint32_t pos = idx & ring->mask;
+	uint32_t first = no_os_min(len, ring->size - pos);
+
+	span->data[0] = ring->buff + pos;
+	span->len[0] = first;
+	span->data[1] = ring->buff;
+	span->len[1] = len - first;
+}
+
+/**
+ * @brief Get up to len free bytes that the producer can write in place.
+ * Nothing is visible to the consumer until no_os_spsc_ring_write_commit().
+ * @param ring - Ring descriptor.
+ * @param len - Number of bytes wanted.
+ * @param span - Where the reserved region is described.
+ * @return Number of bytes reserved.
+ */
+uint32_t no_os_spsc_ring_write_reserve(struct no_os_spsc_ring *ring,
+				       uint32_t len,
+				       struct no_os_spsc_span *span)
+{
+	uint32_t w = atomic_load_explicit(&ring->write_idx,
+					  memory_order_relaxed);
+	uint32_t r = atomic_load_explicit(&ring->read_idx,
+					  memory_order_acquire);
+
+	len = no_os_min(len, ring->size - (w - r));
+	no_os_spsc_ring_span(ring, w, len, span);
+
+	return len;
+}
+
+/**
+ * @brief Make len bytes of the reserved region available to the consumer.
+ * @param ring - Ring descriptor.
+ * @param len - Number of bytes written, at most the number reserved.
+ */
+void no_os_spsc_ring_write_commit(struct no_os_spsc_ring *ring, uint32_t len)
+{
+	uint32_t w = atomic_load_explicit(&ring->write_idx,
+					  memory_order_relaxed);
+
+	/* Data stores must be visible before the new index */
+	atomic_store_explicit(&ring->write_idx, w + len, memory_order_release);
+}
+
+/**
+ * @brief Get up to len used bytes that the consumer can read in place.
+ * The bytes are not overwritten until no_os_spsc_ring_read_commit().
+ * @param ring - Ring descriptor.
+ * @param len - Number of bytes wanted.
+ * @param span - Where the reserved region is described.
+ * @return Number of bytes reserved.
+ */
+uint32_t no_os_spsc_ring_read_reserve(struct no_os_spsc_ring *ring,
+				      uint32_t len,
+				      struct no_os_spsc_span *span)
+{
+	uint32_t r = atomic_load_explicit(&ring->read_idx,
+					  memory_order_relaxed);
+	uint32_t w = atomic_load_explicit(&ring->write_idx,
+					  memory_order_acquire);
+
+	len = no_os_min(len, w - r);
+	no_os_spsc_ring_span(ring, r, len, span);
+
+	return len;
+}
+
+/**
+ * @brief Release len bytes of the reserved region to the producer.
+ * @param ring - Ring descriptor.
+ * @param len - Number of bytes read, at most the number reserved.
+ */
+void no_os_spsc_ring_read_commit(struct no_os_spsc_ring *ring, uint32_t len)
+{
+	uint32_t r = atomic_load_explicit(&ring->read_idx,
+					  memory_order_relaxed);
+
+	/* Data loads must be done before the space is given back */
+	atomic_store_explicit(&ring->read_idx, r + len, memory_order_release);
+}
+
+/**
+ * @brief Copy len bytes into the ring. Used by the producer to push a batch
+ * of elements (e.g. multiple scans) with a single index update.
+ * @param ring - Ring descriptor.
+ * @param data - Data to be copied.
+ * @param len - Number of bytes.
+ * @return 0 in case of success, -EAGAIN if there isn't enough free space.
+ */
+int32_t no_os_spsc_ring_push(struct no_os_spsc_ring *ring, const void *data,
+			     uint32_t len)
+{
+	struct no_os_spsc_span span;
+
+	if (no_os_spsc_ring_write_reserve(ring, len, &span) != len)
+		return -EAGAIN;
+
+	memcpy(span.data[0], data, span.len[0]);
+	memcpy(span.data[1], (const uint8_t *)data + span.len[0], span.len[1]);
+	no_os_spsc_ring_write_commit(ring, len);
+
+	return 0;
+}
+
+/**
+ * @brief Copy len bytes out of the ring. Used by the consumer to pop a batch
+ * of elements with a single index update.
+ * @param ring - Ring descriptor.
+ * @param data - Where the data is copied.
+ * @param len - Number of bytes.
+ * @return 0 in case of success, -EAGAIN if there isn't enough data.
+ */
+int32_t no_os_spsc_ring_pop(struct no_os_spsc_ring *ring, void *data,
+			    uint32_t len)
+{
+	struct no_os_spsc_span span;
+
+	if (no_os_spsc_ring_read_reserve(ring, len, &span) != len)
+		return -EAGAIN;
+
+	memcpy(data, span.data[0], span.len[0]);
+	memcpy((uint8_t *)data + span.len[0], span.data[1], span.len[1]);
+	no_os_spsc_ring_read_commit(ring, len);
+
+	return 0;
+}